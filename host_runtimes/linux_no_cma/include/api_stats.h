@@ -0,0 +1,186 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_API_STATS_H
+#define RDAI_API_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rdai_api.h"
+#include "latency_histogram.h"
+#include "tick_clock.h"
+
+/**
+ * Host API Statistics
+ *
+ * Latency histograms of the host API calls, per operation class and per
+ * device. Every thread records into its own shard (no atomic
+ * read-modify-writes, no shared cache lines); shards are merged when the
+ * statistics are read. Shards of exited threads are kept and handed to new
+ * threads, so nothing recorded is lost. There is one instance per process.
+ *
+ * The API entry points are timed with RDAI_STATS_SCOPE, which expands to
+ * nothing unless the host runtime is built with RDAI_ENABLE_STATS. Calls
+ * are timed in TickClock ticks, which are much cheaper to read than
+ * steady_clock, and converted to ns when the statistics are read.
+ *
+ * With RDAI_STATS_FILE set, the statistics are written to that file in the
+ * Prometheus text format every RDAI_STATS_INTERVAL_MS milliseconds (10 s by
+ * default) and when the program exits.
+ */
+class ApiStats
+{
+public:
+
+    // devices beyond this many only count towards the operation totals
+    static const size_t MAX_DEVICES = 64;
+
+    class Scope
+    {
+    public:
+        Scope( ApiStats &stats, RDAI_StatsOp op, const RDAI_Device *device )
+            : stats( stats ), op( op ), device( device ), start( TickClock::now() ) {}
+        ~Scope() { stats.record( op, device, TickClock::now() - start ); }
+        Scope( const Scope& ) = delete;
+        Scope& operator=( const Scope& ) = delete;
+
+    private:
+        ApiStats &stats;
+        RDAI_StatsOp op;
+        const RDAI_Device *device;
+        uint64_t start;
+    };
+
+    ApiStats();
+    ~ApiStats();
+    ApiStats( const ApiStats& ) = delete;
+    ApiStats& operator=( const ApiStats& ) = delete;
+
+    /**
+     * Record the latency of a call
+     *
+     * @param op The operation class of the call
+     * @param device The device of the call (or NULL)
+     * @param t The latency in TickClock ticks
+     */
+    void record( RDAI_StatsOp op, const RDAI_Device *device, uint64_t t )
+    {
+        Shard *shard = local.shard ? local.shard : attach();
+        shard->ops[op].record_exclusive( t );
+        if( device ) {
+            LatencyHistogram *h = shard->device_histograms( this, device );
+            if( h ) h[op].record_exclusive( t );
+        }
+    }
+
+    /**
+     * Get the merged statistics of an operation class
+     *
+     * @param device The device to report (NULL for all calls)
+     */
+    void get( RDAI_StatsOp op, const RDAI_Device *device, RDAI_OpStats *stats );
+
+    /**
+     * Clear the statistics
+     *
+     * Calls recorded while the statistics are cleared may partly survive
+     */
+    void reset();
+
+    /**
+     * Write the statistics to a file in the Prometheus text format
+     *
+     * The file is replaced atomically (written aside, then renamed)
+     *
+     * @return false if the file cannot be written
+     */
+    bool dump( const char *path );
+
+private:
+
+    typedef LatencyHistogram DeviceHistograms[RDAI_NUM_STATS_OPS];
+
+    struct Shard
+    {
+        LatencyHistogram ops[RDAI_NUM_STATS_OPS];
+        std::atomic<DeviceHistograms *> devices[MAX_DEVICES] = {};
+
+        // device -> index cache, only used by the owning thread
+        std::vector<std::pair<const RDAI_Device *, uint32_t>> indices;
+
+        LatencyHistogram *device_histograms( ApiStats *stats, const RDAI_Device *device )
+        {
+            for( auto &e : indices ) {
+                if( e.first != device ) continue;
+                return (e.second < MAX_DEVICES) ? *devices[e.second].load( std::memory_order_relaxed ) : NULL;
+            }
+            return stats->add_device( this, device );
+        }
+
+        ~Shard()
+        {
+            for( auto &d : devices ) delete[] d.load( std::memory_order_relaxed );
+        }
+    };
+
+    // detaches the shard of a thread when the thread exits
+    struct LocalShard
+    {
+        ApiStats *owner = NULL;
+        Shard *shard = NULL;
+        ~LocalShard() { if( shard ) owner->detach( shard ); }
+    };
+
+    Shard *attach();
+    void detach( Shard *shard );
+    LatencyHistogram *add_device( Shard *shard, const RDAI_Device *device );
+    void merge( RDAI_StatsOp op, long device_index, LatencyHistogram &merged );
+    void dump_loop( std::string path, std::chrono::milliseconds interval );
+
+    static thread_local LocalShard local;
+    TickClock clock;
+
+    std::mutex lock;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<Shard *> free_shards;
+    std::vector<const RDAI_Device *> devices;
+    std::vector<std::string> device_labels;
+
+    // periodic dump
+    std::thread dumper;
+    std::mutex dump_lock;
+    std::condition_variable dump_cv;
+    bool stopping = false;
+};
+
+#ifdef RDAI_ENABLE_STATS
+#define RDAI_STATS_SCOPE( stats, op, device )   ApiStats::Scope rdai_stats_scope_( (stats), (op), (device) )
+#else
+#define RDAI_STATS_SCOPE( stats, op, device )   ((void) 0)
+#endif // RDAI_ENABLE_STATS
+
+#endif // RDAI_API_STATS_H
@@ -0,0 +1,122 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_ASYNC_COPY_H
+#define RDAI_ASYNC_COPY_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "copy_engine.h"
+#include "completion_table.h"
+#include "priority_queue.h"
+#include "tracer.h"
+
+/**
+ * Asynchronous Copy Engine
+ *
+ * Executes host-side copies on a fixed set of copy threads, so that copies
+ * overlap with device runs and with the application. Submissions go through
+ * a bounded queue: when queue_depth copies are pending, submit() blocks until
+ * a copy thread frees a slot (post() does not). Pending copies are started by priority class
+ * (see PriorityQueue). The status of every copy is recorded in a
+ * CompletionTable under the handle ID returned by submit().
+ *
+ * Copy threads are started on first use.
+ */
+class AsyncCopyEngine
+{
+public:
+
+    /**
+     * @param copy_engine The engine executing each copy
+     * @param completions The table where completions are recorded
+     * @param wait_stats Where the queue wait of each copy is recorded
+     * @param tracer Where the span of each copy is recorded
+     * @param num_threads The number of copy threads (0 selects a default)
+     * @param queue_depth The maximum number of pending copies
+     */
+    AsyncCopyEngine( CopyEngine &copy_engine, CompletionTable &completions, QueueWaitStats &wait_stats,
+                     Tracer &tracer, size_t num_threads = 0, size_t queue_depth = 4096 );
+    ~AsyncCopyEngine();
+    AsyncCopyEngine( const AsyncCopyEngine& ) = delete;
+    AsyncCopyEngine& operator=( const AsyncCopyEngine& ) = delete;
+
+    /**
+     * Queue a copy of size bytes from src to dest
+     *
+     * @param callback The function to call on completion (or NULL)
+     * @param callback_ctx The context passed to the callback
+     * @param priority The priority class of the copy
+     * @return The handle ID of the copy in the completion table, or 0 if the
+     *         table is full (the copy is not queued then)
+     */
+    uint32_t submit( void *dest, const void *src, size_t size,
+                     RDAI_CompletionCallback callback = NULL, void *callback_ctx = NULL,
+                     RDAI_Priority priority = RDAI_PRIORITY_NORMAL );
+
+    /**
+     * Queue a copy of size bytes from src to dest, without a handle
+     *
+     * Never waits for a free slot, so that it may be called from a copy
+     * thread or a device thread: the caller bounds what it posts (e.g. a
+     * queue has one command in flight).
+     *
+     * @param done Called from the copy thread once the copy has finished
+     */
+    void post( void *dest, const void *src, size_t size, std::function<void()> done );
+
+private:
+
+    // a request completes either its handle ID or its done function
+    struct Request
+    {
+        void *dest;
+        const void *src;
+        size_t size;
+        uint32_t id;
+        std::function<void()> done;
+    };
+
+    void enqueue( Request request, RDAI_Priority priority, bool block );
+    void start();
+    void copy_loop();
+
+    CopyEngine &copy_engine;
+    CompletionTable &completions;
+    Tracer &tracer;
+    size_t num_threads;
+
+    // pending requests, at most queue_depth
+    PriorityQueue<Request> pending;
+    size_t queue_depth;
+
+    std::once_flag started;
+    std::mutex lock;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::vector<std::thread> threads;
+    bool stopping = false;
+};
+
+#endif // RDAI_ASYNC_COPY_H
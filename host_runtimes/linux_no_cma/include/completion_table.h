@@ -0,0 +1,241 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_COMPLETION_TABLE_H
+#define RDAI_COMPLETION_TABLE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "rdai_api.h"
+
+/**
+ * Completion Table
+ *
+ * Tracks the completion of asynchronous operations through the handles
+ * returned to the application. Each operation gets a slot when it is
+ * submitted; the executing thread records the final status with complete()
+ * and the application retrieves it with wait(), which recycles the slot.
+ *
+ * A handle ID packs the slot index (low COMPLETION_INDEX_BITS bits) with the
+ * generation of the slot, which is bumped every time the slot is recycled.
+ * Lookups are O(1), and a handle that was already synchronized, or was never
+ * issued, is detected as stale. Recycled slots are reused in FIFO order so
+ * that a generation takes as long as possible to come around again.
+ *
+ * Waiters of a single handle sleep on a futex on the state word of its slot.
+ * Waiters of any of several handles sleep on a futex on a table-wide
+ * completion sequence number instead. Slots are allocated in chunks as
+ * needed and live for the lifetime of the process.
+ *
+ * An operation can also carry a completion callback, which is called from
+ * the completion thread of the table (started on first use), never from the
+ * thread completing the operation. Its slot is recycled once the callback
+ * has returned, unless the operation was synchronized before.
+ *
+ * Each slot also keeps the profile of its operation (see
+ * RDAI_get_handle_profile): the times it was queued, submitted to its
+ * platform and completed, and the device times reported by the platform.
+ * The profile stays readable after synchronization, until the slot is
+ * reused; reads check the state of the slot around them, as a seqlock.
+ */
+
+#define COMPLETION_INDEX_BITS       20
+#define COMPLETION_INDEX_MASK       ((1u << COMPLETION_INDEX_BITS) - 1)
+#define COMPLETION_GENERATION_MASK  ((1u << (32 - COMPLETION_INDEX_BITS)) - 1)
+#define COMPLETION_CHUNK_BITS       12
+#define COMPLETION_CHUNK_SIZE       (1u << COMPLETION_CHUNK_BITS)
+#define COMPLETION_NUM_CHUNKS       (1u << (COMPLETION_INDEX_BITS - COMPLETION_CHUNK_BITS))
+
+class CompletionTable
+{
+public:
+
+    CompletionTable() = default;
+    ~CompletionTable();
+    CompletionTable( const CompletionTable& ) = delete;
+    CompletionTable& operator=( const CompletionTable& ) = delete;
+
+    /**
+     * Allocate a slot for a new operation
+     *
+     * @param callback The function to call on completion (or NULL)
+     * @param callback_ctx The context passed to the callback
+     * @return The handle ID of the operation, or 0 if all slots are in use
+     */
+    uint32_t create( RDAI_CompletionCallback callback = NULL, void *callback_ctx = NULL );
+
+    /**
+     * Release the slot of an operation that could not be queued after all
+     *
+     * The handle was never returned: no waiter or callback can see it
+     */
+    void discard( uint32_t id );
+
+    /**
+     * Record that a pending operation was submitted to its platform
+     */
+    void mark_submitted( uint32_t id );
+
+    /**
+     * Marks the execution of an operation by the calling thread: records
+     * its submission, and makes it the operation whose device times
+     * set_device_times( 0, ... ) records until the end of the scope. The
+     * wait for an operation already started passes submit = false
+     */
+    class Running
+    {
+    public:
+        Running( CompletionTable &table, uint32_t id, bool submit = true );
+        ~Running();
+        Running( const Running& ) = delete;
+        Running& operator=( const Running& ) = delete;
+
+    private:
+        uint32_t previous;
+    };
+
+    /**
+     * Record the device-side start and end of a pending operation
+     *
+     * @param id The handle ID, or 0 for the operation the calling thread is
+     *           running (see Running)
+     * @return false if the operation is not pending
+     */
+    bool set_device_times( uint32_t id, uint64_t started_ns, uint64_t ended_ns );
+
+    /**
+     * Get the profile of an operation, pending or completed
+     *
+     * @return false if the ID was never issued or its slot was reused
+     */
+    bool get_profile( uint32_t id, RDAI_HandleProfile *profile ) const;
+
+    /**
+     * Get the time in the clock of profiles (CLOCK_MONOTONIC ns)
+     */
+    static uint64_t profile_clock_ns();
+
+    /**
+     * Record the final status of an operation and wake up its waiters
+     *
+     * @return false if the ID does not name a pending operation
+     */
+    bool complete( uint32_t id, const RDAI_Status &status );
+
+    /**
+     * Wait for an operation to complete and recycle its slot
+     *
+     * @param id The handle ID of the operation
+     * @param status The final status of the operation (output)
+     * @return false if the ID is stale: never issued or already synchronized
+     */
+    bool wait( uint32_t id, RDAI_Status *status );
+
+    enum WaitResult
+    {
+        WAIT_COMPLETED,
+        WAIT_TIMEOUT,
+        WAIT_STALE,         // none of the IDs is pending or completed
+    };
+
+    /**
+     * Wait for any of several operations to complete and recycle its slot
+     *
+     * Stale IDs are skipped, so the same ID array can be waited on repeatedly
+     * until every operation has been retrieved
+     *
+     * @param ids The handle IDs of the operations
+     * @param count The number of IDs
+     * @param timeout_us The maximum time to wait in microseconds (< 0 waits
+     *                   forever, 0 only polls)
+     * @param index The index in ids of the completed operation (output)
+     * @param status The final status of the completed operation (output)
+     */
+    WaitResult wait_any( const uint32_t *ids, size_t count, int64_t timeout_us,
+                         size_t *index, RDAI_Status *status );
+
+private:
+
+    enum Phase : uint32_t
+    {
+        SLOT_FREE    = 0,
+        SLOT_PENDING = 1,
+        SLOT_DONE    = 2,
+        SLOT_CLAIMED = 3,   // being synchronized
+    };
+
+    // state word: generation << 2 | phase
+    struct Slot
+    {
+        std::atomic<uint32_t> state { 0 };
+        std::atomic<uint32_t> waiters { 0 };
+        RDAI_Status status;
+        RDAI_CompletionCallback callback = nullptr;
+        void *callback_ctx = nullptr;
+        uint32_t next_free = 0;
+
+        // profile (CLOCK_MONOTONIC ns, 0 until reached)
+        std::atomic<uint64_t> queued_ns { 0 };
+        std::atomic<uint64_t> submitted_ns { 0 };
+        std::atomic<uint64_t> started_ns { 0 };     // reported by the platform
+        std::atomic<uint64_t> ended_ns { 0 };
+        std::atomic<uint64_t> completed_ns { 0 };
+    };
+
+    struct Callback
+    {
+        uint32_t id;
+        RDAI_CompletionCallback fn;
+        void *ctx;
+        RDAI_Status status;
+    };
+
+    Slot *lookup( uint32_t index ) const;
+    Slot *pending_slot( uint32_t id ) const;
+    bool try_claim( Slot *slot, uint32_t id, uint32_t state, RDAI_Status *status );
+    void recycle( uint32_t index, uint32_t generation );
+    bool grow();
+    void start_callbacks();
+    void callback_loop();
+
+    std::atomic<Slot *> chunks[COMPLETION_NUM_CHUNKS] = {};
+
+    // bumped by every completion, waited on by wait_any
+    std::atomic<uint32_t> completion_seq { 0 };
+    std::atomic<uint32_t> any_waiters { 0 };
+
+    std::mutex lock;        // protects the free list and growth
+    uint32_t num_slots = 1; // slot 0 is reserved: handle IDs are never 0
+    uint32_t free_head = 0;
+    uint32_t free_tail = 0;
+
+    // completion thread
+    std::once_flag callbacks_started;
+    std::mutex callbacks_lock;
+    std::condition_variable callbacks_cv;
+    std::deque<Callback> callbacks;
+    std::thread callback_thread;
+    bool stopping = false;
+};
+
+#endif // RDAI_COMPLETION_TABLE_H
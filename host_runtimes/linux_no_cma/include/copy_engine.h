@@ -0,0 +1,109 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_COPY_ENGINE_H
+#define RDAI_COPY_ENGINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+#include "worker_pool.h"
+
+/**
+ * Copy Engine
+ *
+ * Host-side bulk copies between host-visible buffers. Three strategies are
+ * used depending on the copy size:
+ *  - COPY_MEMCPY: plain memcpy, best while the data fits in cache
+ *  - COPY_STREAM: SIMD copy with non-temporal stores (AVX-512, AVX2, SSE2
+ *                 or NEON, selected at run time), which avoids polluting
+ *                 the cache with the destination
+ *  - COPY_PARALLEL: COPY_STREAM split into page-aligned chunks across the
+ *                   worker pool
+ *
+ * The size thresholds between strategies are calibrated on a background
+ * thread, started by the first large copy; copies use memcpy until the
+ * thresholds are known. They can be forced with the
+ * RDAI_COPY_STREAM_THRESHOLD and RDAI_COPY_PARALLEL_THRESHOLD environment
+ * variables (in bytes), which apply at once, and calibration can be
+ * skipped with RDAI_COPY_CALIBRATE=0.
+ *
+ * Overlapping source and destination ranges (crops of the same memory
+ * object) are always copied with memmove, whatever the strategy.
+ */
+class CopyEngine
+{
+public:
+
+    enum Strategy
+    {
+        COPY_MEMCPY,
+        COPY_STREAM,
+        COPY_PARALLEL,
+    };
+
+    struct Config
+    {
+        size_t stream_threshold;
+        size_t parallel_threshold;
+        size_t num_threads;
+        const char *isa;
+    };
+
+    explicit CopyEngine( WorkerPool &workers ) : workers( workers ) {}
+    ~CopyEngine();
+    CopyEngine( const CopyEngine& ) = delete;
+    CopyEngine& operator=( const CopyEngine& ) = delete;
+
+    /**
+     * Copy with the strategy selected for the size
+     */
+    void copy( void *dest, const void *src, size_t size );
+
+    /**
+     * Copy with a given strategy
+     */
+    void copy( void *dest, const void *src, size_t size, Strategy strategy );
+
+    /**
+     * Get the strategy thresholds (waiting for their calibration if needed)
+     */
+    Config config();
+
+private:
+    void start_calibration();
+    void calibrate();
+    void measure( size_t *stream_from, size_t *parallel_from );
+
+    WorkerPool &workers;
+    std::once_flag started;
+    std::thread calibration;
+    std::atomic<bool> stopping { false };
+
+    std::atomic<size_t> stream_threshold   { (size_t) -1 };
+    std::atomic<size_t> parallel_threshold { (size_t) -1 };
+
+    std::mutex calibrated_lock;
+    std::condition_variable calibrated_cond;
+    bool calibrated = false;
+};
+
+#endif // RDAI_COPY_ENGINE_H
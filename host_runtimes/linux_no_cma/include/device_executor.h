@@ -0,0 +1,213 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_DEVICE_EXECUTOR_H
+#define RDAI_DEVICE_EXECUTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "rdai_api.h"
+#include "completion_table.h"
+#include "mpsc_ring.h"
+#include "priority_queue.h"
+#include "tracer.h"
+
+/**
+ * Device Executor
+ *
+ * Executes asynchronous device work (runs, and copies relayed to a
+ * platform) on behalf of the host runtime. Every device gets its own
+ * execution thread, started when work is first submitted for it, so that
+ * the work of a device executes in submission order while different
+ * devices run concurrently. Within a device, queued work is dispatched by
+ * priority class (see PriorityQueue). The final status of each piece of work is
+ * recorded in the CompletionTable, which makes every asynchronous handle of
+ * the host API waitable with RDAI_sync, RDAI_sync_all and RDAI_wait_any.
+ *
+ * Submitting threads never take a lock of the device: work goes through a
+ * lock-free submission ring per device (see MpscRing) of
+ * RDAI_SUBMIT_RING_SIZE entries (4096 by default). The device thread takes
+ * what was submitted in one batch into its own priority queue before each
+ * dispatch, up to RDAI_SUBMIT_RING_SIZE queued entries, so at most twice
+ * that much work waits per device. It sleeps on a futex when both are
+ * empty; submitters only make the wake-up call when it sleeps. When a ring
+ * is full, submit() waits for room or fails with RDAI_REASON_BUSY (see
+ * RDAI_Backpressure, set with RDAI_SUBMIT_BACKPRESSURE=busy or
+ * set_backpressure()). Work submitted by the device thread itself skips the
+ * ring.
+ *
+ * Platforms with asynchronous ops of their own are driven through
+ * submit_started(): the device thread only starts the operation, and a
+ * second thread of the device finishes the started operations in start
+ * order, waiting for each with the sync of the platform. Other work of the
+ * device waits for the started operations to finish before it executes,
+ * so that the work of a device still completes in submission order.
+ */
+class DeviceExecutor
+{
+public:
+
+    typedef std::function<RDAI_Status()> Work;
+    typedef std::function<RDAI_Status( RDAI_AsyncHandle *async_handle )> Finish;
+
+    DeviceExecutor( CompletionTable &completions, QueueWaitStats &wait_stats, Tracer &tracer );
+    ~DeviceExecutor();
+    DeviceExecutor( const DeviceExecutor& ) = delete;
+    DeviceExecutor& operator=( const DeviceExecutor& ) = delete;
+
+    /**
+     * Queue work for a device
+     *
+     * @param device The device whose thread executes the work
+     * @param name The name of the work in traces (must be a literal)
+     * @param bytes The size the work copies, for the submit probe (or 0)
+     * @param work The work to execute, returning its final status
+     * @param callback The function to call on completion (or NULL)
+     * @param callback_ctx The context passed to the callback
+     * @param priority The priority class of the work
+     * @return status (with the async handle of the work), or
+     *         RDAI_REASON_HANDLE_TABLE_FULL, or RDAI_REASON_BUSY when the
+     *         ring of the device is full in RDAI_BACKPRESSURE_BUSY mode
+     */
+    RDAI_Status submit( RDAI_Device *device, const char *name, size_t bytes, Work work,
+                        RDAI_CompletionCallback callback = NULL, void *callback_ctx = NULL,
+                        RDAI_Priority priority = RDAI_PRIORITY_NORMAL );
+
+    /**
+     * Queue an operation started asynchronously on the platform
+     *
+     * @param start Starts the operation from the device thread, returning
+     *        the async handle of the platform (or an error, final)
+     * @param finish Waits for a started operation, returning its final status
+     * @see submit() for the other parameters and the status
+     */
+    RDAI_Status submit_started( RDAI_Device *device, const char *name, size_t bytes, Work start, Finish finish,
+                                RDAI_CompletionCallback callback = NULL, void *callback_ctx = NULL,
+                                RDAI_Priority priority = RDAI_PRIORITY_NORMAL );
+
+    /**
+     * Queue a task for a device, without a handle
+     *
+     * Never waits for room, so that it may be called from a device thread
+     * or a copy thread: a task that finds the ring full is set aside for
+     * the device thread. The caller bounds what it posts (e.g. a queue has
+     * one command in flight).
+     */
+    void post( RDAI_Device *device, std::function<void()> task,
+               RDAI_Priority priority = RDAI_PRIORITY_NORMAL );
+
+    void set_backpressure( RDAI_Backpressure mode ) { backpressure.store( mode, std::memory_order_relaxed ); }
+
+private:
+
+    typedef std::chrono::steady_clock clock;
+
+    struct Task
+    {
+        std::function<void()> run;
+        bool starts;            // only starts an operation of the platform
+    };
+
+    struct Submission
+    {
+        Task task;
+        RDAI_Priority priority;
+        clock::time_point enqueued;
+    };
+
+    struct Started
+    {
+        uint32_t id;
+        const char *name;
+        RDAI_Device *device;
+        RDAI_AsyncHandle async_handle;
+        Finish finish;
+    };
+
+    struct Lane
+    {
+        Lane( QueueWaitStats &wait_stats, size_t ring_size ) : ring( ring_size ), tasks( wait_stats ) {}
+
+        std::thread thread;
+        MpscRing<Submission> ring;
+        PriorityQueue<Task> tasks;                      // device thread only
+        std::atomic<bool> stopping { false };
+
+        // posted tasks that found the ring full
+        std::mutex overflow_lock;
+        std::vector<Submission> overflow;
+        std::atomic<bool> overflowed { false };
+
+        // operations started on the platform, finished in start order by
+        // the finisher thread (started when the first one is)
+        std::thread finisher;
+        std::mutex started_lock;
+        std::condition_variable started_cond;
+        std::deque<Started> started;
+        std::atomic<size_t> in_flight { 0 };            // started and not finished
+        bool finished = false;                          // no more operations to start
+
+        // futex words: bumped to wake the device thread, and the submitters
+        // waiting for room
+        std::atomic<uint32_t> wake_seq { 0 };
+        std::atomic<uint32_t> sleeping { 0 };
+        std::atomic<uint32_t> room_seq { 0 };
+        std::atomic<uint32_t> room_waiters { 0 };
+    };
+
+    Lane *get_lane( RDAI_Device *device );
+    bool enqueue( Lane *lane, Submission &&submission, bool block );
+    void wake( Lane *lane );
+    void lane_loop( Lane *lane );
+    void finish_loop( Lane *lane );
+    void wait_started( Lane *lane );
+
+    // lanes by device, read without the lock (the first LANE_CACHE_SIZE
+    // devices; the others are looked up in the map)
+    static const size_t LANE_CACHE_SIZE = 64;
+
+    struct CachedLane
+    {
+        std::atomic<RDAI_Device *> device { NULL };
+        Lane *lane = NULL;
+    };
+
+    static thread_local Lane *current_lane;
+
+    CompletionTable &completions;
+    QueueWaitStats &wait_stats;
+    Tracer &tracer;
+    size_t ring_size;
+    std::atomic<RDAI_Backpressure> backpressure { RDAI_BACKPRESSURE_BLOCK };
+    std::mutex lanes_lock;
+    std::unordered_map<RDAI_Device *, std::unique_ptr<Lane>> lanes;
+    CachedLane lane_cache[LANE_CACHE_SIZE];
+    size_t num_cached = 0;
+};
+
+#endif // RDAI_DEVICE_EXECUTOR_H
@@ -0,0 +1,136 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_EPOCH_H
+#define RDAI_EPOCH_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Epoch Domain
+ *
+ * Epoch-based read-copy-update support. Readers announce the epoch they
+ * entered in a per-thread record and never block. Writers publish a new
+ * version of the shared data, then call synchronize() to wait until every
+ * reader that may still see the old version has left its read-side section.
+ *
+ * Read-side sections may nest.
+ *
+ * When the kernel supports membarrier(2), the store-load fence a reader
+ * needs between announcing its epoch and reading shared pointers is moved
+ * to the writer side, so that read_lock() costs only a compiler barrier.
+ */
+class EpochDomain
+{
+public:
+
+    struct alignas(64) Record
+    {
+        std::atomic<uint64_t> epoch { 0 };      // 0 means quiescent
+        std::atomic<bool> in_use { false };
+        uint32_t nesting = 0;
+        Record *next = nullptr;
+    };
+
+    EpochDomain();
+    EpochDomain( const EpochDomain& ) = delete;
+    EpochDomain& operator=( const EpochDomain& ) = delete;
+
+    void read_lock()
+    {
+        Record *rec = local_record();
+        if( rec->nesting++ == 0 ) {
+            // acquire: a reader that sees a new epoch also sees the version
+            // published before it (shared pointers may not be read earlier)
+            rec->epoch.store( global_epoch.load( std::memory_order_acquire ), std::memory_order_relaxed );
+            // the announcement must be visible before any shared pointer is read
+            if( asymmetric_fence ) {
+                std::atomic_signal_fence( std::memory_order_seq_cst );
+            } else {
+                std::atomic_thread_fence( std::memory_order_seq_cst );
+            }
+        }
+    }
+
+    void read_unlock()
+    {
+        Record *rec = local_record();
+        if( --rec->nesting == 0 ) {
+            rec->epoch.store( 0, std::memory_order_release );
+        }
+    }
+
+    /**
+     * Wait until all readers that entered before this call have left
+     *
+     * Readers on the calling thread are ignored so that a writer can be
+     * invoked from within a read-side section without deadlocking.
+     */
+    void synchronize();
+
+    /**
+     * Check without blocking whether all readers that entered before
+     * the given epoch have left
+     *
+     * @param epoch An epoch returned by advance()
+     */
+    bool is_quiescent( uint64_t epoch );
+
+    /**
+     * Start a new epoch
+     *
+     * @return The new epoch
+     */
+    uint64_t advance()
+    {
+        return global_epoch.fetch_add( 1, std::memory_order_seq_cst ) + 1;
+    }
+
+    class ReadGuard
+    {
+    public:
+        explicit ReadGuard( EpochDomain &d ) : domain( d ) { domain.read_lock(); }
+        ~ReadGuard() { domain.read_unlock(); }
+        ReadGuard( const ReadGuard& ) = delete;
+        ReadGuard& operator=( const ReadGuard& ) = delete;
+    private:
+        EpochDomain &domain;
+    };
+
+private:
+    Record *local_record()
+    {
+        if( cached_serial == serial ) return cached_record;
+        return local_record_slow();
+    }
+
+    Record *local_record_slow();
+    Record *acquire_record();
+    void writer_fence();
+
+    static bool asymmetric_fence;
+    static inline thread_local uint64_t cached_serial = 0;
+    static inline thread_local Record *cached_record = nullptr;
+
+    const uint64_t serial;
+    std::atomic<uint64_t> global_epoch { 1 };
+    std::atomic<Record *> records { nullptr };
+};
+
+#endif // RDAI_EPOCH_H
@@ -0,0 +1,198 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_FRAME_REPORT_H
+#define RDAI_FRAME_REPORT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "rdai_api.h"
+#include "completion_table.h"
+#include "latency_histogram.h"
+
+/**
+ * Frame Report
+ *
+ * Per-stage latencies of application frames (see RDAI_frame_begin). A
+ * frame is opened by a thread, which becomes its current frame; the
+ * copies and runs the thread issues while a frame is current belong to
+ * that frame. Synchronous calls are timed where they are made. Async
+ * calls are remembered by handle ID, and attributed from the profile of
+ * their handle (see CompletionTable::get_profile) when they are
+ * synchronized. Work executed on another thread without a handle (queue
+ * commands) keeps the frame current at its submission, and is timed where
+ * it executes. When a frame ends, the sum of each stage it used is
+ * recorded in the histogram of the stage.
+ *
+ * Calls made without a current frame only pay for a thread-local load.
+ * With RDAI_FRAME_REPORT_FILE set, the report is written to that file
+ * every RDAI_FRAME_REPORT_INTERVAL_MS milliseconds (10 s by default) and
+ * when the program exits. There is one instance per process.
+ */
+class FrameReport
+{
+public:
+
+    enum Op
+    {
+        OP_NONE,
+        OP_COPY,
+        OP_RUN,
+    };
+
+    /**
+     * Times a synchronous copy or run of the current frame, if any (or of
+     * the given frame)
+     */
+    class Scope
+    {
+    public:
+        Scope( FrameReport &report, Op op ) : Scope( report, op, current_frame ) {}
+        Scope( FrameReport &report, Op op, uint64_t frame )
+            : report( report ), op( op ), frame( frame ),
+              start( frame ? CompletionTable::profile_clock_ns() : 0 ) {}
+        ~Scope() { if( frame ) report.record_call( frame, op, CompletionTable::profile_clock_ns() - start ); }
+        Scope( const Scope& ) = delete;
+        Scope& operator=( const Scope& ) = delete;
+
+    private:
+        FrameReport &report;
+        Op op;
+        uint64_t frame;
+        uint64_t start;
+    };
+
+    explicit FrameReport( CompletionTable &completions );
+    ~FrameReport();
+    FrameReport( const FrameReport& ) = delete;
+    FrameReport& operator=( const FrameReport& ) = delete;
+
+    /**
+     * Open a frame and make it current for the calling thread
+     *
+     * @return false if the ID is 0 or the frame is already open
+     */
+    bool begin( uint64_t frame_id );
+
+    /**
+     * Make an open frame (or no frame, with 0) current for the calling thread
+     */
+    bool select( uint64_t frame_id );
+
+    /**
+     * Close a frame and record its stages
+     *
+     * @return false if the frame is not open
+     */
+    bool end( uint64_t frame_id );
+
+    /**
+     * Get the current frame of the calling thread (0 if none)
+     */
+    static uint64_t current() { return current_frame; }
+
+    /**
+     * Attribute a copy or run executed for a frame (0 for none) and timed
+     * by the caller
+     */
+    void executed( uint64_t frame_id, Op op, uint64_t ns )
+    {
+        if( frame_id ) record_call( frame_id, op, ns );
+    }
+
+    /**
+     * Attribute an async call to the current frame, if any
+     */
+    void submitted( uint32_t id, Op op )
+    {
+        if( current_frame && id ) record_submit( current_frame, id, op );
+    }
+
+    /**
+     * Whether async calls of frames are waiting to be synchronized
+     */
+    bool waiting() const { return num_pending.load( std::memory_order_relaxed ) != 0; }
+
+    /**
+     * Attribute a synchronized async call to its frame
+     *
+     * @param id The handle ID of the call
+     * @param sync_start_ns When the synchronization started (see
+     *                      CompletionTable::profile_clock_ns)
+     */
+    void synced( uint32_t id, uint64_t sync_start_ns );
+
+    void get( RDAI_FrameStage stage, RDAI_OpStats *stats ) const;
+    void reset();
+
+    /**
+     * Write the report as a text table, replacing the file atomically
+     *
+     * @return false if the file cannot be written
+     */
+    bool dump( const char *path ) const;
+
+private:
+
+    struct Frame
+    {
+        uint64_t begin_ns;
+        uint64_t stage_ns[RDAI_NUM_FRAME_STAGES];
+        uint32_t used;      // stages with operations
+        bool ran;           // a run was issued: later copies are output copies
+    };
+
+    struct Pending
+    {
+        uint64_t frame;
+        RDAI_FrameStage stage;
+    };
+
+    RDAI_FrameStage stage_of( Frame &frame, Op op );
+    void add( Frame &frame, RDAI_FrameStage stage, uint64_t ns );
+    void record_call( uint64_t frame_id, Op op, uint64_t ns );
+    void record_submit( uint64_t frame_id, uint32_t id, Op op );
+    void dump_loop( std::string path, std::chrono::milliseconds interval );
+
+    static thread_local uint64_t current_frame;
+
+    CompletionTable &completions;
+    LatencyHistogram stages[RDAI_NUM_FRAME_STAGES];
+
+    std::mutex lock;
+    std::unordered_map<uint64_t, Frame> frames;
+    std::unordered_map<uint32_t, Pending> pending;
+    std::atomic<size_t> num_pending { 0 };
+
+    // periodic dump
+    std::thread dumper;
+    std::mutex dump_lock;
+    std::condition_variable dump_cv;
+    bool stopping = false;
+};
+
+#define RDAI_FRAME_SCOPE( report, op )  FrameReport::Scope rdai_frame_scope_( (report), (op) )
+
+#endif // RDAI_FRAME_REPORT_H
@@ -0,0 +1,111 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_GRAPH_H
+#define RDAI_GRAPH_H
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rdai_api.h"
+#include "platform_registry.h"
+#include "copy_engine.h"
+#include "frame_report.h"
+#include "run_profiler.h"
+#include "tracer.h"
+
+/**
+ * Graph
+ *
+ * An immutable sequence of copies and device runs captured from RDAI calls
+ * (see RDAI_graph_begin_capture). Everything the calls validated and looked
+ * up is resolved at capture time: memory object lists are counted and
+ * stored ready to pass to the platform, and every node holds the platform
+ * ops it dispatches to. A launch only pins the platforms of the graph, which
+ * checks they are still registered, then calls the nodes in order.
+ *
+ * The memory objects of the graph are numbered slots, so that a launch can
+ * bind other memory objects in place of the captured ones. Bindings are
+ * checked against the slots as captured, since the captured objects may
+ * have been freed since.
+ */
+struct RDAI_Graph
+{
+    enum NodeKind
+    {
+        NODE_HOST_COPY,
+        NODE_DEVICE_COPY,
+        NODE_DEVICE_RUN,
+    };
+
+    struct Node
+    {
+        NodeKind kind;
+        RDAI_PlatformOps *ops;
+        RDAI_Device *device;    // device copies and runs
+        uint32_t src;           // copies: memory object slots
+        uint32_t dest;
+        size_t size;            // host copies: bytes to copy
+        uint32_t list;          // runs: offset of the list in lists
+    };
+
+    struct Slot
+    {
+        RDAI_MemObjectType mem_type;
+        RDAI_Device *device;
+        size_t size;
+    };
+
+    // capture
+    RDAI_Status add_host_copy( RDAI_MemObject *src, RDAI_MemObject *dest );
+    RDAI_Status add_device_copy( RDAI_Device *device, RDAI_PlatformOps *ops,
+                                 RDAI_MemObject *src, RDAI_MemObject *dest );
+    RDAI_Status add_device_run( RDAI_Platform *platform, RDAI_PlatformOps *ops, RDAI_Device *device,
+                                RDAI_MemObject **mem_object_list, size_t num_els );
+
+    /**
+     * Execute the nodes in order, stopping at the first failure
+     *
+     * @param bindings Memory objects to use in place of captured ones (or NULL)
+     * @param num_bindings The number of bindings
+     * @param tracer Where the platform ops of device nodes are recorded
+     * @param profiler Where the counters of device runs are added
+     * @param frames Where the nodes are attributed to the current frame
+     */
+    RDAI_Status launch( const RDAI_GraphBinding *bindings, size_t num_bindings,
+                        CopyEngine &copy_engine, PlatformRegistry &registry, Tracer &tracer,
+                        RunProfiler &profiler, FrameReport &frames ) const;
+
+    std::vector<Node> nodes;
+    std::vector<RDAI_MemObject *> mem_objects;          // slot -> captured memory object
+    std::vector<Slot> slot_objects;                     // slot -> captured type, device and size
+    std::unordered_map<RDAI_MemObject *, uint32_t> slots;
+    std::vector<RDAI_MemObject *> lists;                // NULL-terminated run lists
+    std::vector<uint32_t> list_slots;                   // slots of the lists entries
+    std::vector<std::pair<RDAI_Platform *, RDAI_PlatformOps *>> platforms;
+
+private:
+    uint32_t slot( RDAI_MemObject *mem_object );
+    void use_platform( RDAI_Platform *platform, RDAI_PlatformOps *ops );
+};
+
+#endif // RDAI_GRAPH_H
@@ -0,0 +1,89 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_INIT_RUNNER_H
+#define RDAI_INIT_RUNNER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+#include "rdai_api.h"
+#include "completion_table.h"
+#include "tracer.h"
+
+/**
+ * Init Runner
+ *
+ * Runs platform initializations asynchronously and keeps the latency of
+ * the last initialization of each platform. Initializations can take
+ * seconds (e.g. loading a bitstream), so each one gets its own thread
+ * rather than occupying a worker or a device lane; they are rare enough
+ * that the thread start does not matter.
+ */
+class InitRunner
+{
+public:
+
+    typedef std::function<RDAI_Status()> Init;
+
+    InitRunner( CompletionTable &completions, Tracer &tracer ) : completions( completions ), tracer( tracer ) {}
+    ~InitRunner();
+    InitRunner( const InitRunner& ) = delete;
+    InitRunner& operator=( const InitRunner& ) = delete;
+
+    /**
+     * Run an initialization on a new thread
+     *
+     * @param name The name of the initialization in traces (must be a literal)
+     * @param init The initialization, returning its final status
+     * @return The handle ID of the initialization in the completion table,
+     *         or 0 if the table is full (the initialization does not run then)
+     */
+    uint32_t submit( const char *name, Init init );
+
+    /**
+     * Record the latency of a platform initialization
+     */
+    void record( const RDAI_Platform *platform, uint64_t latency_ns );
+
+    /**
+     * Get the latency of the last initialization of a platform
+     *
+     * @return false if the platform has not been initialized
+     */
+    bool latency( const RDAI_Platform *platform, uint64_t *latency_ns ) const;
+
+    /**
+     * Drop the latency of a platform (when it is unregistered)
+     */
+    void forget( const RDAI_Platform *platform );
+
+private:
+    CompletionTable &completions;
+    Tracer &tracer;
+
+    mutable std::mutex lock;
+    std::condition_variable idle;
+    size_t running = 0;
+    std::unordered_map<const RDAI_Platform *, uint64_t> latencies;
+};
+
+#endif // RDAI_INIT_RUNNER_H
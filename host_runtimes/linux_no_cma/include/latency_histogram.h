@@ -0,0 +1,146 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_LATENCY_HISTOGRAM_H
+#define RDAI_LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Latency Histogram
+ *
+ * A log-linear histogram of durations in ns, in the style of HDR histograms:
+ * every power of two is split into 2^HISTOGRAM_SUB_BITS buckets, so that a
+ * reported percentile is within 12.5% of the recorded value. Recording is a
+ * few relaxed atomic increments and never allocates; percentiles are
+ * computed on read.
+ */
+class LatencyHistogram
+{
+public:
+
+    static const unsigned SUB_BITS    = 3;
+    static const unsigned SUB_BUCKETS = 1u << SUB_BITS;
+    static const unsigned NUM_BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    void record( uint64_t ns )
+    {
+        buckets[bucket_of( ns )].fetch_add( 1, std::memory_order_relaxed );
+        total.fetch_add( 1, std::memory_order_relaxed );
+        sum.fetch_add( ns, std::memory_order_relaxed );
+        uint64_t m = max.load( std::memory_order_relaxed );
+        while( ns > m && !max.compare_exchange_weak( m, ns, std::memory_order_relaxed ) ) {}
+    }
+
+    /**
+     * Record a duration into a histogram no other thread records into
+     *
+     * Plain loads and stores instead of read-modify-writes; concurrent
+     * readers may see the fields of the latest record partly updated
+     */
+    void record_exclusive( uint64_t ns )
+    {
+        std::atomic<uint64_t> &b = buckets[bucket_of( ns )];
+        b.store( b.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+        total.store( total.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+        sum.store( sum.load( std::memory_order_relaxed ) + ns, std::memory_order_relaxed );
+        if( ns > max.load( std::memory_order_relaxed ) ) max.store( ns, std::memory_order_relaxed );
+    }
+
+    uint64_t count() const { return total.load( std::memory_order_relaxed ); }
+    uint64_t sum_ns() const { return sum.load( std::memory_order_relaxed ); }
+    uint64_t max_ns() const { return max.load( std::memory_order_relaxed ); }
+    uint64_t mean_ns() const { uint64_t n = count(); return n ? sum_ns() / n : 0; }
+
+    /**
+     * Get the value below which a fraction q of the recorded durations fall
+     *
+     * @param q The fraction, in [0, 1]
+     * @return The midpoint of the bucket holding the percentile (0 if empty)
+     */
+    uint64_t percentile( double q ) const
+    {
+        uint64_t n = count();
+        if( n == 0 ) return 0;
+        uint64_t rank = (uint64_t) (q * (double) n);
+        if( rank >= n ) rank = n - 1;
+        uint64_t seen = 0;
+        for( unsigned b = 0; b < NUM_BUCKETS; b++ ) {
+            seen += buckets[b].load( std::memory_order_relaxed );
+            if( seen > rank ) {
+                uint64_t mid = bucket_low( b ) + bucket_width( b ) / 2;
+                return mid < max_ns() ? mid : max_ns();
+            }
+        }
+        return max_ns();
+    }
+
+    /**
+     * Add the counts of another histogram to this one
+     */
+    void merge( const LatencyHistogram &other )
+    {
+        for( unsigned b = 0; b < NUM_BUCKETS; b++ ) {
+            uint64_t c = other.buckets[b].load( std::memory_order_relaxed );
+            if( c ) buckets[b].fetch_add( c, std::memory_order_relaxed );
+        }
+        total.fetch_add( other.count(), std::memory_order_relaxed );
+        sum.fetch_add( other.sum_ns(), std::memory_order_relaxed );
+        uint64_t m = max.load( std::memory_order_relaxed ), o = other.max_ns();
+        while( o > m && !max.compare_exchange_weak( m, o, std::memory_order_relaxed ) ) {}
+    }
+
+    void reset()
+    {
+        for( auto &b : buckets ) b.store( 0, std::memory_order_relaxed );
+        total.store( 0, std::memory_order_relaxed );
+        sum.store( 0, std::memory_order_relaxed );
+        max.store( 0, std::memory_order_relaxed );
+    }
+
+    uint64_t bucket_count( unsigned b ) const { return buckets[b].load( std::memory_order_relaxed ); }
+
+    static unsigned bucket_of( uint64_t v )
+    {
+        if( v < SUB_BUCKETS ) return (unsigned) v;
+        unsigned shift = (63 - __builtin_clzll( v )) - SUB_BITS;
+        return ((shift + 1) << SUB_BITS) + (unsigned) ((v >> shift) & (SUB_BUCKETS - 1));
+    }
+
+    static uint64_t bucket_low( unsigned b )
+    {
+        if( b < SUB_BUCKETS ) return b;
+        unsigned shift = (b >> SUB_BITS) - 1;
+        return (uint64_t) (SUB_BUCKETS | (b & (SUB_BUCKETS - 1))) << shift;
+    }
+
+    static uint64_t bucket_width( unsigned b )
+    {
+        return (b < SUB_BUCKETS) ? 1 : (uint64_t) 1 << ((b >> SUB_BITS) - 1);
+    }
+
+private:
+    std::atomic<uint64_t> buckets[NUM_BUCKETS] = {};
+    std::atomic<uint64_t> total { 0 };
+    std::atomic<uint64_t> sum { 0 };
+    std::atomic<uint64_t> max { 0 };
+};
+
+#endif // RDAI_LATENCY_HISTOGRAM_H
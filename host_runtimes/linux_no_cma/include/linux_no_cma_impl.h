@@ -19,9 +19,36 @@
 #ifndef RDAI_LINUX_NO_CMAi_IMPL_H
 #define RDAI_LINUX_NO_CMA_IMPL_H
 
-#include <map>
+#include <vector>
 
 #include "rdai_api.h"
+#include "platform_registry.h"
+#include "mem_pool.h"
+#include "worker_pool.h"
+#include "copy_engine.h"
+#include "completion_table.h"
+#include "async_copy.h"
+#include "device_executor.h"
+#include "frame_report.h"
+#include "queue_scheduler.h"
+#include "graph.h"
+#include "vlnv_scheduler.h"
+#include "plugin_loader.h"
+#include "init_runner.h"
+#include "api_stats.h"
+#include "run_profiler.h"
+#include "tracer.h"
+#include "probes.h"
+
+/**
+ * A device run validated and resolved by RDAI_launch_create
+ */
+struct RDAI_Launch
+{
+    RDAI_Device *device;
+    RDAI_PlatformOps *ops;
+    std::vector<RDAI_MemObject *> mem_object_list;     // NULL-terminated
+};
 
 class RDAI_Platform_Impl
 {
@@ -49,30 +76,117 @@ public:
 
     RDAI_Platform *register_platform( RDAI_PlatformOps *platform_ops );
     RDAI_Status unregister_platform( RDAI_Platform *platform );
+    RDAI_Status load_platform_plugin( const char *path );
 
     RDAI_MemObject *mem_host_allocate( size_t size );
     RDAI_MemObject *mem_device_allocate( RDAI_Device *device, size_t size );
     RDAI_MemObject *mem_shared_allocate( size_t size );
+    RDAI_MemObject *mem_host_allocate_ex( size_t size, uint64_t flags );
+    RDAI_MemObject *mem_shared_allocate_ex( size_t size, uint64_t flags );
     RDAI_Status mem_free( RDAI_MemObject *mem_object );
+    RDAI_Status mem_pool_trim( void );
+    RDAI_Status mem_pool_get_stats( RDAI_MemPoolStats *stats );
     RDAI_Status mem_copy( RDAI_MemObject *src, RDAI_MemObject *dest );
     RDAI_Status mem_copy_async( RDAI_MemObject *src, RDAI_MemObject *dest );
+    RDAI_Status mem_copy_async_cb( RDAI_MemObject *src, RDAI_MemObject *dest,
+                                   RDAI_CompletionCallback callback, void *ctx,
+                                   RDAI_Priority priority = RDAI_PRIORITY_NORMAL );
+    RDAI_Status mem_copy_async_prio( RDAI_MemObject *src, RDAI_MemObject *dest, RDAI_Priority priority );
     RDAI_MemObject *mem_crop( RDAI_MemObject *src, size_t offset, size_t crop_size );
     RDAI_Status mem_free_crop( RDAI_MemObject *mem_object );
 
     RDAI_Status platform_init( RDAI_Platform *platform, void *user_data );
     RDAI_Status platform_deinit( RDAI_Platform *platform, void *user_data );
+    RDAI_Status platform_init_async( RDAI_Platform *platform, void *user_data );
+    RDAI_Status get_platform_init_latency( const RDAI_Platform *platform, uint64_t *latency_ns );
 
     RDAI_Status device_init( RDAI_Device *device, void *user_data );
     RDAI_Status device_deinit( RDAI_Device *device, void *user_data );
+    RDAI_Status device_init_async( RDAI_Device *device, void *user_data );
 
     RDAI_Status device_run( RDAI_Device *device, RDAI_MemObject **mem_object_list );
     RDAI_Status device_run_async( RDAI_Device *device, RDAI_MemObject **mem_object_list );
+    RDAI_Status device_run_async_cb( RDAI_Device *device, RDAI_MemObject **mem_object_list,
+                                     RDAI_CompletionCallback callback, void *ctx,
+                                     RDAI_Priority priority = RDAI_PRIORITY_NORMAL );
+    RDAI_Status device_run_async_prio( RDAI_Device *device, RDAI_MemObject **mem_object_list,
+                                       RDAI_Priority priority );
+    RDAI_Status get_queue_wait_stats( RDAI_Priority priority, RDAI_QueueWaitStats *stats );
+    RDAI_Status reset_queue_wait_stats( void );
+    RDAI_Status set_backpressure( RDAI_Backpressure mode );
+    RDAI_Status get_stats( RDAI_StatsOp op, const RDAI_Device *device, RDAI_OpStats *stats );
+    RDAI_Status reset_stats( void );
+    RDAI_Status dump_stats( const char *path );
+    RDAI_Status trace_flush( void );
+    RDAI_Status set_run_counters( int enable );
+    RDAI_Status get_run_counters( const RDAI_Device *device, const RDAI_VLNV *vlnv, RDAI_RunCounters *counters );
+    RDAI_Status reset_run_counters( void );
+    RDAI_Status frame_begin( uint64_t frame_id );
+    RDAI_Status frame_select( uint64_t frame_id );
+    RDAI_Status frame_end( uint64_t frame_id );
+    RDAI_Status get_frame_stats( RDAI_FrameStage stage, RDAI_OpStats *stats );
+    RDAI_Status reset_frame_stats( void );
+    RDAI_Status dump_frame_report( const char *path );
+    FrameReport &api_frames() { return frames; }
+
+    ApiStats &api_stats() { return stats; }
+    Tracer &api_tracer() { return tracer; }
+    RDAI_Status device_run_batch( RDAI_Device *device, RDAI_MemObject ***mem_object_lists, size_t count );
+
+    RDAI_Launch *launch_create( RDAI_Device *device, RDAI_MemObject **mem_objects, size_t count );
+    RDAI_Status launch_destroy( RDAI_Launch *launch );
+    RDAI_Status launch_run( RDAI_Launch *launch );
+    RDAI_Status launch_run_async( RDAI_Launch *launch );
+    RDAI_Status submit_by_vlnv( const RDAI_VLNV *vlnv, RDAI_MemObject **mem_object_list );
+    RDAI_Status set_dispatch_policy( RDAI_DispatchPolicy policy, void *ctx );
+    RDAI_Status get_device_estimate( const RDAI_Device *device, RDAI_DeviceEstimate *estimate );
 
     RDAI_Status sync( RDAI_AsyncHandle *async_handle );
+    RDAI_Status sync_all( RDAI_AsyncHandle *async_handles, size_t count );
+    RDAI_Status wait_any( RDAI_AsyncHandle *async_handles, size_t count, int64_t timeout_us, size_t *index );
+    RDAI_Queue *queue_create( RDAI_Device *device );
+    RDAI_Status queue_destroy( RDAI_Queue *queue );
+    RDAI_Status queue_mem_copy( RDAI_Queue *queue, RDAI_MemObject *src, RDAI_MemObject *dest );
+    RDAI_Status queue_device_run( RDAI_Queue *queue, RDAI_MemObject **mem_object_list );
+    RDAI_Status queue_record_event( RDAI_Queue *queue, RDAI_Event *event );
+    RDAI_Status queue_wait_event( RDAI_Queue *queue, RDAI_Event *event );
+    RDAI_Status queue_sync( RDAI_Queue *queue );
+    RDAI_Event *event_create( void );
+    RDAI_Status event_destroy( RDAI_Event *event );
+    RDAI_Status event_sync( RDAI_Event *event );
+
+    RDAI_Status graph_begin_capture( void );
+    RDAI_Graph *graph_end_capture( void );
+    RDAI_Status graph_launch( RDAI_Graph *graph, const RDAI_GraphBinding *bindings, size_t num_bindings );
+    RDAI_Status graph_destroy( RDAI_Graph *graph );
+
+    RDAI_Status async_handle_create( void );
+    RDAI_Status async_handle_complete( const RDAI_AsyncHandle *async_handle, RDAI_Status status );
+    RDAI_Status get_handle_profile( const RDAI_AsyncHandle *async_handle, RDAI_HandleProfile *profile );
+    RDAI_Status set_handle_device_times( const RDAI_AsyncHandle *async_handle, uint64_t started_ns, uint64_t ended_ns );
 
 private:
-    std::map<RDAI_Platform *, RDAI_PlatformOps *> platform_to_ops;
-    std::map<RDAI_PlatformOps *, RDAI_Platform* > ops_to_platform;
+    void register_plugins();
+    RDAI_Status run_batch( RDAI_Device *device, RDAI_MemObject ***mem_object_lists, size_t count );
+    RDAI_Status sync_started( RDAI_AsyncHandle *async_handle );
+
+    // first: threads of the members below may still record while they stop
+    ApiStats stats;
+    Tracer tracer;
+    RunProfiler profiler;
+    PlatformRegistry registry;
+    MemPool pool;
+    WorkerPool workers;
+    CopyEngine copy_engine { workers };
+    CompletionTable completions;
+    FrameReport frames { completions };
+    QueueWaitStats wait_stats;
+    AsyncCopyEngine async_copy { copy_engine, completions, wait_stats, tracer };
+    DeviceExecutor executor { completions, wait_stats, tracer };
+    QueueScheduler queues { executor, async_copy, frames };
+    VlnvScheduler scheduler { registry, executor, completions, tracer, profiler };
+    InitRunner inits { completions, tracer };
+    PluginLoader plugins;
 };
 
 #endif // RDAI_LINUX_NO_CMA_IMPL_H
@@ -0,0 +1,136 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_MEM_POOL_H
+#define RDAI_MEM_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "rdai_api.h"
+
+/**
+ * Memory Object Pool
+ *
+ * Allocates host-visible memory objects with the RDAI_MemObject header
+ * co-allocated in front of its payload, so that an object costs a single
+ * allocation. Payloads are 64-byte aligned.
+ *
+ * Payload sizes are rounded up to one of MEM_POOL_NUM_CLASSES size classes
+ * (4 classes per power of two, from 64 B to 16 MiB). Freed blocks are kept
+ * in a small per-thread cache and in a per-class global free list, and are
+ * handed out again without going back to the OS allocator. Larger objects
+ * bypass the pool.
+ *
+ * Objects that need page alignment, pinning, huge pages or NUMA placement
+ * are mapped individually (see allocate_mapped) and are never cached.
+ *
+ * The pool lives for the lifetime of the process.
+ */
+
+#define MEM_POOL_MIN_CLASS_SIZE     64
+#define MEM_POOL_MAX_CLASS_SIZE     (16u << 20)
+#define MEM_POOL_NUM_CLASSES        73
+#define MEM_POOL_LARGE_CLASS        MEM_POOL_NUM_CLASSES
+#define MEM_POOL_MAPPED_CLASS       (MEM_POOL_NUM_CLASSES + 1)
+
+struct MemPoolThreadCache;
+
+class MemPool
+{
+public:
+
+    /**
+     * Allocate a memory object with a co-allocated payload
+     *
+     * The returned object is zeroed except for host_ptr, size and flags
+     *
+     * @param size The payload size in bytes (must be > 0)
+     * @return The memory object or NULL
+     */
+    RDAI_MemObject *allocate( size_t size );
+
+    /**
+     * Allocate a memory object whose payload is mapped with mmap
+     *
+     * The payload is page-aligned, and optionally pinned, backed by huge
+     * pages and bound to a NUMA node. The granted properties are recorded
+     * in the flags of the returned object
+     *
+     * @param size The payload size in bytes (must be > 0)
+     * @param flags A combination of RDAI_MEM_FLAG_* values
+     * @return The memory object or NULL if a strict flag cannot be honored
+     */
+    RDAI_MemObject *allocate_mapped( size_t size, uint64_t flags );
+
+    /**
+     * Return a memory object allocated by this pool
+     *
+     * As with free(), the object must have been allocated by this pool and
+     * not released yet: the block header in front of it is read unchecked
+     *
+     * @param mem_object The memory object to release
+     */
+    void release( RDAI_MemObject *mem_object );
+
+    /**
+     * Return all free blocks cached by the pool and by the calling thread
+     * to the OS allocator
+     *
+     * Blocks cached by other threads are returned when those threads exit
+     */
+    void trim();
+
+    void get_stats( RDAI_MemPoolStats *stats );
+
+    static size_t size_to_class( size_t size );
+    static size_t class_to_size( size_t size_class );
+
+    // internal: used by per-thread caches
+    struct Block;
+    void push_global( size_t size_class, Block *head, Block *tail, size_t count );
+    size_t pop_global( size_t size_class, Block **head, size_t max_count );
+    void retire_cache( MemPoolThreadCache *cache );
+
+private:
+
+    struct FreeList
+    {
+        std::mutex lock;
+        Block *head = nullptr;
+        size_t count = 0;
+    };
+
+    MemPoolThreadCache *local_cache();
+    Block *new_block( size_t size_class, size_t size );
+    static void delete_block( Block *block );
+
+    FreeList free_lists[MEM_POOL_NUM_CLASSES];
+    std::atomic<uint64_t> global_bytes_held { 0 };
+
+    // statistics of caches of exited threads and of cache-less operations
+    std::mutex caches_lock;
+    MemPoolThreadCache *caches = nullptr;
+    std::atomic<uint64_t> retired_hits { 0 };
+    std::atomic<uint64_t> retired_misses { 0 };
+    std::atomic<int64_t> retired_bytes_in_use { 0 };
+};
+
+#endif // RDAI_MEM_POOL_H
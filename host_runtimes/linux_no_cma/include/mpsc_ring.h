@@ -0,0 +1,135 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_MPSC_RING_H
+#define RDAI_MPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ * MPSC Ring
+ *
+ * A bounded lock-free queue with any number of producers and one consumer,
+ * after Vyukov's bounded queue. Every slot carries a sequence number that
+ * says whose turn it is: a producer claims the slot at the tail with a
+ * compare-and-swap, moves its item in and publishes it by bumping the
+ * sequence; the consumer takes published items in order and hands each
+ * slot back to the producers of the next lap the same way. Producers
+ * never wait for each other beyond a retried compare-and-swap, and a full
+ * ring is reported to the producer instead of blocking it.
+ *
+ * The capacity is rounded up to a power of two.
+ */
+template <typename T>
+class MpscRing
+{
+public:
+
+    explicit MpscRing( size_t min_capacity )
+    {
+        size_t capacity = 2;
+        while( capacity < min_capacity ) capacity <<= 1;
+        mask = capacity - 1;
+        slots.reset( new Slot[capacity] );
+        for( size_t i = 0; i < capacity; i++ ) slots[i].seq.store( i, std::memory_order_relaxed );
+    }
+
+    MpscRing( const MpscRing& ) = delete;
+    MpscRing& operator=( const MpscRing& ) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    /**
+     * Append an item (any thread)
+     *
+     * @return false if the ring is full; item is left untouched then
+     */
+    bool try_push( T &&item )
+    {
+        uint64_t pos = tail.load( std::memory_order_relaxed );
+        for( ;; ) {
+            Slot &slot = slots[pos & mask];
+            int64_t diff = (int64_t) (slot.seq.load( std::memory_order_acquire ) - pos);
+            if( diff == 0 ) {
+                if( tail.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) {
+                    slot.item = std::move( item );
+                    slot.seq.store( pos + 1, std::memory_order_release );
+                    return true;
+                }
+            }
+            else if( diff < 0 ) {
+                return false;       // the consumer has not freed this slot of the previous lap
+            }
+            else {
+                pos = tail.load( std::memory_order_relaxed );
+            }
+        }
+    }
+
+    /**
+     * Whether the next item is published (consumer only)
+     */
+    bool ready() const
+    {
+        return slots[head & mask].seq.load( std::memory_order_acquire ) == head + 1;
+    }
+
+    /**
+     * Take up to max published items, in order (consumer only)
+     *
+     * @param f Called with each item (as T&&)
+     * @return The number of items taken
+     */
+    template <typename F>
+    size_t drain( F &&f, size_t max )
+    {
+        size_t n = 0;
+        while( n < max ) {
+            Slot &slot = slots[head & mask];
+            if( slot.seq.load( std::memory_order_acquire ) != head + 1 ) break;
+            f( std::move( slot.item ) );
+            slot.item = T();
+            slot.seq.store( head + mask + 1, std::memory_order_release );
+            head++;
+            n++;
+        }
+        return n;
+    }
+
+private:
+
+    // a line per slot: producers of neighbouring slots do not share lines
+    struct alignas( 64 ) Slot
+    {
+        std::atomic<uint64_t> seq;
+        T item;
+    };
+
+    size_t mask;
+    std::unique_ptr<Slot[]> slots;
+
+    // producers and the consumer write different cache lines
+    alignas( 64 ) std::atomic<uint64_t> tail { 0 };
+    alignas( 64 ) uint64_t head = 0;
+};
+
+#endif // RDAI_MPSC_RING_H
@@ -0,0 +1,178 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_PLATFORM_REGISTRY_H
+#define RDAI_PLATFORM_REGISTRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "rdai_api.h"
+#include "epoch.h"
+
+/**
+ * Platform Registry
+ *
+ * Maps registered platforms to their platform ops through a flat table
+ * indexed by the platform ID assigned at registration. Slot 0 is never used
+ * since valid RDAI IDs must be > 0. IDs of unregistered platforms are
+ * recycled so that the table stays dense.
+ *
+ * The table is an immutable snapshot. Lookups run inside an epoch read-side
+ * section (see ReadGuard) and never take a lock. Registration copies the
+ * table, publishes the copy and retires the old snapshot once no reader can
+ * still see it. Unregistration additionally waits for in-flight readers, so
+ * that a platform is never destroyed while one of its ops is running.
+ *
+ * Platform ops, which can block (a run, a sync, an initialization loading
+ * a bitstream for seconds), run under a Pin instead of a read-side section:
+ * a pin keeps one platform registered, so that only the unregistration of
+ * that platform waits for the op, instead of every registry update. Pins
+ * are counted per table slot, with one atomic add and one subtract.
+ */
+class PlatformRegistry
+{
+public:
+
+    struct Entry
+    {
+        RDAI_Platform *platform;
+        RDAI_PlatformOps *ops;
+        std::atomic<uint32_t> *pins;    // the pin count of the slot
+    };
+
+    /**
+     * Read-side section
+     *
+     * Pointers returned by find_* and entries visited by for_each
+     * stay valid for as long as the guard is alive.
+     */
+    class ReadGuard : public EpochDomain::ReadGuard
+    {
+    public:
+        explicit ReadGuard( PlatformRegistry &r ) : EpochDomain::ReadGuard( r.epochs ) {}
+    };
+
+    /**
+     * Keeps a platform registered while its ops run, outside of any
+     * read-side section; ops is NULL if the platform is not registered
+     */
+    class Pin
+    {
+    public:
+        Pin( PlatformRegistry &r, const RDAI_Platform *platform ) : ops( r.pin( platform, &count ) ) {}
+        ~Pin() { if( count ) PlatformRegistry::unpin( count ); }
+        Pin( const Pin& ) = delete;
+        Pin& operator=( const Pin& ) = delete;
+
+    private:
+        std::atomic<uint32_t> *count = NULL;
+
+    public:
+        RDAI_PlatformOps *const ops;
+    };
+
+    PlatformRegistry();
+    ~PlatformRegistry();
+    PlatformRegistry( const PlatformRegistry& ) = delete;
+    PlatformRegistry& operator=( const PlatformRegistry& ) = delete;
+
+    /**
+     * Create and register the platform of a platform ops table
+     *
+     * If the ops are already registered, the existing platform is returned
+     *
+     * @param ops The platform ops of the platform
+     * @return The registered platform (with its ID assigned) or NULL
+     */
+    RDAI_Platform *add( RDAI_PlatformOps *ops );
+
+    /**
+     * Remove a platform from the registry and clear its ID
+     *
+     * Returns once no reader can observe the platform anymore and no pin
+     * of it is left
+     *
+     * @param platform The platform to remove
+     * @return The platform ops of the removed platform or NULL
+     */
+    RDAI_PlatformOps *remove( RDAI_Platform *platform );
+
+    /**
+     * Find the platform ops of a registered platform
+     *
+     * Must be called within a read-side section
+     *
+     * @param platform The platform to look up
+     * @return The platform ops or NULL if the platform is not registered
+     */
+    RDAI_PlatformOps *find_ops( const RDAI_Platform *platform ) const
+    {
+        const Snapshot *s = current.load( std::memory_order_acquire );
+        uint32_t id = __atomic_load_n( &platform->id.value, __ATOMIC_RELAXED );
+        if( id < s->entries.size() && s->entries[id].platform == platform ) {
+            return s->entries[id].ops;
+        }
+        return NULL;
+    }
+
+    RDAI_Platform *find_platform( const RDAI_PlatformOps *ops ) const;
+    RDAI_Platform *find_platform( uint32_t id ) const;
+
+    template <typename Callable>
+    void for_each( Callable&& c ) const
+    {
+        const Snapshot *s = current.load( std::memory_order_acquire );
+        for( const Entry &e : s->entries ) {
+            if( e.platform ) c( e );
+        }
+    }
+
+private:
+
+    struct Snapshot
+    {
+        std::vector<Entry> entries;
+    };
+
+    // set in the pin count of a slot whose platform is being removed
+    static const uint32_t PIN_REMOVING = 1u << 31;
+
+    RDAI_PlatformOps *pin( const RDAI_Platform *platform, std::atomic<uint32_t> **count );
+    static void unpin( std::atomic<uint32_t> *count );
+    void publish( Snapshot *next );
+    void reclaim( bool wait );
+
+    EpochDomain epochs;
+    std::atomic<const Snapshot *> current;
+
+    // writer state
+    std::mutex writer_lock;
+    std::vector<uint32_t> free_ids;
+    std::vector<std::pair<uint64_t, const Snapshot *>> retired;
+
+    // pin counts by slot, never moved (a slot is reused once its count
+    // is back to 0)
+    std::deque<std::atomic<uint32_t>> pin_counts;
+};
+
+#endif // RDAI_PLATFORM_REGISTRY_H
@@ -0,0 +1,89 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_PLUGIN_LOADER_H
+#define RDAI_PLUGIN_LOADER_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "rdai_api.h"
+
+/**
+ * Plugin Loader
+ *
+ * Opens platform plugins (shared libraries exporting RDAI_PLUGIN_OPS_SYMBOL)
+ * and keeps their platform ops pending until the host runtime registers
+ * them, so that platform_create only runs once platforms are looked up.
+ * Plugin libraries are never closed: registered platforms and in-flight
+ * handles point into them.
+ */
+class PluginLoader
+{
+public:
+
+    PluginLoader() = default;
+    PluginLoader( const PluginLoader& ) = delete;
+    PluginLoader& operator=( const PluginLoader& ) = delete;
+
+    /**
+     * Open a plugin and queue its platform ops for registration
+     *
+     * @param path The path of the shared library
+     * @return The platform ops of the plugin or NULL
+     */
+    RDAI_PlatformOps *load( const char *path );
+
+    /**
+     * Load the plugins listed in RDAI_PLUGIN_PATH (on the first call only)
+     *
+     * Entries that cannot be loaded are skipped
+     */
+    void scan()
+    {
+        std::call_once( scanned, &PluginLoader::scan_path, this );
+    }
+
+    /**
+     * Call c( ops ) for every queued platform ops and clear the queue
+     *
+     * Concurrent callers return once the queue has been registered, so a
+     * lookup that follows never misses a loaded plugin
+     */
+    template <typename Callable>
+    void register_pending( Callable&& c )
+    {
+        if( !has_pending.load( std::memory_order_acquire ) ) return;
+        std::lock_guard<std::mutex> guard( lock );
+        for( RDAI_PlatformOps *ops : pending ) c( ops );
+        pending.clear();
+        has_pending.store( false, std::memory_order_release );
+    }
+
+private:
+    void scan_path();
+
+    std::once_flag scanned;
+    std::atomic<bool> has_pending { false };
+    std::mutex lock;
+    std::vector<void *> libraries;
+    std::vector<RDAI_PlatformOps *> pending;
+};
+
+#endif // RDAI_PLUGIN_LOADER_H
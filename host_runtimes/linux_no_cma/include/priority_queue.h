@@ -0,0 +1,142 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_PRIORITY_QUEUE_H
+#define RDAI_PRIORITY_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+#include "rdai_api.h"
+#include "latency_histogram.h"
+
+/**
+ * Queue Wait Statistics
+ *
+ * The time asynchronous work spends queued in the host runtime, per
+ * priority class, and the aging setting shared by the priority queues.
+ * The aging step is read from RDAI_PRIORITY_AGING_US (default 10 ms).
+ */
+class QueueWaitStats
+{
+public:
+
+    QueueWaitStats();
+
+    void record( RDAI_Priority priority, uint64_t wait_ns, bool aged )
+    {
+        waits[priority].record( wait_ns );
+        if( aged ) num_aged[priority].fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    void get( RDAI_Priority priority, RDAI_QueueWaitStats *stats ) const;
+    void reset();
+
+    uint64_t aging_ns() const { return aging; }
+
+private:
+    uint64_t aging;
+    LatencyHistogram waits[RDAI_NUM_PRIORITIES];
+    std::atomic<uint64_t> num_aged[RDAI_NUM_PRIORITIES] = {};
+};
+
+/**
+ * Priority Queue
+ *
+ * A FIFO per priority class. pop() takes the oldest item of the highest
+ * priority class, except that waiting ages an item: an item of class c that
+ * has waited w is considered of class c - w / aging_ns, so lower priority
+ * work overtakes new higher priority work once it has waited long enough and
+ * can never starve. The wait of every popped item is recorded in the
+ * QueueWaitStats.
+ *
+ * Not thread-safe: owners call it under their own lock, or from one thread.
+ */
+template <typename T>
+class PriorityQueue
+{
+public:
+
+    explicit PriorityQueue( QueueWaitStats &stats ) : stats( stats ) {}
+
+    bool empty() const { return num_items == 0; }
+    size_t size() const { return num_items; }
+
+    void push( T item, RDAI_Priority priority )
+    {
+        push( std::move( item ), priority, clock::now() );
+    }
+
+    /**
+     * Add an item queued elsewhere since enqueued, which counts as waiting
+     */
+    void push( T item, RDAI_Priority priority, std::chrono::steady_clock::time_point enqueued )
+    {
+        classes[priority].push_back( Entry { std::move( item ), enqueued } );
+        num_items++;
+    }
+
+    /**
+     * Remove the next item (the queue must not be empty)
+     */
+    T pop()
+    {
+        clock::time_point now = clock::now();
+        int64_t aging = (int64_t) stats.aging_ns();
+        int first = -1, best = -1;
+        int64_t best_score = 0;
+        for( int c = 0; c < RDAI_NUM_PRIORITIES; c++ ) {
+            if( classes[c].empty() ) continue;
+            if( first < 0 ) first = c;
+            int64_t waited = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        now - classes[c].front().enqueued ).count();
+            int64_t score = c * aging - waited;
+            if( best < 0 || score < best_score ) {
+                best = c;
+                best_score = score;
+            }
+        }
+
+        Entry &entry = classes[best].front();
+        uint64_t waited = std::chrono::duration_cast<std::chrono::nanoseconds>( now - entry.enqueued ).count();
+        stats.record( (RDAI_Priority) best, waited, best != first );
+        T item = std::move( entry.item );
+        classes[best].pop_front();
+        num_items--;
+        return item;
+    }
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    struct Entry
+    {
+        T item;
+        clock::time_point enqueued;
+    };
+
+    QueueWaitStats &stats;
+    std::deque<Entry> classes[RDAI_NUM_PRIORITIES];
+    size_t num_items = 0;
+};
+
+#endif // RDAI_PRIORITY_QUEUE_H
@@ -0,0 +1,136 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_PROBES_H
+#define RDAI_PROBES_H
+
+#include <cstdint>
+
+#include "rdai_api.h"
+
+/**
+ * USDT Probes
+ *
+ * Statically defined tracing probes for bpftrace, perf and SystemTap, in
+ * the "rdai" provider. They are built when <sys/sdt.h> is available
+ * (systemtap-sdt-dev, systemtap-sdt-devel) unless RDAI_DISABLE_USDT is
+ * defined, and compile to nothing otherwise. An unattached probe is a nop
+ * instruction, but its arguments are still evaluated: keep them to loads of
+ * fields already at hand.
+ *
+ * Probes, all arguments being 64-bit integers:
+ *  - <method>__entry, <method>__exit (platform ID, device ID, bytes, handle
+ *    ID): entry and exit of the host runtime method of each API call (e.g.
+ *    device_run__entry). Arguments are 0 when they do not apply: bytes is
+ *    the size allocated, copied or cropped, and the handle ID is the one
+ *    synchronized or completed
+ *  - async__submit (handle ID, platform ID, device ID, bytes): an
+ *    asynchronous call got a handle of the host runtime; fires before the
+ *    call is queued, so always before the async__complete of the handle
+ *  - async__complete (handle ID, status code, error reason): the call of a
+ *    handle finished
+ *
+ * Asynchronous calls also run their synchronous method on the thread that
+ * executes them, so e.g. device_run__entry fires on the device thread for
+ * every run queued with RDAI_device_run_async.
+ */
+
+#if defined(__has_include) && !defined(RDAI_DISABLE_USDT)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define RDAI_HAVE_USDT
+#endif
+#endif
+
+inline uint64_t probe_platform_id( const RDAI_Platform *platform )
+{
+    return platform ? platform->id.value : 0;
+}
+
+inline uint64_t probe_device_platform_id( const RDAI_Device *device )
+{
+    return device ? probe_platform_id( device->platform ) : 0;
+}
+
+inline uint64_t probe_device_id( const RDAI_Device *device )
+{
+    return device ? device->id.value : 0;
+}
+
+inline uint64_t probe_handle_id( const RDAI_AsyncHandle *async_handle )
+{
+    return async_handle ? async_handle->id.value : 0;
+}
+
+inline uint64_t probe_size( const RDAI_MemObject *mem_object )
+{
+    return mem_object ? mem_object->size : 0;
+}
+
+/**
+ * Get the device a copy is attributed to (if any)
+ */
+inline const RDAI_Device *copy_device( const RDAI_MemObject *src, const RDAI_MemObject *dest )
+{
+    if( src && src->mem_type == RDAI_MemObjectType::RDAI_MEM_DEVICE ) return src->device;
+    if( dest && dest->mem_type == RDAI_MemObjectType::RDAI_MEM_DEVICE ) return dest->device;
+    return NULL;
+}
+
+#ifdef RDAI_HAVE_USDT
+
+#define RDAI_PROBE_SCOPE_IDS( name, platform_id, device_id, bytes, handle_id ) \
+    struct RDAI_Probe_##name \
+    { \
+        uint64_t platform, device, size, handle; \
+        ~RDAI_Probe_##name() { DTRACE_PROBE4( rdai, name##__exit, platform, device, size, handle ); } \
+    } rdai_probe_scope_ { (uint64_t) (platform_id), (uint64_t) (device_id), (uint64_t) (bytes), \
+                          (uint64_t) (handle_id) }; \
+    DTRACE_PROBE4( rdai, name##__entry, rdai_probe_scope_.platform, rdai_probe_scope_.device, \
+                   rdai_probe_scope_.size, rdai_probe_scope_.handle )
+
+#define RDAI_PROBE_SUBMIT( handle, device, bytes ) \
+    DTRACE_PROBE4( rdai, async__submit, (uint64_t) (handle), ::probe_device_platform_id( device ), \
+                   ::probe_device_id( device ), (uint64_t) (bytes) )
+
+#define RDAI_PROBE_COMPLETE( handle, status ) \
+    DTRACE_PROBE3( rdai, async__complete, (uint64_t) (handle), (int64_t) (status).status_code, \
+                   (int64_t) (status).error_reason )
+
+#else
+
+#define RDAI_PROBE_SCOPE_IDS( name, platform_id, device_id, bytes, handle_id )  (void) 0
+#define RDAI_PROBE_SUBMIT( handle, device, bytes )                              (void) 0
+#define RDAI_PROBE_COMPLETE( handle, status )                                   (void) 0
+
+#endif // RDAI_HAVE_USDT
+
+// entry and exit probes of a method, for a device (or NULL) and a size
+#define RDAI_PROBE_SCOPE( name, device, bytes ) \
+    RDAI_PROBE_SCOPE_IDS( name, ::probe_device_platform_id( device ), ::probe_device_id( device ), bytes, 0 )
+
+// entry and exit probes of a method, for a platform
+#define RDAI_PROBE_PLATFORM_SCOPE( name, platform ) \
+    RDAI_PROBE_SCOPE_IDS( name, ::probe_platform_id( platform ), 0, 0, 0 )
+
+// entry and exit probes of a method, for an async handle (or NULL)
+#define RDAI_PROBE_HANDLE_SCOPE( name, async_handle ) \
+    RDAI_PROBE_SCOPE_IDS( name, ::probe_platform_id( (async_handle) ? (async_handle)->platform : NULL ), 0, 0, \
+                          ::probe_handle_id( async_handle ) )
+
+#endif // RDAI_PROBES_H
@@ -0,0 +1,158 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_QUEUE_SCHEDULER_H
+#define RDAI_QUEUE_SCHEDULER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "rdai_api.h"
+#include "device_executor.h"
+#include "async_copy.h"
+#include "frame_report.h"
+
+/**
+ * Queue Scheduler
+ *
+ * Executes the commands of RDAI_Queue objects. The commands of a queue
+ * execute one at a time, in submission order; commands of different queues
+ * execute concurrently. A command is forwarded as soon as the previous
+ * command of its queue has completed and, for an event wait, as soon as the
+ * awaited record of the event has been reached:
+ *  - device work executes on the DeviceExecutor lane of its device
+ *  - host-side copies execute on the AsyncCopyEngine copy threads, so that a
+ *    copy queue overlaps with a run queue of the same device
+ *  - event records and waits are resolved by the scheduler itself
+ *
+ * Queue commands do not use handles: the first error of a queue is kept and
+ * returned by sync(). Copies and runs are attributed to the frame current
+ * when they were submitted (see FrameReport).
+ */
+
+/**
+ * Records of an event are numbered in submission order, and a wait is for
+ * the record submitted last before it: records on different queues may be
+ * reached out of order, so each is tracked on its own.
+ */
+struct QueueEventState
+{
+    uint64_t recorded  = 0;     // number of records submitted
+    uint64_t completed = 0;     // records up to this one are all reached
+    std::set<uint64_t> reached; // records reached beyond completed
+    std::vector<RDAI_Queue *> waiters;
+
+    bool has_reached( uint64_t record ) const { return record <= completed || reached.count( record ); }
+};
+
+struct RDAI_Event
+{
+    std::shared_ptr<QueueEventState> state;
+};
+
+struct RDAI_Queue
+{
+    enum CommandKind
+    {
+        COMMAND_DEVICE,         // work on the lane of a device
+        COMMAND_HOST_COPY,      // copy on the copy threads
+        COMMAND_RECORD,
+        COMMAND_WAIT,
+    };
+
+    struct Command
+    {
+        CommandKind kind;
+        RDAI_Device *device;
+        DeviceExecutor::Work work;
+        void *dest;
+        const void *src;
+        size_t size;
+        std::shared_ptr<QueueEventState> event;
+        uint64_t target;
+        uint64_t frame;         // the current frame at submission
+        FrameReport::Op op;
+    };
+
+    RDAI_Device *device;
+    std::deque<Command> commands;
+    bool busy = false;          // the head command is executing
+    bool failed = false;
+    RDAI_Status error;
+};
+
+class QueueScheduler
+{
+public:
+
+    QueueScheduler( DeviceExecutor &executor, AsyncCopyEngine &async_copy, FrameReport &frames )
+        : executor( executor ), async_copy( async_copy ), frames( frames ) {}
+
+    RDAI_Queue *create_queue( RDAI_Device *device );
+
+    /**
+     * Wait for the commands of a queue and free it
+     */
+    void destroy_queue( RDAI_Queue *queue );
+
+    void submit_device( RDAI_Queue *queue, RDAI_Device *device, FrameReport::Op op, DeviceExecutor::Work work );
+    void submit_host_copy( RDAI_Queue *queue, void *dest, const void *src, size_t size );
+    void record( RDAI_Queue *queue, RDAI_Event *event );
+    void wait( RDAI_Queue *queue, RDAI_Event *event );
+
+    /**
+     * Wait for all the commands submitted to a queue
+     *
+     * @param error The first error of the queue since the last sync (output)
+     * @return false if a command failed
+     */
+    bool sync( RDAI_Queue *queue, RDAI_Status *error );
+
+    /**
+     * Wait for the last record of an event submitted so far (and not for
+     * the records before it)
+     */
+    void sync_event( RDAI_Event *event );
+
+private:
+
+    // head commands to forward, moved out of their queue under the lock
+    typedef std::vector<std::pair<RDAI_Queue *, RDAI_Queue::Command>> Ready;
+
+    void enqueue( RDAI_Queue *queue, RDAI_Queue::Command command );
+    void advance( RDAI_Queue *queue, Ready *ready );
+    void dispatch( Ready &ready );
+    void on_done( RDAI_Queue *queue, RDAI_Status status );
+
+    DeviceExecutor &executor;
+    AsyncCopyEngine &async_copy;
+    FrameReport &frames;
+
+    // protects the state of all queues and events
+    std::mutex lock;
+    std::condition_variable cv;
+};
+
+#endif // RDAI_QUEUE_SCHEDULER_H
@@ -0,0 +1,133 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_RUN_PROFILER_H
+#define RDAI_RUN_PROFILER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "rdai_api.h"
+
+/**
+ * Run Profiler
+ *
+ * Host CPU counters around the device_run of platforms (see
+ * RDAI_set_run_counters). Every thread executing runs opens its own
+ * perf_event group on its first counted run: cycles, instructions, last
+ * level cache misses, branch misses and CPU time, each left out if the
+ * host cannot count it. The group is read before and after each run, and
+ * the difference, scaled up when the kernel multiplexed the counters, is
+ * added to the totals of the device. Totals are keyed by device and keep
+ * its VLNV, so that devices can be reported together by VLNV. The totals
+ * of the devices of an unregistered platform are retired (merged by VLNV),
+ * so that a device later allocated at the same address starts from zero.
+ *
+ * Counting is off unless RDAI_RUN_COUNTERS=1 or set_enabled(true); runs
+ * then only pay for a relaxed load. There is one instance per process.
+ */
+class RunProfiler
+{
+public:
+
+    static const size_t NUM_COUNTERS = 5;
+
+    struct Sample
+    {
+        uint64_t time_enabled;
+        uint64_t time_running;
+        uint64_t values[NUM_COUNTERS];      // in RDAI_COUNTER_* bit order
+    };
+
+    class Group;
+
+    class Scope
+    {
+    public:
+        Scope( RunProfiler &profiler, const RDAI_Device *device, size_t runs = 1 )
+            : profiler( profiler ), device( device ), runs( runs ),
+              group( profiler.enabled.load( std::memory_order_relaxed ) ? profiler.begin( start ) : NULL ) {}
+        ~Scope() { if( group ) profiler.end( group, device, runs, start ); }
+        Scope( const Scope& ) = delete;
+        Scope& operator=( const Scope& ) = delete;
+
+    private:
+        RunProfiler &profiler;
+        const RDAI_Device *device;
+        size_t runs;
+        Sample start;
+        Group *group;
+    };
+
+    RunProfiler();
+    ~RunProfiler();
+    RunProfiler( const RunProfiler& ) = delete;
+    RunProfiler& operator=( const RunProfiler& ) = delete;
+
+    void set_enabled( bool enable ) { enabled.store( enable, std::memory_order_relaxed ); }
+
+    /**
+     * Get the totals of a device, of the devices with a VLNV, or of all
+     * devices
+     *
+     * @param device The device, or NULL
+     * @param vlnv The VLNV when device is NULL, or NULL for all devices
+     */
+    void get( const RDAI_Device *device, const RDAI_VLNV *vlnv, RDAI_RunCounters *counters ) const;
+
+    void reset();
+
+    /**
+     * Retire the totals of the devices of a platform being unregistered
+     * (once no run of the platform is in flight)
+     */
+    void remove_platform( const RDAI_Platform *platform );
+
+private:
+
+    struct Totals
+    {
+        const RDAI_Platform *platform;
+        RDAI_VLNV vlnv;
+        RDAI_RunCounters counters;
+    };
+
+    /**
+     * Read the group of the calling thread (opening it on first use)
+     *
+     * @return The group, or NULL if no counter can be opened or read
+     */
+    Group *begin( Sample &start );
+    void end( Group *group, const RDAI_Device *device, size_t runs, const Sample &start );
+
+    std::atomic<bool> enabled { false };
+
+    mutable std::mutex lock;
+    std::unordered_map<const RDAI_Device *, Totals> totals;
+    std::vector<Totals> retired;
+};
+
+#define RDAI_RUN_PROFILE_SCOPE( profiler, device )              RunProfiler::Scope rdai_run_profile_scope_( (profiler), (device) )
+#define RDAI_RUN_PROFILE_BATCH_SCOPE( profiler, device, runs )  RunProfiler::Scope rdai_run_profile_scope_( (profiler), (device), (runs) )
+
+#endif // RDAI_RUN_PROFILER_H
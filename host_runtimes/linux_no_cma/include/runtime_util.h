@@ -0,0 +1,72 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_RUNTIME_UTIL_H
+#define RDAI_RUNTIME_UTIL_H
+
+#include <cstdint>
+#include <string>
+
+#include "rdai_api.h"
+
+/**
+ * Runtime Utilities
+ *
+ * Helpers shared by the modules of the host runtime: status construction,
+ * and the writing of report files (statistics, frame reports, traces).
+ */
+
+inline RDAI_Status make_status_error( RDAI_ErrorReason reason )
+{
+    RDAI_Status status;
+    status.status_code  = RDAI_StatusCode::RDAI_STATUS_ERROR;
+    status.error_reason = reason;
+    return status;
+}
+
+inline RDAI_Status make_status_ok()
+{
+    RDAI_Status status;
+    status.status_code  = RDAI_StatusCode::RDAI_STATUS_OK;
+    return status;
+}
+
+/**
+ * Construct the status of an async call with a handle of the host runtime
+ */
+inline RDAI_Status make_status_ok_async( uint32_t id )
+{
+    RDAI_Status status;
+    status.status_code  = RDAI_StatusCode::RDAI_STATUS_OK;
+    status.async_handle.id.value  = id;
+    status.async_handle.platform  = NULL;
+    status.async_handle.user_data = NULL;
+    return status;
+}
+
+/**
+ * Write a file in one piece: to path.tmp, renamed to path once complete, so
+ * that readers never see a partial file
+ *
+ * @param path The file to write
+ * @param contents What to write
+ * @return false if the file could not be written (path is left as it was)
+ */
+bool write_file_atomic( const char *path, const std::string &contents );
+
+#endif // RDAI_RUNTIME_UTIL_H
@@ -0,0 +1,83 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_TICK_CLOCK_H
+#define RDAI_TICK_CLOCK_H
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * Tick Clock
+ *
+ * A cheap timestamp source for instrumentation: the invariant time stamp
+ * counter on x86, the generic timer on AArch64 and steady_clock (in ns)
+ * otherwise. Ticks are converted to ns with a ratio calibrated against
+ * steady_clock since the clock was constructed.
+ */
+class TickClock
+{
+public:
+
+    TickClock() : start_ticks( now() ), start_time( std::chrono::steady_clock::now() ) {}
+
+    static uint64_t now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        if( tsc_invariant() ) return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t t;
+        __asm__ volatile( "mrs %0, cntvct_el0" : "=r"( t ) );
+        return t;
+#endif
+        return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch() ).count();
+    }
+
+    /**
+     * Get the tick count when the clock was constructed
+     */
+    uint64_t start() const { return start_ticks; }
+
+    /**
+     * Get the duration of a tick in ns
+     *
+     * Blocks until the clock has run for a few ms, so that the calibration
+     * is meaningful; the longer it has been running, the better the ratio
+     */
+    double ns_per_tick() const;
+
+private:
+    // a function-local static: clocks of other static objects may be
+    // constructed before the static objects of tick_clock.cpp
+    static bool tsc_invariant()
+    {
+        static const bool invariant = has_invariant_tsc();
+        return invariant;
+    }
+    static bool has_invariant_tsc();
+
+    uint64_t start_ticks;
+    std::chrono::steady_clock::time_point start_time;
+};
+
+#endif // RDAI_TICK_CLOCK_H
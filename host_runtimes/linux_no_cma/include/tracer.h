@@ -0,0 +1,201 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_TRACER_H
+#define RDAI_TRACER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rdai_api.h"
+#include "tick_clock.h"
+
+/**
+ * Tracer
+ *
+ * Records host API calls, platform op invocations and the lifetime of
+ * asynchronous handles when RDAI_TRACE_FILE is set, and writes them to that
+ * file as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev) when
+ * the program exits or on RDAI_trace_flush.
+ *
+ * Every thread records into its own ring of RDAI_TRACE_BUFFER_EVENTS events
+ * (65536 by default; the oldest events are overwritten), with plain relaxed
+ * stores and no locks. Rings of exited threads are kept and handed to new
+ * threads, so the memory of the tracer is bounded by the number of live
+ * threads. In the trace, host API calls appear on the thread
+ * that made them; each device is a process of its own, holding the platform
+ * ops invoked for it and the spans of its asynchronous work from submission
+ * to completion. Flow arrows link each submission to the RDAI_sync (or
+ * sync_all, wait_any) of its handle. There is one instance per process.
+ */
+class Tracer
+{
+public:
+
+    class Scope
+    {
+    public:
+        Scope( Tracer &tracer, const char *name, const RDAI_Device *device )
+            : tracer( tracer ), name( name ), device( device ), start( tracer.active() ? TickClock::now() : 0 ) {}
+        ~Scope() { if( start ) tracer.complete( name, device, start ); }
+        Scope( const Scope& ) = delete;
+        Scope& operator=( const Scope& ) = delete;
+
+    private:
+        Tracer &tracer;
+        const char *name;
+        const RDAI_Device *device;
+        uint64_t start;
+    };
+
+    Tracer();
+    ~Tracer();
+    Tracer( const Tracer& ) = delete;
+    Tracer& operator=( const Tracer& ) = delete;
+
+    bool active() const { return enabled; }
+
+    /**
+     * Record a call from start (in TickClock ticks) until now
+     *
+     * @param name The name of the call (must outlive the tracer)
+     * @param device The device track of the call, or NULL for the thread
+     */
+    void complete( const char *name, const RDAI_Device *device, uint64_t start )
+    {
+        if( enabled ) record( 'X', name, device, start, TickClock::now() - start, 0 );
+    }
+
+    /**
+     * Begin the span of an asynchronous handle
+     *
+     * @param ts When the span begins (in TickClock ticks)
+     */
+    void async_begin( const char *name, const RDAI_Device *device, uint32_t id, uint64_t ts )
+    {
+        if( enabled ) record( 'b', name, device, ts, 0, id );
+    }
+
+    void async_begin( const char *name, const RDAI_Device *device, uint32_t id )
+    {
+        if( enabled ) record( 'b', name, device, TickClock::now(), 0, id );
+    }
+
+    /**
+     * End the span of an asynchronous handle (name and device as at the begin)
+     */
+    void async_end( const char *name, const RDAI_Device *device, uint32_t id )
+    {
+        if( enabled ) record( 'e', name, device, TickClock::now(), 0, id );
+    }
+
+    /**
+     * Start the flow of a handle (at its submission)
+     */
+    void flow_begin( uint32_t id )
+    {
+        if( enabled ) record( 's', "handle", NULL, TickClock::now(), 0, id );
+    }
+
+    /**
+     * End the flow of a handle (where it is synchronized)
+     */
+    void flow_end( uint32_t id )
+    {
+        if( enabled ) record( 'f', "handle", NULL, TickClock::now(), 0, id );
+    }
+
+    /**
+     * Write the recorded events to RDAI_TRACE_FILE
+     *
+     * The rings are not cleared: a later flush writes them again
+     *
+     * @return false if tracing is disabled or the file cannot be written
+     */
+    bool flush();
+
+private:
+
+    // an event is EVENT_WORDS words: ts, dur, name, id, track << 8 | phase
+    static const size_t EVENT_WORDS = 5;
+
+    struct Ring
+    {
+        std::unique_ptr<uint64_t[]> words;
+        std::atomic<uint64_t> head { 0 };
+        uint32_t tid;
+
+        // device -> track cache, only used by the owning thread
+        std::vector<std::pair<const RDAI_Device *, uint32_t>> tracks;
+    };
+
+    void record( char phase, const char *name, const RDAI_Device *device, uint64_t ts, uint64_t dur, uint64_t id )
+    {
+        Ring *ring = local.ring ? local.ring : attach();
+        uint32_t track = device ? track_of( ring, device ) : 0;
+        uint64_t *w = &ring->words[(ring->head.load( std::memory_order_relaxed ) & mask) * EVENT_WORDS];
+        __atomic_store_n( &w[0], ts, __ATOMIC_RELAXED );
+        __atomic_store_n( &w[1], dur, __ATOMIC_RELAXED );
+        __atomic_store_n( &w[2], (uint64_t) (uintptr_t) name, __ATOMIC_RELAXED );
+        __atomic_store_n( &w[3], id, __ATOMIC_RELAXED );
+        __atomic_store_n( &w[4], ((uint64_t) track << 8) | (uint8_t) phase, __ATOMIC_RELAXED );
+        ring->head.store( ring->head.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+    }
+
+    uint32_t track_of( Ring *ring, const RDAI_Device *device )
+    {
+        for( auto &t : ring->tracks ) {
+            if( t.first == device ) return t.second;
+        }
+        return add_track( ring, device );
+    }
+
+    // detaches the ring of a thread when the thread exits
+    struct LocalRing
+    {
+        Tracer *owner = NULL;
+        Ring *ring = NULL;
+        ~LocalRing() { if( ring ) owner->detach( ring ); }
+    };
+
+    Ring *attach();
+    void detach( Ring *ring );
+    uint32_t add_track( Ring *ring, const RDAI_Device *device );
+
+    static thread_local LocalRing local;
+
+    bool enabled = false;
+    std::string path;
+    uint64_t mask = 0;
+    TickClock clock;
+
+    std::mutex lock;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::vector<Ring *> free_rings;
+    std::vector<const RDAI_Device *> devices;
+    std::vector<std::string> device_names;
+};
+
+#define RDAI_TRACE_SCOPE( tracer, name, device )    Tracer::Scope rdai_trace_scope_( (tracer), (name), (device) )
+
+#endif // RDAI_TRACER_H
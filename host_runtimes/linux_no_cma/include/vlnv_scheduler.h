@@ -0,0 +1,178 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_VLNV_SCHEDULER_H
+#define RDAI_VLNV_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "rdai_api.h"
+#include "platform_registry.h"
+#include "completion_table.h"
+#include "device_executor.h"
+#include "run_profiler.h"
+#include "tracer.h"
+
+/**
+ * VLNV Scheduler
+ *
+ * Runs submitted by VLNV rather than by device (see RDAI_submit_by_vlnv).
+ * Every VLNV submitted so far has a group holding one worker per matching
+ * device of the registered platforms. Each worker owns a deque of runs and
+ * a thread that hands them one at a time to the DeviceExecutor thread of
+ * its device, which executes them with the platform's device_run in order
+ * with the other work of the device.
+ *
+ * Workers time every run and keep an exponentially weighted moving average
+ * of the latency of their device. A submission is queued on the worker
+ * chosen by the dispatch policy from these estimates; the default policy
+ * picks the lowest expected completion time, (queue depth + 1) * latency.
+ * A worker whose deque is empty steals from the back of the fullest deque
+ * of its group, so idle devices pull work from busy ones, unless its own
+ * latency estimate says the run would finish sooner where it is queued.
+ *
+ * Groups are rebuilt on their next submission after platforms_changed(),
+ * which starts the workers of new devices. remove_platform() retires the
+ * workers of a platform and moves their queued runs to the remaining ones.
+ */
+class VlnvScheduler
+{
+public:
+
+    VlnvScheduler( PlatformRegistry &registry, DeviceExecutor &executor, CompletionTable &completions,
+                   Tracer &tracer, RunProfiler &profiler )
+        : registry( registry ), executor( executor ), completions( completions ), tracer( tracer ),
+          profiler( profiler ) {}
+    ~VlnvScheduler();
+    VlnvScheduler( const VlnvScheduler& ) = delete;
+    VlnvScheduler& operator=( const VlnvScheduler& ) = delete;
+
+    /**
+     * Queue a run on one of the devices with a VLNV
+     *
+     * @param vlnv The VLNV of the device to run
+     * @param mem_object_list A NULL-terminated list of memory object pointers
+     * @param callback The function to call on completion (or NULL)
+     * @param callback_ctx The context passed to the callback
+     * @return status (with async handle)
+     */
+    RDAI_Status submit( const RDAI_VLNV *vlnv, RDAI_MemObject **mem_object_list,
+                        RDAI_CompletionCallback callback = NULL, void *callback_ctx = NULL );
+
+    /**
+     * Set the policy choosing the device of each submission
+     *
+     * @param policy The policy (NULL restores the default policy)
+     * @param ctx The context passed to the policy
+     */
+    void set_policy( RDAI_DispatchPolicy policy, void *ctx );
+
+    /**
+     * Get the estimate of a device
+     *
+     * @return false if no run was submitted for the device yet
+     */
+    bool get_estimate( const RDAI_Device *device, RDAI_DeviceEstimate *estimate );
+
+    /**
+     * Note that a platform was registered
+     */
+    void platforms_changed() { generation.fetch_add( 1, std::memory_order_release ); }
+
+    /**
+     * Stop running on the devices of a platform about to be unregistered
+     *
+     * Runs queued on them are moved to other devices with the same VLNV, or
+     * fail with RDAI_REASON_NO_DEVICE if there are none
+     */
+    void remove_platform( const RDAI_Platform *platform );
+
+private:
+
+    struct Group;
+
+    struct Task
+    {
+        RDAI_MemObject **mem_object_list;
+        uint32_t id;
+        uint64_t submitted;     // in TickClock ticks, when tracing
+    };
+
+    struct Worker
+    {
+        RDAI_Device *device;
+        Group *group;
+        std::thread thread;
+        std::mutex lock;
+        std::deque<Task> tasks;
+        std::atomic<size_t> load { 0 };     // queued and running runs
+        std::atomic<uint64_t> latency_ns { 0 };
+        std::atomic<uint64_t> runs { 0 };
+        bool retired = false;               // under the group lock
+        std::condition_variable ran;        // the run handed to the device is done
+        bool running = false;               // under lock
+    };
+
+    struct Group
+    {
+        RDAI_VLNV vlnv;
+        std::mutex lock;
+        std::condition_variable cv;
+        std::vector<Worker *> workers;      // workers of the current devices
+        std::vector<std::unique_ptr<Worker>> owned;
+        std::atomic<size_t> pending { 0 };  // runs queued in the deques
+        std::vector<RDAI_DeviceEstimate> estimates;
+        uint64_t generation = 0;
+        size_t next = 0;
+    };
+
+    Group *get_group( const RDAI_VLNV *vlnv );
+    void rebuild( Group *group, const RDAI_Platform *removed = NULL );
+    Worker *pick( Group *group );
+    void fill_estimate( const Worker *worker, RDAI_DeviceEstimate *estimate ) const;
+    void push( Worker *worker, const Task &task );
+    bool pop( Worker *worker, Task &task );
+    bool steal( Worker *thief, Task &task, uint64_t *retry_ns );
+    void worker_loop( Worker *worker );
+    RDAI_Status run( Worker *worker, const Task &task );
+
+    PlatformRegistry &registry;
+    DeviceExecutor &executor;
+    CompletionTable &completions;
+    Tracer &tracer;
+    RunProfiler &profiler;
+    std::mutex policy_lock;
+    RDAI_DispatchPolicy policy = NULL;
+    void *policy_ctx = NULL;
+    std::atomic<uint64_t> generation { 1 };
+    std::atomic<bool> stopping { false };
+    std::mutex groups_lock;
+    std::unordered_map<std::string, std::unique_ptr<Group>> groups;
+};
+
+#endif // RDAI_VLNV_SCHEDULER_H
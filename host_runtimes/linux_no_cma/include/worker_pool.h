@@ -0,0 +1,117 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_WORKER_POOL_H
+#define RDAI_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Worker Pool
+ *
+ * A fixed set of host runtime worker threads. Threads are started on first
+ * use, so programs that never need them do not pay for them.
+ */
+class WorkerPool
+{
+public:
+
+    /**
+     * @param num_threads The number of worker threads (0 selects the number of
+     *                    hardware threads)
+     */
+    explicit WorkerPool( size_t num_threads = 0 );
+    ~WorkerPool();
+    WorkerPool( const WorkerPool& ) = delete;
+    WorkerPool& operator=( const WorkerPool& ) = delete;
+
+    size_t size() const { return num_threads; }
+
+    /**
+     * Queue a task for execution on a worker thread
+     */
+    void submit( std::function<void()> task );
+
+    /**
+     * Run fn(i) for every i in [0, n) and wait for all of them
+     *
+     * The calling thread takes part in the work, so parallel_for may be
+     * called from a worker thread.
+     */
+    template <typename Callable>
+    void parallel_for( size_t n, Callable&& fn )
+    {
+        if( n == 0 ) return;
+        if( n == 1 || num_threads == 0 ) {
+            for( size_t i = 0; i < n; i++ ) fn( i );
+            return;
+        }
+
+        // helpers may start after the work is done: they only touch the
+        // shared job state then, never the callable
+        struct Job
+        {
+            std::atomic<size_t> next { 0 };
+            std::atomic<size_t> done { 0 };
+            std::mutex lock;
+            std::condition_variable cv;
+        };
+        auto job = std::make_shared<Job>();
+
+        auto work = [job, &fn, n]() {
+            size_t i, completed = 0;
+            while( (i = job->next.fetch_add( 1, std::memory_order_relaxed )) < n ) {
+                fn( i );
+                completed++;
+            }
+            if( completed && job->done.fetch_add( completed, std::memory_order_acq_rel ) + completed == n ) {
+                std::lock_guard<std::mutex> lock( job->lock );
+                job->cv.notify_all();
+            }
+        };
+
+        size_t helpers = (n - 1 < num_threads) ? n - 1 : num_threads;
+        for( size_t h = 0; h < helpers; h++ ) submit( work );
+        work();
+
+        std::unique_lock<std::mutex> lock( job->lock );
+        job->cv.wait( lock, [&]() { return job->done.load( std::memory_order_acquire ) == n; } );
+    }
+
+private:
+    void start();
+    void worker_loop();
+
+    size_t num_threads;
+    std::once_flag started;
+    std::mutex lock;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> threads;
+    bool stopping = false;
+};
+
+#endif // RDAI_WORKER_POOL_H
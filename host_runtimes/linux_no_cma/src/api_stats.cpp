@@ -0,0 +1,234 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "api_stats.h"
+#include "runtime_util.h"
+
+#define STATS_DUMP_INTERVAL_DEFAULT_MS  10000
+
+static const char *op_names[RDAI_NUM_STATS_OPS] = {
+    "mem_allocate", "mem_free", "mem_copy", "mem_copy_async", "device_run", "device_run_async", "sync",
+};
+
+// upper bounds of the exported Prometheus buckets, in ns
+static const uint64_t export_bounds[] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000,
+    1000000, 2500000, 5000000, 10000000, 25000000, 50000000, 100000000, 250000000,
+    500000000, 1000000000, 2500000000ull, 5000000000ull, 10000000000ull,
+};
+
+thread_local ApiStats::LocalShard ApiStats::local;
+
+static std::string label_value( const char *value, size_t max_len )
+{
+    std::string s;
+    for( size_t i = 0; i < max_len && value[i]; i++ ) {
+        if( value[i] == '"' || value[i] == '\\' ) s += '\\';
+        s += value[i];
+    }
+    return s;
+}
+
+ApiStats::ApiStats()
+{
+    const char *path = getenv( "RDAI_STATS_FILE" );
+    if( !path || !*path ) return;
+#ifdef RDAI_ENABLE_STATS
+    const char *value = getenv( "RDAI_STATS_INTERVAL_MS" );
+    uint64_t ms = (value && *value) ? strtoull( value, NULL, 0 ) : STATS_DUMP_INTERVAL_DEFAULT_MS;
+    dumper = std::thread( &ApiStats::dump_loop, this, std::string( path ),
+                          std::chrono::milliseconds( ms ? ms : 1 ) );
+#endif // RDAI_ENABLE_STATS
+}
+
+ApiStats::~ApiStats()
+{
+    if( dumper.joinable() ) {
+        {
+            std::lock_guard<std::mutex> guard( dump_lock );
+            stopping = true;
+        }
+        dump_cv.notify_all();
+        dumper.join();
+    }
+}
+
+void ApiStats::dump_loop( std::string path, std::chrono::milliseconds interval )
+{
+    std::unique_lock<std::mutex> guard( dump_lock );
+    while( !dump_cv.wait_for( guard, interval, [this]() { return stopping; } ) ) {
+        guard.unlock();
+        dump( path.c_str() );
+        guard.lock();
+    }
+    guard.unlock();
+    dump( path.c_str() );
+}
+
+ApiStats::Shard* ApiStats::attach()
+{
+    std::lock_guard<std::mutex> guard( lock );
+    Shard *shard;
+    if( !free_shards.empty() ) {
+        shard = free_shards.back();
+        free_shards.pop_back();
+    } else {
+        shards.emplace_back( new Shard() );
+        shard = shards.back().get();
+    }
+    local.owner = this;
+    local.shard = shard;
+    return shard;
+}
+
+void ApiStats::detach( Shard *shard )
+{
+    std::lock_guard<std::mutex> guard( lock );
+    free_shards.push_back( shard );
+}
+
+LatencyHistogram* ApiStats::add_device( Shard *shard, const RDAI_Device *device )
+{
+    std::lock_guard<std::mutex> guard( lock );
+    uint32_t index = 0;
+    while( index < devices.size() && devices[index] != device ) index++;
+    if( index == devices.size() && index < MAX_DEVICES ) {
+        // the label is kept: the device may be gone by the time it is dumped
+        char label[256];
+        const RDAI_VLNV &v = device->vlnv;
+        snprintf( label, sizeof( label ), "vlnv=\"%s:%s:%s:%u\",platform=\"%u\",device=\"%u\"",
+                  label_value( v.vendor.value, RDAI_STRING_ID_LENGTH ).c_str(),
+                  label_value( v.library.value, RDAI_STRING_ID_LENGTH ).c_str(),
+                  label_value( v.name.value, RDAI_STRING_ID_LENGTH ).c_str(), (unsigned) v.version,
+                  device->platform ? (unsigned) device->platform->id.value : 0u, (unsigned) device->id.value );
+        devices.push_back( device );
+        device_labels.push_back( label );
+    }
+    shard->indices.emplace_back( device, index );
+    if( index >= MAX_DEVICES ) return NULL;
+
+    DeviceHistograms *h = shard->devices[index].load( std::memory_order_relaxed );
+    if( !h ) {
+        h = new DeviceHistograms[1];
+        shard->devices[index].store( h, std::memory_order_release );
+    }
+    return *h;
+}
+
+void ApiStats::merge( RDAI_StatsOp op, long device_index, LatencyHistogram &merged )
+{
+    for( auto &shard : shards ) {
+        if( device_index < 0 ) {
+            merged.merge( shard->ops[op] );
+        } else if( DeviceHistograms *h = shard->devices[device_index].load( std::memory_order_acquire ) ) {
+            merged.merge( (*h)[op] );
+        }
+    }
+}
+
+void ApiStats::get( RDAI_StatsOp op, const RDAI_Device *device, RDAI_OpStats *stats )
+{
+    LatencyHistogram merged;
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        long device_index = -1;
+        if( device ) {
+            size_t i = 0;
+            while( i < devices.size() && devices[i] != device ) i++;
+            device_index = (long) i;
+        }
+        if( device_index < (long) devices.size() ) merge( op, device_index, merged );
+    }
+    double scale = clock.ns_per_tick();
+    stats->count   = merged.count();
+    stats->mean_ns = (uint64_t) (merged.mean_ns() * scale);
+    stats->p50_ns  = (uint64_t) (merged.percentile( 0.50 ) * scale);
+    stats->p90_ns  = (uint64_t) (merged.percentile( 0.90 ) * scale);
+    stats->p99_ns  = (uint64_t) (merged.percentile( 0.99 ) * scale);
+    stats->max_ns  = (uint64_t) (merged.max_ns() * scale);
+}
+
+void ApiStats::reset()
+{
+    std::lock_guard<std::mutex> guard( lock );
+    for( auto &shard : shards ) {
+        for( auto &h : shard->ops ) h.reset();
+        for( auto &d : shard->devices ) {
+            if( DeviceHistograms *h = d.load( std::memory_order_acquire ) ) {
+                for( auto &dh : *h ) dh.reset();
+            }
+        }
+    }
+}
+
+/**
+ * Append one histogram (recorded in ticks) in the Prometheus text format
+ */
+static void append_histogram( std::string &out, const char *labels, const LatencyHistogram &h, double ns_per_tick )
+{
+    char line[512];
+    unsigned b = 0;
+    uint64_t cumulative = 0;
+    for( uint64_t bound : export_bounds ) {
+        double bound_ticks = bound / ns_per_tick;
+        while( b < LatencyHistogram::NUM_BUCKETS &&
+               LatencyHistogram::bucket_low( b ) + LatencyHistogram::bucket_width( b ) <= bound_ticks ) {
+            cumulative += h.bucket_count( b++ );
+        }
+        snprintf( line, sizeof( line ), "rdai_op_latency_seconds_bucket{%s,le=\"%g\"} %llu\n",
+                  labels, bound / 1e9, (unsigned long long) cumulative );
+        out += line;
+    }
+    snprintf( line, sizeof( line ), "rdai_op_latency_seconds_bucket{%s,le=\"+Inf\"} %llu\n"
+                                    "rdai_op_latency_seconds_sum{%s} %.9f\n"
+                                    "rdai_op_latency_seconds_count{%s} %llu\n",
+              labels, (unsigned long long) h.count(), labels, h.sum_ns() * ns_per_tick / 1e9,
+              labels, (unsigned long long) h.count() );
+    out += line;
+}
+
+bool ApiStats::dump( const char *path )
+{
+    double scale = clock.ns_per_tick();
+    std::string out = "# HELP rdai_op_latency_seconds Latency of RDAI host API calls\n"
+                      "# TYPE rdai_op_latency_seconds histogram\n";
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        char labels[320];
+        for( int op = 0; op < RDAI_NUM_STATS_OPS; op++ ) {
+            LatencyHistogram merged;
+            merge( (RDAI_StatsOp) op, -1, merged );
+            if( !merged.count() ) continue;
+            snprintf( labels, sizeof( labels ), "op=\"%s\"", op_names[op] );
+            append_histogram( out, labels, merged, scale );
+            for( size_t d = 0; d < devices.size(); d++ ) {
+                LatencyHistogram per_device;
+                merge( (RDAI_StatsOp) op, (long) d, per_device );
+                if( !per_device.count() ) continue;
+                snprintf( labels, sizeof( labels ), "op=\"%s\",%s", op_names[op], device_labels[d].c_str() );
+                append_histogram( out, labels, per_device, scale );
+            }
+        }
+    }
+
+    return write_file_atomic( path, out );
+}
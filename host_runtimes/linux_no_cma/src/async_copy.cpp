@@ -0,0 +1,108 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "async_copy.h"
+#include "probes.h"
+
+#define ASYNC_COPY_MAX_THREADS  4
+
+AsyncCopyEngine::AsyncCopyEngine( CopyEngine &copy_engine, CompletionTable &completions, QueueWaitStats &wait_stats,
+                                  Tracer &tracer, size_t num_threads, size_t queue_depth )
+    : copy_engine( copy_engine ), completions( completions ), tracer( tracer ), num_threads( num_threads ),
+      pending( wait_stats ), queue_depth( queue_depth ? queue_depth : 1 )
+{
+    // copies are bound by memory bandwidth: a few threads saturate it, and
+    // large copies are split further by the copy engine
+    if( this->num_threads == 0 ) {
+        this->num_threads = std::thread::hardware_concurrency() / 2;
+        if( this->num_threads > ASYNC_COPY_MAX_THREADS ) this->num_threads = ASYNC_COPY_MAX_THREADS;
+        if( this->num_threads == 0 ) this->num_threads = 1;
+    }
+}
+
+AsyncCopyEngine::~AsyncCopyEngine()
+{
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        stopping = true;
+    }
+    not_empty.notify_all();
+    for( auto &t : threads ) t.join();
+}
+
+void AsyncCopyEngine::start()
+{
+    for( size_t i = 0; i < num_threads; i++ ) {
+        threads.emplace_back( &AsyncCopyEngine::copy_loop, this );
+    }
+}
+
+uint32_t AsyncCopyEngine::submit( void *dest, const void *src, size_t size,
+                                  RDAI_CompletionCallback callback, void *callback_ctx,
+                                  RDAI_Priority priority )
+{
+    std::call_once( started, &AsyncCopyEngine::start, this );
+    uint32_t id = completions.create( callback, callback_ctx );
+    if( id ) {
+        RDAI_PROBE_SUBMIT( id, NULL, size );
+        tracer.async_begin( "mem_copy_async", NULL, id );
+        enqueue( Request { dest, src, size, id, nullptr }, priority, true );
+    }
+    return id;
+}
+
+void AsyncCopyEngine::post( void *dest, const void *src, size_t size, std::function<void()> done )
+{
+    std::call_once( started, &AsyncCopyEngine::start, this );
+    enqueue( Request { dest, src, size, 0, std::move( done ) }, RDAI_PRIORITY_NORMAL, false );
+}
+
+void AsyncCopyEngine::enqueue( Request request, RDAI_Priority priority, bool block )
+{
+    {
+        std::unique_lock<std::mutex> guard( lock );
+        if( block ) not_full.wait( guard, [this]() { return pending.size() < queue_depth; } );
+        pending.push( std::move( request ), priority );
+    }
+    not_empty.notify_one();
+}
+
+void AsyncCopyEngine::copy_loop()
+{
+    RDAI_Status status = {};
+    status.status_code = RDAI_StatusCode::RDAI_STATUS_OK;
+
+    for( ;; ) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> guard( lock );
+            not_empty.wait( guard, [this]() { return stopping || !pending.empty(); } );
+            if( pending.empty() ) return;
+            request = pending.pop();
+        }
+        not_full.notify_one();
+        CompletionTable::Running executing( completions, request.id );
+        copy_engine.copy( request.dest, request.src, request.size );
+        if( request.id ) {
+            tracer.async_end( "mem_copy_async", NULL, request.id );
+            completions.complete( request.id, status );
+        } else {
+            request.done();
+        }
+    }
+}
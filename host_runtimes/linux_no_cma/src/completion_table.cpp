@@ -0,0 +1,336 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <chrono>
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "completion_table.h"
+#include "probes.h"
+
+static inline uint32_t make_state( uint32_t generation, uint32_t phase )
+{
+    return ((generation & COMPLETION_GENERATION_MASK) << 2) | phase;
+}
+
+// the per-thread operation of CompletionTable::Running
+static thread_local uint32_t running_id = 0;
+
+static void futex_wait( std::atomic<uint32_t> *word, uint32_t expected, const struct timespec *timeout = NULL )
+{
+    syscall( SYS_futex, (uint32_t *) word, FUTEX_WAIT_PRIVATE, expected, timeout, NULL, 0 );
+}
+
+static void futex_wake_all( std::atomic<uint32_t> *word )
+{
+    syscall( SYS_futex, (uint32_t *) word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0 );
+}
+
+CompletionTable::~CompletionTable()
+{
+    if( callback_thread.joinable() ) {
+        {
+            std::lock_guard<std::mutex> guard( callbacks_lock );
+            stopping = true;
+        }
+        callbacks_cv.notify_one();
+        callback_thread.join();
+    }
+    for( auto &chunk : chunks ) delete[] chunk.load( std::memory_order_relaxed );
+}
+
+uint64_t CompletionTable::profile_clock_ns()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+CompletionTable::Slot *CompletionTable::lookup( uint32_t index ) const
+{
+    Slot *chunk = chunks[index >> COMPLETION_CHUNK_BITS].load( std::memory_order_acquire );
+    return chunk ? &chunk[index & (COMPLETION_CHUNK_SIZE - 1)] : nullptr;
+}
+
+bool CompletionTable::grow()
+{
+    if( num_slots > COMPLETION_INDEX_MASK ) return false;
+
+    uint32_t first = num_slots;
+    uint32_t last  = (first | (COMPLETION_CHUNK_SIZE - 1)) + 1;   // end of the chunk of first
+    auto &chunk = chunks[first >> COMPLETION_CHUNK_BITS];
+    if( !chunk.load( std::memory_order_relaxed ) ) {
+        chunk.store( new Slot[COMPLETION_CHUNK_SIZE], std::memory_order_release );
+    }
+    for( uint32_t i = first; i < last; i++ ) {
+        lookup( i )->next_free = (i + 1 < last) ? i + 1 : 0;
+    }
+    free_head = first;
+    free_tail = last - 1;
+    num_slots = last;
+    return true;
+}
+
+uint32_t CompletionTable::create( RDAI_CompletionCallback callback, void *callback_ctx )
+{
+    if( callback ) std::call_once( callbacks_started, &CompletionTable::start_callbacks, this );
+
+    uint32_t index;
+    Slot *slot;
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        if( !free_head && !grow() ) return 0;
+        index = free_head;
+        slot  = lookup( index );
+        free_head = slot->next_free;
+        if( !free_head ) free_tail = 0;
+    }
+    uint32_t generation = slot->state.load( std::memory_order_relaxed ) >> 2;
+    slot->callback     = callback;
+    slot->callback_ctx = callback_ctx;
+    slot->state.store( make_state( generation, SLOT_PENDING ), std::memory_order_release );
+
+    // readers of the previous profile see the new state before the new times
+    std::atomic_thread_fence( std::memory_order_release );
+    slot->queued_ns.store( profile_clock_ns(), std::memory_order_relaxed );
+    slot->submitted_ns.store( 0, std::memory_order_relaxed );
+    slot->started_ns.store( 0, std::memory_order_relaxed );
+    slot->ended_ns.store( 0, std::memory_order_relaxed );
+    slot->completed_ns.store( 0, std::memory_order_relaxed );
+    return ((generation & COMPLETION_GENERATION_MASK) << COMPLETION_INDEX_BITS) | index;
+}
+
+CompletionTable::Slot *CompletionTable::pending_slot( uint32_t id ) const
+{
+    Slot *slot = lookup( id & COMPLETION_INDEX_MASK );
+    uint32_t pending = make_state( id >> COMPLETION_INDEX_BITS, SLOT_PENDING );
+    if( !slot || slot->state.load( std::memory_order_acquire ) != pending ) return nullptr;
+    return slot;
+}
+
+void CompletionTable::discard( uint32_t id )
+{
+    Slot *slot = pending_slot( id );
+    if( !slot ) return;
+    uint32_t generation = id >> COMPLETION_INDEX_BITS;
+    slot->state.store( make_state( generation, SLOT_CLAIMED ), std::memory_order_relaxed );
+    recycle( id & COMPLETION_INDEX_MASK, generation );
+}
+
+void CompletionTable::mark_submitted( uint32_t id )
+{
+    Slot *slot = pending_slot( id );
+    if( slot ) slot->submitted_ns.store( profile_clock_ns(), std::memory_order_relaxed );
+}
+
+CompletionTable::Running::Running( CompletionTable &table, uint32_t id, bool submit ) : previous( running_id )
+{
+    if( submit ) table.mark_submitted( id );
+    running_id = id;
+}
+
+CompletionTable::Running::~Running()
+{
+    running_id = previous;
+}
+
+bool CompletionTable::set_device_times( uint32_t id, uint64_t started_ns, uint64_t ended_ns )
+{
+    Slot *slot = pending_slot( id ? id : running_id );
+    if( !slot ) return false;
+    // started is the flag of device times: ended must be visible with it
+    slot->ended_ns.store( ended_ns, std::memory_order_relaxed );
+    slot->started_ns.store( started_ns, std::memory_order_release );
+    return true;
+}
+
+bool CompletionTable::get_profile( uint32_t id, RDAI_HandleProfile *profile ) const
+{
+    uint32_t generation = id >> COMPLETION_INDEX_BITS;
+    Slot *slot = lookup( id & COMPLETION_INDEX_MASK );
+    if( !slot || !id ) return false;
+
+    // the operation is pending, completed, being synchronized or synchronized
+    // with its slot not yet reused
+    auto current = [&]( uint32_t state ) {
+        return state == make_state( generation, SLOT_PENDING ) || state == make_state( generation, SLOT_DONE ) ||
+               state == make_state( generation, SLOT_CLAIMED ) || state == make_state( generation + 1, SLOT_FREE );
+    };
+    if( !current( slot->state.load( std::memory_order_acquire ) ) ) return false;
+    uint64_t started = slot->started_ns.load( std::memory_order_acquire );
+    profile->queued_ns    = slot->queued_ns.load( std::memory_order_relaxed );
+    profile->submitted_ns = slot->submitted_ns.load( std::memory_order_relaxed );
+    profile->ended_ns     = slot->ended_ns.load( std::memory_order_relaxed );
+    profile->completed_ns = slot->completed_ns.load( std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_acquire );
+    if( !current( slot->state.load( std::memory_order_relaxed ) ) ) return false;
+
+    // without device times, the device is taken to run from submission to completion
+    profile->flags = 0;
+    if( started ) {
+        profile->started_ns = started;
+        profile->flags |= RDAI_PROFILE_DEVICE_TIMES;
+    } else {
+        profile->started_ns = profile->submitted_ns;
+        profile->ended_ns   = profile->completed_ns;
+    }
+    return true;
+}
+
+bool CompletionTable::complete( uint32_t id, const RDAI_Status &status )
+{
+    Slot *slot = lookup( id & COMPLETION_INDEX_MASK );
+    uint32_t pending = make_state( id >> COMPLETION_INDEX_BITS, SLOT_PENDING );
+    if( !slot || slot->state.load( std::memory_order_acquire ) != pending ) return false;
+    RDAI_PROBE_COMPLETE( id, status );
+    slot->completed_ns.store( profile_clock_ns(), std::memory_order_relaxed );
+
+    // the slot may be recycled as soon as it is done: read the callback first
+    RDAI_CompletionCallback callback = slot->callback;
+    void *callback_ctx = slot->callback_ctx;
+
+    slot->status = status;
+    // seq_cst stores and loads pair with the waiters increments and futex checks
+    slot->state.store( make_state( id >> COMPLETION_INDEX_BITS, SLOT_DONE ) );
+    if( slot->waiters.load() ) futex_wake_all( &slot->state );
+    completion_seq.fetch_add( 1 );
+    if( any_waiters.load() ) futex_wake_all( &completion_seq );
+
+    if( callback ) {
+        {
+            std::lock_guard<std::mutex> guard( callbacks_lock );
+            callbacks.push_back( Callback { id, callback, callback_ctx, status } );
+        }
+        callbacks_cv.notify_one();
+    }
+    return true;
+}
+
+bool CompletionTable::try_claim( Slot *slot, uint32_t id, uint32_t state, RDAI_Status *status )
+{
+    // only one waiter of a handle gets its status, the others see it stale
+    uint32_t generation = id >> COMPLETION_INDEX_BITS;
+    if( !slot->state.compare_exchange_strong( state, make_state( generation, SLOT_CLAIMED ),
+                                              std::memory_order_acquire ) ) return false;
+    *status = slot->status;
+    recycle( id & COMPLETION_INDEX_MASK, generation );
+    return true;
+}
+
+bool CompletionTable::wait( uint32_t id, RDAI_Status *status )
+{
+    uint32_t generation = id >> COMPLETION_INDEX_BITS;
+    Slot *slot = lookup( id & COMPLETION_INDEX_MASK );
+    if( !slot ) return false;
+
+    for( ;; ) {
+        uint32_t state = slot->state.load( std::memory_order_acquire );
+        if( state == make_state( generation, SLOT_DONE ) ) {
+            if( try_claim( slot, id, state, status ) ) return true;
+            continue;
+        }
+        if( state != make_state( generation, SLOT_PENDING ) ) return false;
+
+        slot->waiters.fetch_add( 1 );
+        futex_wait( &slot->state, state );
+        slot->waiters.fetch_sub( 1 );
+    }
+}
+
+CompletionTable::WaitResult CompletionTable::wait_any( const uint32_t *ids, size_t count, int64_t timeout_us,
+                                                       size_t *index, RDAI_Status *status )
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds( timeout_us > 0 ? timeout_us : 0 );
+
+    for( ;; ) {
+        // read the sequence before scanning: a completion after the scan changes it
+        uint32_t seq = completion_seq.load();
+        bool pending = false;
+        for( size_t i = 0; i < count; i++ ) {
+            uint32_t generation = ids[i] >> COMPLETION_INDEX_BITS;
+            Slot *slot = lookup( ids[i] & COMPLETION_INDEX_MASK );
+            if( !slot ) continue;
+            uint32_t state = slot->state.load( std::memory_order_acquire );
+            if( state == make_state( generation, SLOT_DONE ) && try_claim( slot, ids[i], state, status ) ) {
+                *index = i;
+                return WAIT_COMPLETED;
+            }
+            pending = pending || state == make_state( generation, SLOT_PENDING );
+        }
+        if( !pending ) return WAIT_STALE;
+
+        struct timespec timeout, *timeout_ptr = NULL;
+        if( timeout_us >= 0 ) {
+            auto remaining = deadline - std::chrono::steady_clock::now();
+            if( remaining <= std::chrono::nanoseconds::zero() ) return WAIT_TIMEOUT;
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>( remaining ).count();
+            timeout.tv_sec  = ns / 1000000000;
+            timeout.tv_nsec = ns % 1000000000;
+            timeout_ptr = &timeout;
+        }
+        any_waiters.fetch_add( 1 );
+        futex_wait( &completion_seq, seq, timeout_ptr );
+        any_waiters.fetch_sub( 1 );
+    }
+}
+
+void CompletionTable::recycle( uint32_t index, uint32_t generation )
+{
+    Slot *slot = lookup( index );
+    slot->state.store( make_state( generation + 1, SLOT_FREE ), std::memory_order_release );
+
+    std::lock_guard<std::mutex> guard( lock );
+    slot->next_free = 0;
+    if( free_tail ) lookup( free_tail )->next_free = index;
+    else free_head = index;
+    free_tail = index;
+}
+
+void CompletionTable::start_callbacks()
+{
+    callback_thread = std::thread( &CompletionTable::callback_loop, this );
+}
+
+void CompletionTable::callback_loop()
+{
+    for( ;; ) {
+        Callback cb;
+        {
+            std::unique_lock<std::mutex> guard( callbacks_lock );
+            callbacks_cv.wait( guard, [this]() { return stopping || !callbacks.empty(); } );
+            if( callbacks.empty() ) return;
+            cb = callbacks.front();
+            callbacks.pop_front();
+        }
+
+        RDAI_AsyncHandle handle;
+        handle.id.value  = cb.id;
+        handle.platform  = NULL;
+        handle.user_data = NULL;
+        cb.fn( &handle, cb.status, cb.ctx );
+
+        // release the slot, unless the operation was synchronized meanwhile
+        Slot *slot = lookup( cb.id & COMPLETION_INDEX_MASK );
+        uint32_t done = make_state( cb.id >> COMPLETION_INDEX_BITS, SLOT_DONE );
+        RDAI_Status unused;
+        if( slot->state.load( std::memory_order_acquire ) == done ) try_claim( slot, cb.id, done, &unused );
+    }
+}
@@ -0,0 +1,345 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "copy_engine.h"
+
+#define COPY_SMALL_SIZE             (64u << 10)     // never calibrate for copies below this
+#define COPY_CHUNK_MIN_SIZE         (1u << 20)      // smallest chunk of a parallel copy
+#define COPY_CHUNK_ALIGNMENT        4096
+#define COPY_CALIBRATION_MAX_SIZE   (32u << 20)
+#define COPY_CALIBRATION_REPS       2
+
+// =================== Non-temporal copy kernels ===================
+//
+// Each kernel copies the unaligned head with memcpy, streams the aligned
+// body and copies the tail with memcpy
+
+typedef void (*StreamCopyFn)( uint8_t *dest, const uint8_t *src, size_t size );
+
+static inline size_t align_head( const uint8_t *dest, size_t alignment, size_t size )
+{
+    size_t head = (alignment - ((uintptr_t) dest & (alignment - 1))) & (alignment - 1);
+    return head < size ? head : size;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("avx512f")))
+static void stream_copy_avx512( uint8_t *dest, const uint8_t *src, size_t size )
+{
+    size_t head = align_head( dest, 64, size );
+    memcpy( dest, src, head );
+    dest += head; src += head; size -= head;
+    size_t body = size & ~(size_t) 255;
+    for( size_t i = 0; i < body; i += 256 ) {
+        __m512i a = _mm512_loadu_si512( (const void *)(src + i) );
+        __m512i b = _mm512_loadu_si512( (const void *)(src + i + 64) );
+        __m512i c = _mm512_loadu_si512( (const void *)(src + i + 128) );
+        __m512i d = _mm512_loadu_si512( (const void *)(src + i + 192) );
+        _mm512_stream_si512( (__m512i *)(dest + i), a );
+        _mm512_stream_si512( (__m512i *)(dest + i + 64), b );
+        _mm512_stream_si512( (__m512i *)(dest + i + 128), c );
+        _mm512_stream_si512( (__m512i *)(dest + i + 192), d );
+    }
+    _mm_sfence();
+    memcpy( dest + body, src + body, size - body );
+}
+
+__attribute__((target("avx2")))
+static void stream_copy_avx2( uint8_t *dest, const uint8_t *src, size_t size )
+{
+    size_t head = align_head( dest, 32, size );
+    memcpy( dest, src, head );
+    dest += head; src += head; size -= head;
+    size_t body = size & ~(size_t) 127;
+    for( size_t i = 0; i < body; i += 128 ) {
+        __m256i a = _mm256_loadu_si256( (const __m256i *)(src + i) );
+        __m256i b = _mm256_loadu_si256( (const __m256i *)(src + i + 32) );
+        __m256i c = _mm256_loadu_si256( (const __m256i *)(src + i + 64) );
+        __m256i d = _mm256_loadu_si256( (const __m256i *)(src + i + 96) );
+        _mm256_stream_si256( (__m256i *)(dest + i), a );
+        _mm256_stream_si256( (__m256i *)(dest + i + 32), b );
+        _mm256_stream_si256( (__m256i *)(dest + i + 64), c );
+        _mm256_stream_si256( (__m256i *)(dest + i + 96), d );
+    }
+    _mm_sfence();
+    memcpy( dest + body, src + body, size - body );
+}
+
+__attribute__((target("sse2")))
+static void stream_copy_sse2( uint8_t *dest, const uint8_t *src, size_t size )
+{
+    size_t head = align_head( dest, 16, size );
+    memcpy( dest, src, head );
+    dest += head; src += head; size -= head;
+    size_t body = size & ~(size_t) 63;
+    for( size_t i = 0; i < body; i += 64 ) {
+        __m128i a = _mm_loadu_si128( (const __m128i *)(src + i) );
+        __m128i b = _mm_loadu_si128( (const __m128i *)(src + i + 16) );
+        __m128i c = _mm_loadu_si128( (const __m128i *)(src + i + 32) );
+        __m128i d = _mm_loadu_si128( (const __m128i *)(src + i + 48) );
+        _mm_stream_si128( (__m128i *)(dest + i), a );
+        _mm_stream_si128( (__m128i *)(dest + i + 16), b );
+        _mm_stream_si128( (__m128i *)(dest + i + 32), c );
+        _mm_stream_si128( (__m128i *)(dest + i + 48), d );
+    }
+    _mm_sfence();
+    memcpy( dest + body, src + body, size - body );
+}
+
+static StreamCopyFn select_stream_copy( const char **isa )
+{
+    __builtin_cpu_init();
+    if( __builtin_cpu_supports( "avx512f" ) ) {
+        *isa = "avx512";
+        return stream_copy_avx512;
+    }
+    if( __builtin_cpu_supports( "avx2" ) ) {
+        *isa = "avx2";
+        return stream_copy_avx2;
+    }
+    *isa = "sse2";
+    return stream_copy_sse2;
+}
+
+#elif defined(__aarch64__)
+
+static void stream_copy_neon( uint8_t *dest, const uint8_t *src, size_t size )
+{
+    size_t head = align_head( dest, 16, size );
+    memcpy( dest, src, head );
+    dest += head; src += head; size -= head;
+    size_t body = size & ~(size_t) 63;
+    for( size_t i = 0; i < body; i += 64 ) {
+        // STNP: store pair with a non-temporal hint
+        __asm__ volatile(
+            "ldp q0, q1, [%1]\n\t"
+            "ldp q2, q3, [%1, #32]\n\t"
+            "stnp q0, q1, [%0]\n\t"
+            "stnp q2, q3, [%0, #32]\n\t"
+            :
+            : "r"( dest + i ), "r"( src + i )
+            : "v0", "v1", "v2", "v3", "memory" );
+    }
+    __asm__ volatile( "dmb ishst" ::: "memory" );
+    memcpy( dest + body, src + body, size - body );
+}
+
+static StreamCopyFn select_stream_copy( const char **isa )
+{
+    *isa = "neon";
+    return stream_copy_neon;
+}
+
+#else
+
+static void stream_copy_generic( uint8_t *dest, const uint8_t *src, size_t size )
+{
+    memcpy( dest, src, size );
+}
+
+static StreamCopyFn select_stream_copy( const char **isa )
+{
+    *isa = "generic";
+    return stream_copy_generic;
+}
+
+#endif
+
+static const char *stream_isa = NULL;
+static const StreamCopyFn stream_copy = select_stream_copy( &stream_isa );
+
+// =================== CopyEngine ===================
+
+// memcpy and the stream kernels are undefined on overlapping ranges
+static inline bool overlaps( const void *dest, const void *src, size_t size )
+{
+    const uint8_t *d = (const uint8_t *) dest;
+    const uint8_t *s = (const uint8_t *) src;
+    return d < s + size && s < d + size;
+}
+
+static size_t env_size( const char *name, size_t fallback )
+{
+    const char *value = getenv( name );
+    if( value && *value ) return (size_t) strtoull( value, NULL, 0 );
+    return fallback;
+}
+
+CopyEngine::~CopyEngine()
+{
+    stopping.store( true, std::memory_order_relaxed );
+    if( calibration.joinable() ) calibration.join();
+}
+
+void CopyEngine::copy( void *dest, const void *src, size_t size )
+{
+    if( size < COPY_SMALL_SIZE ) {
+        if( overlaps( dest, src, size ) ) memmove( dest, src, size );
+        else memcpy( dest, src, size );
+        return;
+    }
+    std::call_once( started, &CopyEngine::start_calibration, this );
+    // memcpy until calibrated: both thresholds are unreachable until then
+    Strategy strategy = COPY_MEMCPY;
+    if( size >= parallel_threshold.load( std::memory_order_relaxed ) ) strategy = COPY_PARALLEL;
+    else if( size >= stream_threshold.load( std::memory_order_relaxed ) ) strategy = COPY_STREAM;
+    copy( dest, src, size, strategy );
+}
+
+void CopyEngine::copy( void *dest, const void *src, size_t size, Strategy strategy )
+{
+    uint8_t *d = (uint8_t *) dest;
+    const uint8_t *s = (const uint8_t *) src;
+
+    if( overlaps( d, s, size ) ) {
+        memmove( d, s, size );
+        return;
+    }
+
+    switch( strategy ) {
+    case COPY_MEMCPY:
+        memcpy( d, s, size );
+        break;
+    case COPY_STREAM:
+        stream_copy( d, s, size );
+        break;
+    case COPY_PARALLEL: {
+        size_t chunks = workers.size() + 1;
+        if( chunks > size / COPY_CHUNK_MIN_SIZE ) chunks = size / COPY_CHUNK_MIN_SIZE;
+        if( chunks < 2 ) {
+            stream_copy( d, s, size );
+            break;
+        }
+        size_t chunk = (size / chunks + COPY_CHUNK_ALIGNMENT - 1) & ~(size_t)(COPY_CHUNK_ALIGNMENT - 1);
+        workers.parallel_for( chunks, [=]( size_t i ) {
+                    size_t offset = i * chunk;
+                    if( offset >= size ) return;
+                    size_t n = (size - offset < chunk) ? size - offset : chunk;
+                    stream_copy( d + offset, s + offset, n );
+                });
+        break;
+    }
+    }
+}
+
+CopyEngine::Config CopyEngine::config()
+{
+    std::call_once( started, &CopyEngine::start_calibration, this );
+    {
+        std::unique_lock<std::mutex> guard( calibrated_lock );
+        calibrated_cond.wait( guard, [this]() { return calibrated; } );
+    }
+    Config c;
+    c.stream_threshold   = stream_threshold.load( std::memory_order_relaxed );
+    c.parallel_threshold = parallel_threshold.load( std::memory_order_relaxed );
+    c.num_threads        = workers.size();
+    c.isa                = stream_isa;
+    return c;
+}
+
+void CopyEngine::start_calibration()
+{
+    // forced thresholds apply at once; the calibration sets the others
+    const size_t never = (size_t) -1;
+    bool stream_forced   = getenv( "RDAI_COPY_STREAM_THRESHOLD" ) != NULL;
+    bool parallel_forced = getenv( "RDAI_COPY_PARALLEL_THRESHOLD" ) != NULL;
+    if( stream_forced ) stream_threshold = env_size( "RDAI_COPY_STREAM_THRESHOLD", never );
+    if( parallel_forced ) parallel_threshold = env_size( "RDAI_COPY_PARALLEL_THRESHOLD", never );
+    calibration = std::thread( &CopyEngine::calibrate, this );
+}
+
+void CopyEngine::calibrate()
+{
+    // defaults when calibration is disabled or cannot run
+    const size_t never = (size_t) -1;
+    bool stream_forced   = getenv( "RDAI_COPY_STREAM_THRESHOLD" ) != NULL;
+    bool parallel_forced = getenv( "RDAI_COPY_PARALLEL_THRESHOLD" ) != NULL;
+    size_t stream_from   = 8u << 20;
+    size_t parallel_from = workers.size() > 1 ? (16u << 20) : never;
+    if( !(stream_forced && parallel_forced) && env_size( "RDAI_COPY_CALIBRATE", 1 ) != 0 ) {
+        measure( &stream_from, &parallel_from );
+    }
+
+    if( !stream_forced ) stream_threshold = stream_from;
+    if( !parallel_forced ) parallel_threshold = parallel_from;
+    std::lock_guard<std::mutex> guard( calibrated_lock );
+    calibrated = true;
+    calibrated_cond.notify_all();
+}
+
+void CopyEngine::measure( size_t *stream_from, size_t *parallel_from )
+{
+    const size_t never = (size_t) -1;
+
+    uint8_t *src  = (uint8_t *) aligned_alloc( 4096, COPY_CALIBRATION_MAX_SIZE );
+    uint8_t *dest = (uint8_t *) aligned_alloc( 4096, COPY_CALIBRATION_MAX_SIZE );
+    if( !src || !dest ) {
+        free( src );
+        free( dest );
+        return;
+    }
+    memset( src, 1, COPY_CALIBRATION_MAX_SIZE );
+    memset( dest, 0, COPY_CALIBRATION_MAX_SIZE );
+
+    auto time_copy = [&]( size_t size, Strategy strategy ) {
+        double best = 0;
+        for( int r = 0; r < COPY_CALIBRATION_REPS && !stopping.load( std::memory_order_relaxed ); r++ ) {
+            auto start = std::chrono::steady_clock::now();
+            copy( dest, src, size, strategy );
+            double t = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+            if( r == 0 || t < best ) best = t;
+        }
+        return best;
+    };
+
+    // a threshold is the smallest size from which a strategy keeps winning
+    const size_t sizes[] = { 1u << 20, 4u << 20, 16u << 20, COPY_CALIBRATION_MAX_SIZE };
+    const size_t num_sizes = sizeof( sizes ) / sizeof( sizes[0] );
+    double single[num_sizes];
+    size_t stream_start = never, parallel_start = never;
+    bool stream_wins = true;
+    for( size_t i = num_sizes; i-- > 0; ) {
+        double t_memcpy = time_copy( sizes[i], COPY_MEMCPY );
+        double t_stream = time_copy( sizes[i], COPY_STREAM );
+        single[i] = t_memcpy < t_stream ? t_memcpy : t_stream;
+        stream_wins = stream_wins && t_stream < t_memcpy;
+        if( stream_wins ) stream_start = sizes[i];
+    }
+    bool parallel_wins = workers.size() > 1;
+    for( size_t i = num_sizes; parallel_wins && i-- > 0; ) {
+        parallel_wins = time_copy( sizes[i], COPY_PARALLEL ) < single[i];
+        if( parallel_wins ) parallel_start = sizes[i];
+    }
+    free( src );
+    free( dest );
+
+    // an interrupted calibration keeps the defaults
+    if( stopping.load( std::memory_order_relaxed ) ) return;
+    *stream_from   = stream_start;
+    *parallel_from = parallel_start;
+}
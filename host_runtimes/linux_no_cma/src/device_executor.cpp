@@ -0,0 +1,297 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "device_executor.h"
+#include "runtime_util.h"
+#include "probes.h"
+
+#define SUBMIT_RING_SIZE    4096
+
+thread_local DeviceExecutor::Lane *DeviceExecutor::current_lane = NULL;
+
+static void futex_wait( std::atomic<uint32_t> *word, uint32_t expected )
+{
+    syscall( SYS_futex, (uint32_t *) word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0 );
+}
+
+static void futex_wake_all( std::atomic<uint32_t> *word )
+{
+    syscall( SYS_futex, (uint32_t *) word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0 );
+}
+
+DeviceExecutor::DeviceExecutor( CompletionTable &completions, QueueWaitStats &wait_stats, Tracer &tracer )
+    : completions( completions ), wait_stats( wait_stats ), tracer( tracer ), ring_size( SUBMIT_RING_SIZE )
+{
+    const char *value = getenv( "RDAI_SUBMIT_RING_SIZE" );
+    if( value && *value && strtoull( value, NULL, 0 ) > 0 ) ring_size = (size_t) strtoull( value, NULL, 0 );
+    value = getenv( "RDAI_SUBMIT_BACKPRESSURE" );
+    if( value && strcmp( value, "busy" ) == 0 ) backpressure = RDAI_BACKPRESSURE_BUSY;
+}
+
+DeviceExecutor::~DeviceExecutor()
+{
+    for( auto &entry : lanes ) {
+        Lane *lane = entry.second.get();
+        lane->stopping.store( true );
+        lane->wake_seq.fetch_add( 1 );
+        futex_wake_all( &lane->wake_seq );
+        lane->thread.join();
+        if( lane->finisher.joinable() ) {
+            {
+                std::lock_guard<std::mutex> guard( lane->started_lock );
+                lane->finished = true;
+            }
+            lane->started_cond.notify_all();
+            lane->finisher.join();
+        }
+    }
+}
+
+DeviceExecutor::Lane *DeviceExecutor::get_lane( RDAI_Device *device )
+{
+    // lanes are never removed: a lane found in the cache stays valid
+    for( size_t i = 0; i < LANE_CACHE_SIZE; i++ ) {
+        RDAI_Device *key = lane_cache[i].device.load( std::memory_order_acquire );
+        if( key == device ) return lane_cache[i].lane;
+        if( !key ) break;
+    }
+
+    std::lock_guard<std::mutex> guard( lanes_lock );
+    auto &lane = lanes[device];
+    if( !lane ) {
+        lane.reset( new Lane( wait_stats, ring_size ) );
+        lane->thread = std::thread( &DeviceExecutor::lane_loop, this, lane.get() );
+        if( num_cached < LANE_CACHE_SIZE ) {
+            lane_cache[num_cached].lane = lane.get();
+            lane_cache[num_cached].device.store( device, std::memory_order_release );
+            num_cached++;
+        }
+    }
+    return lane.get();
+}
+
+RDAI_Status DeviceExecutor::submit( RDAI_Device *device, const char *name, size_t bytes, Work work,
+                                    RDAI_CompletionCallback callback, void *callback_ctx,
+                                    RDAI_Priority priority )
+{
+    uint32_t id = completions.create( callback, callback_ctx );
+    if( !id ) return ::make_status_error( RDAI_ErrorReason::RDAI_REASON_HANDLE_TABLE_FULL );
+    // before the push, which the completion may follow at once
+    RDAI_PROBE_SUBMIT( id, device, bytes );
+
+    Lane *lane = get_lane( device );
+    uint64_t submitted = tracer.active() ? TickClock::now() : 0;
+    Submission submission = { { [this, id, device, name, work = std::move( work )]() {
+                                  CompletionTable::Running executing( completions, id );
+                                  RDAI_Status status = work();
+                                  tracer.async_end( name, device, id );
+                                  completions.complete( id, status );
+                              }, false }, priority, clock::now() };
+    bool block = backpressure.load( std::memory_order_relaxed ) == RDAI_BACKPRESSURE_BLOCK;
+    if( !enqueue( lane, std::move( submission ), block ) ) {
+        RDAI_Status busy = ::make_status_error( RDAI_ErrorReason::RDAI_REASON_BUSY );
+        RDAI_PROBE_COMPLETE( id, busy );
+        completions.discard( id );
+        return busy;
+    }
+    // the span begins before the work may have run: recorded with the time of the push
+    tracer.async_begin( name, device, id, submitted );
+    return ::make_status_ok_async( id );
+}
+
+RDAI_Status DeviceExecutor::submit_started( RDAI_Device *device, const char *name, size_t bytes, Work start, Finish finish,
+                                            RDAI_CompletionCallback callback, void *callback_ctx,
+                                            RDAI_Priority priority )
+{
+    uint32_t id = completions.create( callback, callback_ctx );
+    if( !id ) return ::make_status_error( RDAI_ErrorReason::RDAI_REASON_HANDLE_TABLE_FULL );
+    // before the push, which the completion may follow at once
+    RDAI_PROBE_SUBMIT( id, device, bytes );
+
+    Lane *lane = get_lane( device );
+    uint64_t submitted = tracer.active() ? TickClock::now() : 0;
+    Submission submission = { { [this, lane, id, device, name, start = std::move( start ),
+                                 finish = std::move( finish )]() mutable {
+                                  RDAI_Status status;
+                                  {
+                                      CompletionTable::Running executing( completions, id );
+                                      status = start();
+                                  }
+                                  if( status.status_code != RDAI_StatusCode::RDAI_STATUS_OK ) {
+                                      tracer.async_end( name, device, id );
+                                      completions.complete( id, status );
+                                      return;
+                                  }
+                                  if( !lane->finisher.joinable() ) {
+                                      lane->finisher = std::thread( &DeviceExecutor::finish_loop, this, lane );
+                                  }
+                                  std::lock_guard<std::mutex> guard( lane->started_lock );
+                                  lane->started.push_back( Started { id, name, device, status.async_handle,
+                                                                     std::move( finish ) } );
+                                  lane->in_flight.fetch_add( 1 );
+                                  lane->started_cond.notify_all();
+                              }, true }, priority, clock::now() };
+    bool block = backpressure.load( std::memory_order_relaxed ) == RDAI_BACKPRESSURE_BLOCK;
+    if( !enqueue( lane, std::move( submission ), block ) ) {
+        RDAI_Status busy = ::make_status_error( RDAI_ErrorReason::RDAI_REASON_BUSY );
+        RDAI_PROBE_COMPLETE( id, busy );
+        completions.discard( id );
+        return busy;
+    }
+    tracer.async_begin( name, device, id, submitted );
+    return ::make_status_ok_async( id );
+}
+
+void DeviceExecutor::post( RDAI_Device *device, std::function<void()> task, RDAI_Priority priority )
+{
+    Lane *lane = get_lane( device );
+    Submission submission = { { std::move( task ), false }, priority, clock::now() };
+    if( enqueue( lane, std::move( submission ), false ) ) return;
+    {
+        std::lock_guard<std::mutex> guard( lane->overflow_lock );
+        lane->overflow.push_back( std::move( submission ) );
+        lane->overflowed.store( true );
+    }
+    wake( lane );
+}
+
+bool DeviceExecutor::enqueue( Lane *lane, Submission &&submission, bool block )
+{
+    // from the device thread itself (e.g. a queue posting its next command
+    // on completion): waiting for room would never end
+    if( current_lane == lane ) {
+        lane->tasks.push( std::move( submission.task ), submission.priority, submission.enqueued );
+        return true;
+    }
+
+    while( !lane->ring.try_push( std::move( submission ) ) ) {
+        if( !block ) return false;
+        uint32_t seq = lane->room_seq.load();
+        lane->room_waiters.fetch_add( 1 );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        bool pushed = lane->ring.try_push( std::move( submission ) );
+        if( !pushed ) futex_wait( &lane->room_seq, seq );
+        lane->room_waiters.fetch_sub( 1 );
+        if( pushed ) break;
+    }
+    wake( lane );
+    return true;
+}
+
+void DeviceExecutor::wake( Lane *lane )
+{
+    // pairs with the fence of the device thread between flagging itself
+    // sleeping and checking the ring a last time
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if( lane->sleeping.load( std::memory_order_relaxed ) ) {
+        lane->wake_seq.fetch_add( 1 );
+        futex_wake_all( &lane->wake_seq );
+    }
+}
+
+void DeviceExecutor::lane_loop( Lane *lane )
+{
+    current_lane = lane;
+    size_t capacity = lane->ring.capacity();
+    for( ;; ) {
+        // take what was submitted so far, so that priorities apply across
+        // it, but no more than a ring's worth: the ring then stays full and
+        // backpressure applies to the submitters. Taking again only once
+        // half of it was dispatched frees room in batches, rather than one
+        // entry (and a wake-up of all the waiting submitters) per dispatch
+        size_t queued = lane->tasks.size();
+        size_t n = queued <= capacity / 2 ? lane->ring.drain( [lane]( Submission &&s ) {
+                    lane->tasks.push( std::move( s.task ), s.priority, s.enqueued );
+                }, capacity - queued ) : 0;
+        if( n ) {
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+            if( lane->room_waiters.load( std::memory_order_relaxed ) ) {
+                lane->room_seq.fetch_add( 1 );
+                futex_wake_all( &lane->room_seq );
+            }
+        }
+        if( lane->overflowed.load() ) {
+            std::lock_guard<std::mutex> guard( lane->overflow_lock );
+            for( Submission &s : lane->overflow ) {
+                lane->tasks.push( std::move( s.task ), s.priority, s.enqueued );
+            }
+            lane->overflow.clear();
+            lane->overflowed.store( false );
+        }
+
+        if( !lane->tasks.empty() ) {
+            Task task = lane->tasks.pop();
+            if( !task.starts ) wait_started( lane );
+            task.run();
+            continue;
+        }
+        if( lane->stopping.load() ) {
+            if( lane->ring.ready() || lane->overflowed.load() ) continue;
+            return;
+        }
+
+        uint32_t seq = lane->wake_seq.load();
+        lane->sleeping.store( 1, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if( !lane->ring.ready() && !lane->overflowed.load() && !lane->stopping.load() ) {
+            futex_wait( &lane->wake_seq, seq );
+        }
+        lane->sleeping.store( 0, std::memory_order_relaxed );
+    }
+}
+
+void DeviceExecutor::finish_loop( Lane *lane )
+{
+    std::unique_lock<std::mutex> guard( lane->started_lock );
+    for( ;; ) {
+        lane->started_cond.wait( guard, [lane]() { return !lane->started.empty() || lane->finished; } );
+        if( lane->started.empty() ) return;
+        Started op = std::move( lane->started.front() );
+        lane->started.pop_front();
+        guard.unlock();
+
+        RDAI_Status status;
+        {
+            // the platform may report device times from its sync
+            CompletionTable::Running finishing( completions, op.id, false );
+            status = op.finish( &op.async_handle );
+        }
+        tracer.async_end( op.name, op.device, op.id );
+        completions.complete( op.id, status );
+
+        guard.lock();
+        lane->in_flight.fetch_sub( 1 );
+        lane->started_cond.notify_all();
+    }
+}
+
+void DeviceExecutor::wait_started( Lane *lane )
+{
+    // only the device thread starts operations: none can start meanwhile
+    if( !lane->in_flight.load() ) return;
+    std::unique_lock<std::mutex> guard( lane->started_lock );
+    lane->started_cond.wait( guard, [lane]() { return !lane->in_flight.load(); } );
+}
@@ -0,0 +1,144 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <thread>
+#include <vector>
+
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "epoch.h"
+
+static std::atomic<uint64_t> next_domain_serial { 1 };
+
+static bool register_membarrier()
+{
+    long cmds = syscall( __NR_membarrier, MEMBARRIER_CMD_QUERY, 0 );
+    if( cmds < 0 || !(cmds & MEMBARRIER_CMD_PRIVATE_EXPEDITED) ) return false;
+    return syscall( __NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0 ) == 0;
+}
+
+bool EpochDomain::asymmetric_fence = register_membarrier();
+
+// Records acquired by the current thread, keyed by domain serial so that a
+// new domain reusing the address of a destroyed one is never confused with
+// it. Records are owned by their domain and are never freed; a thread gives
+// its records back when it exits.
+namespace {
+
+struct LocalRecord
+{
+    uint64_t serial;
+    EpochDomain::Record *record;
+};
+
+struct LocalRecords
+{
+    std::vector<LocalRecord> list;
+
+    ~LocalRecords()
+    {
+        for( LocalRecord &lr : list ) {
+            lr.record->epoch.store( 0, std::memory_order_release );
+            lr.record->in_use.store( false, std::memory_order_release );
+        }
+    }
+};
+
+}
+
+static thread_local LocalRecords local_records;
+
+EpochDomain::EpochDomain()
+    : serial( next_domain_serial.fetch_add( 1, std::memory_order_relaxed ) )
+{
+}
+
+EpochDomain::Record* EpochDomain::local_record_slow()
+{
+    LocalRecords &lrs = local_records;
+    Record *rec = nullptr;
+    for( LocalRecord &lr : lrs.list ) {
+        if( lr.serial == serial ) {
+            rec = lr.record;
+            break;
+        }
+    }
+    if( !rec ) {
+        rec = acquire_record();
+        lrs.list.push_back( LocalRecord{ serial, rec } );
+    }
+    cached_serial = serial;
+    cached_record = rec;
+    return rec;
+}
+
+EpochDomain::Record* EpochDomain::acquire_record()
+{
+    // reuse a record released by an exited thread
+    for( Record *rec = records.load( std::memory_order_acquire ); rec; rec = rec->next ) {
+        bool expected = false;
+        if( !rec->in_use.load( std::memory_order_relaxed ) &&
+            rec->in_use.compare_exchange_strong( expected, true, std::memory_order_acq_rel ) ) {
+            return rec;
+        }
+    }
+    Record *rec = new Record();
+    rec->in_use.store( true, std::memory_order_relaxed );
+    Record *head = records.load( std::memory_order_relaxed );
+    do {
+        rec->next = head;
+    } while( !records.compare_exchange_weak( head, rec, std::memory_order_release, std::memory_order_relaxed ) );
+    return rec;
+}
+
+void EpochDomain::writer_fence()
+{
+    if( asymmetric_fence ) {
+        // execute a full barrier on every running thread of the process
+        syscall( __NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0 );
+    } else {
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+    }
+}
+
+bool EpochDomain::is_quiescent( uint64_t epoch )
+{
+    writer_fence();
+    for( Record *rec = records.load( std::memory_order_acquire ); rec; rec = rec->next ) {
+        uint64_t e = rec->epoch.load( std::memory_order_acquire );
+        if( e != 0 && e < epoch ) return false;
+    }
+    return true;
+}
+
+void EpochDomain::synchronize()
+{
+    uint64_t epoch = advance();
+    writer_fence();
+    Record *self = local_record();
+    for( Record *rec = records.load( std::memory_order_acquire ); rec; rec = rec->next ) {
+        if( rec == self ) continue;
+        for( ;; ) {
+            uint64_t e = rec->epoch.load( std::memory_order_acquire );
+            if( e == 0 || e >= epoch ) break;
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,211 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "frame_report.h"
+#include "runtime_util.h"
+
+#define FRAME_DUMP_INTERVAL_DEFAULT_MS  10000
+
+static const char *stage_names[RDAI_NUM_FRAME_STAGES] = {
+    "input_copy", "queue_wait", "compute", "output_copy", "sync_wakeup", "total",
+};
+
+thread_local uint64_t FrameReport::current_frame = 0;
+
+FrameReport::FrameReport( CompletionTable &completions ) : completions( completions )
+{
+    const char *path = getenv( "RDAI_FRAME_REPORT_FILE" );
+    if( !path || !*path ) return;
+    const char *value = getenv( "RDAI_FRAME_REPORT_INTERVAL_MS" );
+    uint64_t ms = (value && *value) ? strtoull( value, NULL, 0 ) : FRAME_DUMP_INTERVAL_DEFAULT_MS;
+    dumper = std::thread( &FrameReport::dump_loop, this, std::string( path ),
+                          std::chrono::milliseconds( ms ? ms : 1 ) );
+}
+
+FrameReport::~FrameReport()
+{
+    if( dumper.joinable() ) {
+        {
+            std::lock_guard<std::mutex> guard( dump_lock );
+            stopping = true;
+        }
+        dump_cv.notify_all();
+        dumper.join();
+    }
+}
+
+void FrameReport::dump_loop( std::string path, std::chrono::milliseconds interval )
+{
+    std::unique_lock<std::mutex> guard( dump_lock );
+    while( !dump_cv.wait_for( guard, interval, [this]() { return stopping; } ) ) {
+        guard.unlock();
+        dump( path.c_str() );
+        guard.lock();
+    }
+    guard.unlock();
+    dump( path.c_str() );
+}
+
+bool FrameReport::begin( uint64_t frame_id )
+{
+    if( !frame_id ) return false;
+    Frame frame;
+    memset( &frame, 0, sizeof( frame ) );
+    frame.begin_ns = CompletionTable::profile_clock_ns();
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        if( !frames.emplace( frame_id, frame ).second ) return false;
+    }
+    current_frame = frame_id;
+    return true;
+}
+
+bool FrameReport::select( uint64_t frame_id )
+{
+    if( frame_id ) {
+        std::lock_guard<std::mutex> guard( lock );
+        if( !frames.count( frame_id ) ) return false;
+    }
+    current_frame = frame_id;
+    return true;
+}
+
+bool FrameReport::end( uint64_t frame_id )
+{
+    uint64_t end_ns = CompletionTable::profile_clock_ns();
+    Frame frame;
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        auto it = frames.find( frame_id );
+        if( it == frames.end() ) return false;
+        frame = it->second;
+        frames.erase( it );
+        // async calls of the frame synchronized from now on are not counted
+        for( auto p = pending.begin(); p != pending.end(); ) {
+            if( p->second.frame == frame_id ) p = pending.erase( p );
+            else ++p;
+        }
+        num_pending.store( pending.size(), std::memory_order_relaxed );
+    }
+    if( current_frame == frame_id ) current_frame = 0;
+
+    frame.stage_ns[RDAI_FRAME_TOTAL] = end_ns - frame.begin_ns;
+    frame.used |= 1u << RDAI_FRAME_TOTAL;
+    for( int s = 0; s < RDAI_NUM_FRAME_STAGES; s++ ) {
+        if( frame.used & (1u << s) ) stages[s].record( frame.stage_ns[s] );
+    }
+    return true;
+}
+
+RDAI_FrameStage FrameReport::stage_of( Frame &frame, Op op )
+{
+    if( op == OP_RUN ) {
+        frame.ran = true;
+        return RDAI_FRAME_COMPUTE;
+    }
+    return frame.ran ? RDAI_FRAME_OUTPUT_COPY : RDAI_FRAME_INPUT_COPY;
+}
+
+void FrameReport::add( Frame &frame, RDAI_FrameStage stage, uint64_t ns )
+{
+    frame.stage_ns[stage] += ns;
+    frame.used |= 1u << stage;
+}
+
+void FrameReport::record_call( uint64_t frame_id, Op op, uint64_t ns )
+{
+    std::lock_guard<std::mutex> guard( lock );
+    auto it = frames.find( frame_id );
+    if( it != frames.end() ) add( it->second, stage_of( it->second, op ), ns );
+}
+
+void FrameReport::record_submit( uint64_t frame_id, uint32_t id, Op op )
+{
+    std::lock_guard<std::mutex> guard( lock );
+    auto it = frames.find( frame_id );
+    if( it == frames.end() ) return;
+    pending[id] = Pending { frame_id, stage_of( it->second, op ) };
+    num_pending.store( pending.size(), std::memory_order_relaxed );
+}
+
+void FrameReport::synced( uint32_t id, uint64_t sync_start_ns )
+{
+    uint64_t now_ns = CompletionTable::profile_clock_ns();
+    RDAI_HandleProfile profile;
+    bool profiled = completions.get_profile( id, &profile );
+
+    std::lock_guard<std::mutex> guard( lock );
+    auto p = pending.find( id );
+    if( p == pending.end() ) return;
+    Pending entry = p->second;
+    pending.erase( p );
+    num_pending.store( pending.size(), std::memory_order_relaxed );
+    auto it = frames.find( entry.frame );
+    if( it == frames.end() || !profiled ) return;
+
+    // copies run on a host worker from submission; runs are timed on the device
+    Frame &frame = it->second;
+    uint64_t submitted_ns = profile.submitted_ns ? profile.submitted_ns : profile.queued_ns;
+    uint64_t woken_from = profile.completed_ns > sync_start_ns ? profile.completed_ns : sync_start_ns;
+    add( frame, RDAI_FRAME_QUEUE_WAIT, submitted_ns - profile.queued_ns );
+    if( entry.stage == RDAI_FRAME_COMPUTE ) add( frame, entry.stage, profile.ended_ns - profile.started_ns );
+    else add( frame, entry.stage, profile.completed_ns - submitted_ns );
+    add( frame, RDAI_FRAME_SYNC_WAKEUP, now_ns > woken_from ? now_ns - woken_from : 0 );
+}
+
+void FrameReport::get( RDAI_FrameStage stage, RDAI_OpStats *stats ) const
+{
+    const LatencyHistogram &h = stages[stage];
+    stats->count   = h.count();
+    stats->mean_ns = h.mean_ns();
+    stats->p50_ns  = h.percentile( 0.50 );
+    stats->p90_ns  = h.percentile( 0.90 );
+    stats->p99_ns  = h.percentile( 0.99 );
+    stats->max_ns  = h.max_ns();
+}
+
+void FrameReport::reset()
+{
+    for( auto &h : stages ) h.reset();
+}
+
+bool FrameReport::dump( const char *path ) const
+{
+    char line[256];
+    std::string out;
+    snprintf( line, sizeof( line ), "# RDAI frame latency report: %llu frame(s), times in us\n",
+              (unsigned long long) stages[RDAI_FRAME_TOTAL].count() );
+    out += line;
+    snprintf( line, sizeof( line ), "%-12s %8s %10s %10s %10s %10s %10s\n",
+              "stage", "frames", "mean", "p50", "p90", "p99", "max" );
+    out += line;
+    for( int s = 0; s < RDAI_NUM_FRAME_STAGES; s++ ) {
+        RDAI_OpStats stats;
+        get( (RDAI_FrameStage) s, &stats );
+        snprintf( line, sizeof( line ), "%-12s %8llu %10.1f %10.1f %10.1f %10.1f %10.1f\n", stage_names[s],
+                  (unsigned long long) stats.count, stats.mean_ns / 1e3, stats.p50_ns / 1e3, stats.p90_ns / 1e3,
+                  stats.p99_ns / 1e3, stats.max_ns / 1e3 );
+        out += line;
+    }
+
+    return write_file_atomic( path, out );
+}
@@ -0,0 +1,160 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <algorithm>
+
+#include "graph.h"
+#include "runtime_util.h"
+
+#define GRAPH_NO_SLOT       UINT32_MAX
+#define GRAPH_LOCAL_PINS    4
+
+uint32_t RDAI_Graph::slot( RDAI_MemObject *mem_object )
+{
+    auto it = slots.find( mem_object );
+    if( it != slots.end() ) return it->second;
+    uint32_t s = (uint32_t) mem_objects.size();
+    mem_objects.push_back( mem_object );
+    slot_objects.push_back( Slot{ mem_object->mem_type, mem_object->device, mem_object->size } );
+    slots.emplace( mem_object, s );
+    return s;
+}
+
+void RDAI_Graph::use_platform( RDAI_Platform *platform, RDAI_PlatformOps *ops )
+{
+    auto entry = std::make_pair( platform, ops );
+    if( std::find( platforms.begin(), platforms.end(), entry ) == platforms.end() ) {
+        platforms.push_back( entry );
+    }
+}
+
+RDAI_Status RDAI_Graph::add_host_copy( RDAI_MemObject *src, RDAI_MemObject *dest )
+{
+    Node node = {};
+    node.kind = NODE_HOST_COPY;
+    node.src  = slot( src );
+    node.dest = slot( dest );
+    node.size = src->size;
+    nodes.push_back( node );
+    return make_status_ok();
+}
+
+RDAI_Status RDAI_Graph::add_device_copy( RDAI_Device *device, RDAI_PlatformOps *ops,
+                                         RDAI_MemObject *src, RDAI_MemObject *dest )
+{
+    Node node = {};
+    node.kind   = NODE_DEVICE_COPY;
+    node.ops    = ops;
+    node.device = device;
+    node.src    = slot( src );
+    node.dest   = slot( dest );
+    nodes.push_back( node );
+    use_platform( device->platform, ops );
+    return make_status_ok();
+}
+
+RDAI_Status RDAI_Graph::add_device_run( RDAI_Platform *platform, RDAI_PlatformOps *ops, RDAI_Device *device,
+                                        RDAI_MemObject **mem_object_list, size_t num_els )
+{
+    Node node = {};
+    node.kind   = NODE_DEVICE_RUN;
+    node.ops    = ops;
+    node.device = device;
+    node.list   = (uint32_t) lists.size();
+    for( size_t i = 0; i < num_els; i++ ) {
+        lists.push_back( mem_object_list[i] );
+        list_slots.push_back( slot( mem_object_list[i] ) );
+    }
+    lists.push_back( NULL );
+    list_slots.push_back( GRAPH_NO_SLOT );
+    nodes.push_back( node );
+    use_platform( platform, ops );
+    return make_status_ok();
+}
+
+RDAI_Status RDAI_Graph::launch( const RDAI_GraphBinding *bindings, size_t num_bindings,
+                                CopyEngine &copy_engine, PlatformRegistry &registry, Tracer &tracer,
+                                RunProfiler &profiler, FrameReport &frames ) const
+{
+    RDAI_MemObject * const *objects = mem_objects.data();
+    RDAI_MemObject * const *run_lists = lists.data();
+
+    // rebound launches work on per-thread copies of the slots and lists
+    static thread_local std::vector<RDAI_MemObject *> bound_objects, bound_lists;
+    if( num_bindings ) {
+        bound_objects.assign( mem_objects.begin(), mem_objects.end() );
+        for( size_t i = 0; i < num_bindings; i++ ) {
+            auto it = slots.find( bindings[i].captured );
+            const RDAI_MemObject *bound = bindings[i].bound;
+            if( it == slots.end() || !bound ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+            const Slot &captured = slot_objects[it->second];
+            if( bound->mem_type != captured.mem_type || bound->device != captured.device ) {
+                return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+            }
+            if( bound->size < captured.size ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_SIZE );
+            bound_objects[it->second] = bindings[i].bound;
+        }
+        bound_lists.assign( lists.begin(), lists.end() );
+        for( size_t i = 0; i < bound_lists.size(); i++ ) {
+            if( list_slots[i] != GRAPH_NO_SLOT ) bound_lists[i] = bound_objects[list_slots[i]];
+        }
+        objects   = bound_objects.data();
+        run_lists = bound_lists.data();
+    }
+
+    // pinned rather than read-locked for the replay, which may last
+    std::optional<PlatformRegistry::Pin> local_pins[GRAPH_LOCAL_PINS];
+    std::unique_ptr<std::optional<PlatformRegistry::Pin>[]> heap_pins;
+    std::optional<PlatformRegistry::Pin> *pins = local_pins;
+    if( platforms.size() > GRAPH_LOCAL_PINS ) {
+        heap_pins.reset( new std::optional<PlatformRegistry::Pin>[platforms.size()] );
+        pins = heap_pins.get();
+    }
+    for( size_t i = 0; i < platforms.size(); i++ ) {
+        pins[i].emplace( registry, platforms[i].first );
+        if( pins[i]->ops != platforms[i].second ) {
+            return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+        }
+    }
+
+    for( const Node &node : nodes ) {
+        switch( node.kind ) {
+        case NODE_HOST_COPY: {
+            RDAI_FRAME_SCOPE( frames, FrameReport::OP_COPY );
+            copy_engine.copy( objects[node.dest]->host_ptr, objects[node.src]->host_ptr, node.size );
+            break;
+        }
+        case NODE_DEVICE_COPY: {
+            RDAI_TRACE_SCOPE( tracer, "mem_copy", node.device );
+            RDAI_FRAME_SCOPE( frames, FrameReport::OP_COPY );
+            RDAI_Status status = node.ops->mem_copy( objects[node.src], objects[node.dest] );
+            if( status.status_code != RDAI_StatusCode::RDAI_STATUS_OK ) return status;
+            break;
+        }
+        case NODE_DEVICE_RUN: {
+            RDAI_TRACE_SCOPE( tracer, "device_run", node.device );
+            RDAI_RUN_PROFILE_SCOPE( profiler, node.device );
+            RDAI_FRAME_SCOPE( frames, FrameReport::OP_RUN );
+            RDAI_Status status = node.ops->device_run( node.device, (RDAI_MemObject **) &run_lists[node.list] );
+            if( status.status_code != RDAI_StatusCode::RDAI_STATUS_OK ) return status;
+            break;
+        }
+        }
+    }
+    return make_status_ok();
+}
@@ -0,0 +1,71 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <thread>
+
+#include "init_runner.h"
+#include "probes.h"
+
+InitRunner::~InitRunner()
+{
+    // initialization threads are detached: wait for them to leave
+    std::unique_lock<std::mutex> guard( lock );
+    idle.wait( guard, [this]() { return running == 0; } );
+}
+
+uint32_t InitRunner::submit( const char *name, Init init )
+{
+    uint32_t id = completions.create();
+    if( !id ) return 0;
+    RDAI_PROBE_SUBMIT( id, NULL, 0 );
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        running++;
+    }
+    tracer.async_begin( name, NULL, id );
+    std::thread( [this, id, name, init = std::move( init )]() {
+                CompletionTable::Running executing( completions, id );
+                RDAI_Status status = init();
+                tracer.async_end( name, NULL, id );
+                completions.complete( id, status );
+                std::lock_guard<std::mutex> guard( lock );
+                if( --running == 0 ) idle.notify_all();
+            }).detach();
+    return id;
+}
+
+void InitRunner::record( const RDAI_Platform *platform, uint64_t latency_ns )
+{
+    std::lock_guard<std::mutex> guard( lock );
+    latencies[platform] = latency_ns;
+}
+
+bool InitRunner::latency( const RDAI_Platform *platform, uint64_t *latency_ns ) const
+{
+    std::lock_guard<std::mutex> guard( lock );
+    auto it = latencies.find( platform );
+    if( it == latencies.end() ) return false;
+    *latency_ns = it->second;
+    return true;
+}
+
+void InitRunner::forget( const RDAI_Platform *platform )
+{
+    std::lock_guard<std::mutex> guard( lock );
+    latencies.erase( platform );
+}
@@ -20,6 +20,22 @@
 
 static RDAI_Platform_Impl impl;
 
+#define STATS_SCOPE( op, device )       RDAI_STATS_SCOPE( impl.api_stats(), op, device )
+#define TRACE_SCOPE()                   RDAI_TRACE_SCOPE( impl.api_tracer(), __func__, NULL )
+
+/**
+ * Start the trace flow of the handle returned by an asynchronous call, and
+ * attribute the call to the current frame of the thread (if any)
+ */
+static RDAI_Status trace_submit( RDAI_Status status, FrameReport::Op op = FrameReport::OP_NONE )
+{
+    if( status.status_code == RDAI_StatusCode::RDAI_STATUS_OK && !status.async_handle.platform ) {
+        impl.api_tracer().flow_begin( status.async_handle.id.value );
+        if( op != FrameReport::OP_NONE ) impl.api_frames().submitted( status.async_handle.id.value, op );
+    }
+    return status;
+}
+
 /**
  * Get all platforms registered with the runtime
  *
@@ -27,6 +43,7 @@ static RDAI_Platform_Impl impl;
  */
 RDAI_Platform **RDAI_get_all_platforms( void )
 {
+    TRACE_SCOPE();
     return impl.get_all_platforms();
 }
 
@@ -38,6 +55,7 @@ RDAI_Platform **RDAI_get_all_platforms( void )
  */
 RDAI_Platform **RDAI_get_platforms_with_type( const RDAI_PlatformType *platform_type )
 {
+    TRACE_SCOPE();
     return impl.get_platforms_with_type( platform_type );
 }
 
@@ -49,6 +67,7 @@ RDAI_Platform **RDAI_get_platforms_with_type( const RDAI_PlatformType *platform_
  */
 RDAI_Platform **RDAI_get_platforms_with_property( const RDAI_Property *property )
 {
+    TRACE_SCOPE();
     return impl.get_platforms_with_property( property );
 }
 
@@ -60,6 +79,7 @@ RDAI_Platform **RDAI_get_platforms_with_property( const RDAI_Property *property
  */
 RDAI_Platform **RDAI_get_platforms_with_properties( const RDAI_Property **property_list )
 {
+    TRACE_SCOPE();
     return impl.get_platforms_with_properties( property_list );
 }
 
@@ -71,6 +91,7 @@ RDAI_Platform **RDAI_get_platforms_with_properties( const RDAI_Property **proper
  */
 RDAI_Platform *RDAI_get_platform_with_id( const RDAI_ID * platform_id )
 {
+    TRACE_SCOPE();
     return impl.get_platform_with_id( platform_id );
 }
 
@@ -82,6 +103,7 @@ RDAI_Platform *RDAI_get_platform_with_id( const RDAI_ID * platform_id )
  */
 RDAI_Status RDAI_free_platform_list( RDAI_Platform **platform_list )
 {
+    TRACE_SCOPE();
     return impl.free_platform_list( platform_list );
 }
 
@@ -93,6 +115,7 @@ RDAI_Status RDAI_free_platform_list( RDAI_Platform **platform_list )
  */
 RDAI_Device **RDAI_get_all_devices( const RDAI_Platform *platform )
 {
+    TRACE_SCOPE();
     return impl.get_all_devices( platform );
 }
 
@@ -105,6 +128,7 @@ RDAI_Device **RDAI_get_all_devices( const RDAI_Platform *platform )
  */
 RDAI_Device **RDAI_get_devices_with_vlnv( const RDAI_Platform *platform, const RDAI_VLNV *device_vlnv )
 {
+    TRACE_SCOPE();
     return impl.get_devices_with_vlnv( platform, device_vlnv );
 }
 
@@ -117,6 +141,7 @@ RDAI_Device **RDAI_get_devices_with_vlnv( const RDAI_Platform *platform, const R
  */
 RDAI_Device **RDAI_get_devices_with_property( const RDAI_Platform *platform, const RDAI_Property *property )
 {
+    TRACE_SCOPE();
     return impl.get_devices_with_property( platform, property );
 }
 
@@ -129,6 +154,7 @@ RDAI_Device **RDAI_get_devices_with_property( const RDAI_Platform *platform, con
  */
 RDAI_Device **RDAI_get_devices_with_properties( const RDAI_Platform *platform, const RDAI_Property **property_list )
 {
+    TRACE_SCOPE();
     return impl.get_devices_with_properties( platform, property_list );
 }
 
@@ -141,6 +167,7 @@ RDAI_Device **RDAI_get_devices_with_properties( const RDAI_Platform *platform, c
  */
 RDAI_Device *RDAI_get_device_with_id( const RDAI_Platform *platform, const RDAI_ID *device_id )
 {
+    TRACE_SCOPE();
     return impl.get_device_with_id( platform, device_id );
 }
 
@@ -152,6 +179,7 @@ RDAI_Device *RDAI_get_device_with_id( const RDAI_Platform *platform, const RDAI_
  */
 RDAI_Status RDAI_free_device_list( RDAI_Device **device_list )
 {
+    TRACE_SCOPE();
     return impl.free_device_list( device_list );
 }
 
@@ -164,6 +192,7 @@ RDAI_Status RDAI_free_device_list( RDAI_Device **device_list )
  */
 int RDAI_platform_has_property( const RDAI_Platform *platform, const RDAI_Property *property )
 {
+    TRACE_SCOPE();
     return impl.platform_has_property( platform, property );
 }
 
@@ -176,6 +205,7 @@ int RDAI_platform_has_property( const RDAI_Platform *platform, const RDAI_Proper
  */
 int RDAI_platform_has_properties( const RDAI_Platform *platform, const RDAI_Property **property_list )
 {
+    TRACE_SCOPE();
     return impl.platform_has_properties( platform, property_list );
 }
 
@@ -188,6 +218,7 @@ int RDAI_platform_has_properties( const RDAI_Platform *platform, const RDAI_Prop
  */
 int RDAI_device_has_property( const RDAI_Device *device, const RDAI_Property *property )
 {
+    TRACE_SCOPE();
     return impl.device_has_property( device, property );
 }
 
@@ -200,6 +231,7 @@ int RDAI_device_has_property( const RDAI_Device *device, const RDAI_Property *pr
  */
 int RDAI_device_has_properties( const RDAI_Device *device, const RDAI_Property **property_list )
 {
+    TRACE_SCOPE();
     return impl.device_has_properties( device, property_list );
 }
 
@@ -211,20 +243,44 @@ int RDAI_device_has_properties( const RDAI_Device *device, const RDAI_Property *
  */
 RDAI_Platform *RDAI_register_platform( RDAI_PlatformOps *platform_ops )
 {
+    TRACE_SCOPE();
     return impl.register_platform( platform_ops );
 }
 
 /**
  * Unregister a platform from the runtime
  *
+ * Calls into the platform that are already in flight on other threads
+ * complete before the platform is destroyed
+ *
  * @param platform The platform to unregister
  * @return status
  */
 RDAI_Status RDAI_unregister_platform( RDAI_Platform *platform )
 {
+    TRACE_SCOPE();
     return impl.unregister_platform( platform );
 }
 
+/**
+ * Load a platform plugin
+ *
+ * The shared library is opened and its RDAI_PLUGIN_OPS_SYMBOL is resolved.
+ * The platform is registered (and platform_create called) the first time
+ * platforms are enumerated or a run is submitted by VLNV. Plugins listed in
+ * RDAI_PLUGIN_PATH (colon-separated files or directories of .so files) are
+ * loaded the same way. Plugin libraries stay loaded until the program exits
+ *
+ * @param path The path of the shared library (as for dlopen)
+ * @return status (RDAI_REASON_PLUGIN_LOAD if the library cannot be opened
+ *         or does not export platform ops)
+ */
+RDAI_Status RDAI_load_platform_plugin( const char *path )
+{
+    TRACE_SCOPE();
+    return impl.load_platform_plugin( path );
+}
+
 /**
  * Allocate a RDAI_MEM_HOST memory object
  *
@@ -233,9 +289,31 @@ RDAI_Status RDAI_unregister_platform( RDAI_Platform *platform )
  */
 RDAI_MemObject *RDAI_mem_host_allocate( size_t size )
 {
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_MEM_ALLOCATE, NULL );
     return impl.mem_host_allocate( size );
 }
 
+/**
+ * Allocate a RDAI_MEM_HOST memory object with allocation flags
+ *
+ * RDAI_MEM_FLAG_PINNED and RDAI_MEM_FLAG_NUMA_BIND are strict: the allocation
+ * fails if they cannot be honored. RDAI_MEM_FLAG_HUGE_PAGES falls back to
+ * transparent huge pages, which the kernel may not grant, and is then not
+ * recorded. The properties the allocation is known to have are recorded in
+ * the flags of the memory object
+ *
+ * @param size The allocation size in bytes
+ * @param flags A combination of RDAI_MEM_FLAG_* values
+ * @return The allocated memory object or NULL
+ */
+RDAI_MemObject *RDAI_mem_host_allocate_ex( size_t size, uint64_t flags )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_MEM_ALLOCATE, NULL );
+    return impl.mem_host_allocate_ex( size, flags );
+}
+
 /**
  * Allocate a RDAI_MEM_DEVICE memory object
  *
@@ -245,6 +323,8 @@ RDAI_MemObject *RDAI_mem_host_allocate( size_t size )
  */
 RDAI_MemObject *RDAI_mem_device_allocate( RDAI_Device *device, size_t size )
 {
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_MEM_ALLOCATE, device );
     return impl.mem_device_allocate( device, size );
 }
 
@@ -256,25 +336,79 @@ RDAI_MemObject *RDAI_mem_device_allocate( RDAI_Device *device, size_t size )
  */
 RDAI_MemObject *RDAI_mem_shared_allocate( size_t size )
 {
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_MEM_ALLOCATE, NULL );
     return impl.mem_shared_allocate( size );
 }
 
+/**
+ * Allocate a RDAI_MEM_SHARED memory object with allocation flags
+ *
+ * See RDAI_mem_host_allocate_ex for the semantics of the flags
+ *
+ * @param size The allocation size in bytes
+ * @param flags A combination of RDAI_MEM_FLAG_* values
+ * @return The allocated memory object or NULL
+ */
+RDAI_MemObject *RDAI_mem_shared_allocate_ex( size_t size, uint64_t flags )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_MEM_ALLOCATE, NULL );
+    return impl.mem_shared_allocate_ex( size, flags );
+}
+
 /**
  * Free a memory object
  *
+ * As with free(), the memory object must have been allocated by the host
+ * runtime and not freed yet: freeing any other object is undefined
+ *
  * @param mem_object The memory object to free
  * @return status
  */
 RDAI_Status RDAI_mem_free( RDAI_MemObject *mem_object )
 {
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_MEM_FREE, NULL );
     return impl.mem_free( mem_object );
 }
 
+/**
+ * Release the free memory retained by the memory object pool
+ *
+ * Memory cached by other threads is released when those threads exit
+ *
+ * @return status
+ */
+RDAI_Status RDAI_mem_pool_trim( void )
+{
+    TRACE_SCOPE();
+    return impl.mem_pool_trim();
+}
+
+/**
+ * Get the statistics of the memory object pool
+ *
+ * @param stats The statistics to fill
+ * @return status
+ */
+RDAI_Status RDAI_mem_pool_get_stats( RDAI_MemPoolStats *stats )
+{
+    return impl.mem_pool_get_stats( stats );
+}
+
 /**
  * Synchronous copy from a memory object to another
  *
- * If src and dest are both RDAI_MEM_DEVICE memory objects, the copy operation
- * is relayed to the platform associated with src memory object
+ * If src or dest is a RDAI_MEM_DEVICE memory object, the copy operation is
+ * relayed to the platform associated with that memory object (src first).
+ * Copies between RDAI_MEM_HOST and RDAI_MEM_SHARED memory objects (or crops
+ * of them) are performed by the host runtime; dest must be at least as large
+ * as src. Overlapping crops of the same memory object are copied as with
+ * memmove
+ *
+ * While a graph is being captured on the calling thread, the call is
+ * recorded instead of executed (see RDAI_graph_begin_capture)
  *
  * @param src The source memory object
  * @param dest The destination memory object
@@ -282,14 +416,22 @@ RDAI_Status RDAI_mem_free( RDAI_MemObject *mem_object )
  */
 RDAI_Status RDAI_mem_copy( RDAI_MemObject *src, RDAI_MemObject *dest )
 {
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_MEM_COPY, copy_device( src, dest ) );
     return impl.mem_copy( src, dest );
 }
 
 /**
  * Asynchronous copy from a memory object to another
  *
- * If src and dest are both RDAI_MEM_DEVICE memory objects, the copy operation
- * is relayed to the platform associated with src memory object
+ * If src or dest is a RDAI_MEM_DEVICE memory object, the copy operation is
+ * queued to the host runtime thread of that memory object's device (src
+ * first), in order with the runs of the device, and started by the
+ * asynchronous copy of its platform, or executed by its synchronous copy
+ * when the platform has none. Copies between RDAI_MEM_HOST and
+ * RDAI_MEM_SHARED memory objects (or crops of them) are queued to the copy
+ * threads of the host runtime; submission blocks while the copy queue is
+ * full. Both memory objects must stay valid until the copy is synchronized
  *
  * @param src The source memory object
  * @param dest The destination memory object
@@ -297,13 +439,60 @@ RDAI_Status RDAI_mem_copy( RDAI_MemObject *src, RDAI_MemObject *dest )
  */
 RDAI_Status RDAI_mem_copy_async( RDAI_MemObject *src, RDAI_MemObject *dest )
 {
-    return impl.mem_copy_async( src, dest );
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_MEM_COPY_ASYNC, copy_device( src, dest ) );
+    return trace_submit( impl.mem_copy_async( src, dest ), FrameReport::OP_COPY );
+}
+
+/**
+ * Asynchronous copy from a memory object to another, with a completion callback
+ *
+ * Same as RDAI_mem_copy_async, but callback(handle, status, ctx) is called
+ * from the completion thread of the host runtime once the copy has finished.
+ * Synchronizing the returned handle is optional: RDAI_sync returns the status
+ * of the copy until the callback has returned, and RDAI_REASON_STALE_HANDLE
+ * afterwards. Callbacks should return quickly, as they are called one at a time
+ *
+ * @param src The source memory object
+ * @param dest The destination memory object
+ * @param callback The function to call on completion
+ * @param ctx The context pointer passed to callback
+ * @return status (with async handle)
+ */
+RDAI_Status RDAI_mem_copy_async_cb( RDAI_MemObject *src, RDAI_MemObject *dest,
+                                    RDAI_CompletionCallback callback, void *ctx )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_MEM_COPY_ASYNC, copy_device( src, dest ) );
+    return trace_submit( impl.mem_copy_async_cb( src, dest, callback, ctx ), FrameReport::OP_COPY );
+}
+
+/**
+ * Asynchronous copy from a memory object to another, with a priority class
+ *
+ * Same as RDAI_mem_copy_async (which uses RDAI_PRIORITY_NORMAL). Queued
+ * copies of a higher priority class are started first; a copy overtakes
+ * newer copies of the next higher class once it has waited for the aging
+ * step (RDAI_PRIORITY_AGING_US, 10 ms by default), so no class starves.
+ * Device copies are ordered with the runs of their device of the same class
+ *
+ * @param src The source memory object
+ * @param dest The destination memory object
+ * @param priority The priority class of the copy
+ * @return status (with async handle)
+ */
+RDAI_Status RDAI_mem_copy_async_prio( RDAI_MemObject *src, RDAI_MemObject *dest, RDAI_Priority priority )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_MEM_COPY_ASYNC, copy_device( src, dest ) );
+    return trace_submit( impl.mem_copy_async_prio( src, dest, priority ), FrameReport::OP_COPY );
 }
 
 /**
  * Create a cropped/sliced view of a memory object
  *
- * It is allowed to create a cropped/sliced view of another cropped/sliced view
+ * It is allowed to create a cropped/sliced view of another cropped/sliced view.
+ * Crops of RDAI_MEM_DEVICE memory objects are relayed to their platform
  *
  * @param The memory object to crop/slice
  * @param offset The address offset in bytes from the origin of the source memory object where
@@ -313,6 +502,7 @@ RDAI_Status RDAI_mem_copy_async( RDAI_MemObject *src, RDAI_MemObject *dest )
  */
 RDAI_MemObject *RDAI_mem_crop( RDAI_MemObject *src, size_t offset, size_t crop_size )
 {
+    TRACE_SCOPE();
     return impl.mem_crop( src, offset, crop_size );
 }
 
@@ -324,13 +514,16 @@ RDAI_MemObject *RDAI_mem_crop( RDAI_MemObject *src, size_t offset, size_t crop_s
  */
 RDAI_Status RDAI_mem_free_crop( RDAI_MemObject *cropped_mem_object )
 {
+    TRACE_SCOPE();
     return impl.mem_free_crop( cropped_mem_object );
 }
 
 /**
  * Initialize a hardware platform
  *
- * The initialization semantics of a hardware platform are platform-dependent
+ * The initialization semantics of a hardware platform are platform-dependent.
+ * The duration of the call is kept as the init latency of the platform (see
+ * RDAI_get_platform_init_latency)
  *
  * @param platform The platform to initialize (pointer)
  * @param user_data Platform-dependent initialization context/data (opaque pointer)
@@ -338,6 +531,7 @@ RDAI_Status RDAI_mem_free_crop( RDAI_MemObject *cropped_mem_object )
  */
 RDAI_Status RDAI_platform_init( RDAI_Platform *platform, void *user_data )
 {
+    TRACE_SCOPE();
     return impl.platform_init( platform, user_data );
 }
 
@@ -352,6 +546,7 @@ RDAI_Status RDAI_platform_init( RDAI_Platform *platform, void *user_data )
  */
 RDAI_Status RDAI_platform_deinit( RDAI_Platform *platform, void *user_data )
 {
+    TRACE_SCOPE();
     return impl.platform_deinit( platform, user_data );
 }
 
@@ -366,6 +561,7 @@ RDAI_Status RDAI_platform_deinit( RDAI_Platform *platform, void *user_data )
  */
 RDAI_Status RDAI_device_init( RDAI_Device *device, void *user_data )
 {
+    TRACE_SCOPE();
     return impl.device_init( device, user_data );
 }
 
@@ -380,9 +576,58 @@ RDAI_Status RDAI_device_init( RDAI_Device *device, void *user_data )
  */
 RDAI_Status RDAI_device_deinit( RDAI_Device *device, void *user_data )
 {
+    TRACE_SCOPE();
     return impl.device_deinit( device, user_data );
 }
 
+/**
+ * Asynchronously initialize a hardware platform
+ *
+ * The initialization runs on its own thread, so that several platforms can
+ * be initialized concurrently (use RDAI_wait_any to serve from the first
+ * one ready). user_data must stay valid until the initialization completes
+ *
+ * @param platform The platform to initialize (pointer)
+ * @param user_data Platform-dependent initialization context/data (opaque pointer)
+ * @return status (with async handle)
+ */
+RDAI_Status RDAI_platform_init_async( RDAI_Platform *platform, void *user_data )
+{
+    TRACE_SCOPE();
+    return trace_submit( impl.platform_init_async( platform, user_data ) );
+}
+
+/**
+ * Asynchronously initialize an accelerator device
+ *
+ * The initialization is queued on the device like an asynchronous run, so
+ * asynchronous runs of the device submitted after it start once it is done.
+ * user_data must stay valid until the initialization completes
+ *
+ * @param device The accelerator device to initialize (pointer)
+ * @param user_data Device-dependent context/data (opaque pointer)
+ * @return status (with async handle)
+ */
+RDAI_Status RDAI_device_init_async( RDAI_Device *device, void *user_data )
+{
+    TRACE_SCOPE();
+    return trace_submit( impl.device_init_async( device, user_data ) );
+}
+
+/**
+ * Get the duration of the last initialization of a platform
+ *
+ * @param platform The platform
+ * @param latency_ns The duration of its last platform_init call in nanoseconds
+ * @return status (an error if the platform has not been initialized since it
+ *         was registered)
+ */
+RDAI_Status RDAI_get_platform_init_latency( const RDAI_Platform *platform, uint64_t *latency_ns )
+{
+    TRACE_SCOPE();
+    return impl.get_platform_init_latency( platform, latency_ns );
+}
+
 /**
  * Synchronously run an accelerator device
  *
@@ -393,36 +638,819 @@ RDAI_Status RDAI_device_deinit( RDAI_Device *device, void *user_data )
  * @return status
  *
  * NOTE: The positional meaning of the input memory objects is device-dependent
+ *
+ * While a graph is being captured on the calling thread, the call is
+ * recorded instead of executed (see RDAI_graph_begin_capture)
  */
 RDAI_Status RDAI_device_run( RDAI_Device *device, RDAI_MemObject **mem_object_list )
 {
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_DEVICE_RUN, device );
     return impl.device_run( device, mem_object_list );
 }
 
 /**
  * Asynchronously run an accelerator device
  *
+ * The run is queued to the host runtime thread of the device, which executes
+ * the runs of the device in submission order: it starts each run with the
+ * asynchronous run of the platform, or executes it with the synchronous run
+ * when the platform has none. The memory object list must
+ * stay valid until the run is synchronized. When the submission ring of the
+ * device is full, the call waits for room or fails (see RDAI_set_backpressure)
+ *
  * @param device The device to run
  * @param mem_object_list A NULL-terminated list of memory object pointers.
  *                  The last element is the output memory object.
  *                  All other elements are input memory objects.
- * @return status (with async handle)
+ * @return status (with async handle; RDAI_REASON_BUSY if the ring is full in
+ *         RDAI_BACKPRESSURE_BUSY mode)
  *
  * NOTE: The positional meaning of the input memory objects is device-dependent
  */
 RDAI_Status RDAI_device_run_async( RDAI_Device *device, RDAI_MemObject **mem_object_list )
 {
-    return impl.device_run_async( device, mem_object_list);
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_DEVICE_RUN_ASYNC, device );
+    return trace_submit( impl.device_run_async( device, mem_object_list ), FrameReport::OP_RUN );
+}
+
+/**
+ * Asynchronously run an accelerator device, with a completion callback
+ *
+ * Same as RDAI_device_run_async, but callback(handle, status, ctx) is called
+ * from the completion thread of the host runtime once the run has finished.
+ * Synchronizing the returned handle is optional: RDAI_sync returns the status
+ * of the run until the callback has returned, and RDAI_REASON_STALE_HANDLE
+ * afterwards. Callbacks should return quickly, as they are called one at a time
+ *
+ * @param device The device to run
+ * @param mem_object_list A NULL-terminated list of memory object pointers
+ *                        (see RDAI_device_run_async)
+ * @param callback The function to call on completion
+ * @param ctx The context pointer passed to callback
+ * @return status (with async handle)
+ */
+RDAI_Status RDAI_device_run_async_cb( RDAI_Device *device, RDAI_MemObject **mem_object_list,
+                                      RDAI_CompletionCallback callback, void *ctx )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_DEVICE_RUN_ASYNC, device );
+    return trace_submit( impl.device_run_async_cb( device, mem_object_list, callback, ctx ), FrameReport::OP_RUN );
+}
+
+/**
+ * Asynchronously run an accelerator device, with a priority class
+ *
+ * Same as RDAI_device_run_async (which uses RDAI_PRIORITY_NORMAL). Queued
+ * runs and copies of a device are dispatched by priority class, in
+ * submission order within a class; waiting work is aged as described for
+ * RDAI_mem_copy_async_prio
+ *
+ * @param device The device to run
+ * @param mem_object_list A NULL-terminated list of memory object pointers
+ *                        (see RDAI_device_run_async)
+ * @param priority The priority class of the run
+ * @return status (with async handle)
+ */
+RDAI_Status RDAI_device_run_async_prio( RDAI_Device *device, RDAI_MemObject **mem_object_list,
+                                        RDAI_Priority priority )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_DEVICE_RUN_ASYNC, device );
+    return trace_submit( impl.device_run_async_prio( device, mem_object_list, priority ), FrameReport::OP_RUN );
+}
+
+/**
+ * Get the queue wait statistics of a priority class
+ *
+ * The wait of an asynchronous copy or run is the time from its submission
+ * until the host runtime starts it. Statistics accumulate from the start of
+ * the program or the last RDAI_reset_queue_wait_stats
+ *
+ * @param priority The priority class
+ * @param stats The statistics to fill
+ * @return status
+ */
+RDAI_Status RDAI_get_queue_wait_stats( RDAI_Priority priority, RDAI_QueueWaitStats *stats )
+{
+    return impl.get_queue_wait_stats( priority, stats );
+}
+
+/**
+ * Reset the queue wait statistics of all priority classes
+ *
+ * @return status
+ */
+RDAI_Status RDAI_reset_queue_wait_stats( void )
+{
+    return impl.reset_queue_wait_stats();
+}
+
+/**
+ * Set what asynchronous submissions to a device do when its ring is full
+ *
+ * Runs, batches, launches and copies relayed to a platform are submitted to
+ * the host runtime thread of their device through a ring of
+ * RDAI_SUBMIT_RING_SIZE entries (4096 by default). The device thread takes
+ * submissions from the ring while it holds fewer than that many to
+ * dispatch, so at most twice that many wait per device. When the ring is
+ * full, RDAI_BACKPRESSURE_BLOCK (the default) waits until the device thread
+ * has taken submissions from it, and RDAI_BACKPRESSURE_BUSY fails the
+ * submission with RDAI_REASON_BUSY so that the caller can retry or shed
+ * load. The initial mode is RDAI_BACKPRESSURE_BUSY if
+ * RDAI_SUBMIT_BACKPRESSURE=busy
+ *
+ * @param mode The backpressure mode
+ * @return status
+ */
+RDAI_Status RDAI_set_backpressure( RDAI_Backpressure mode )
+{
+    return impl.set_backpressure( mode );
+}
+
+/**
+ * Get the latency statistics of host API calls
+ *
+ * Available when the host runtime is built with RDAI_ENABLE_STATS. Calls are
+ * timed from entry to return; per-device statistics cover the runs and
+ * copies (of RDAI_MEM_DEVICE memory objects) of a device, and allocations
+ * of device memory. Statistics accumulate from the start of the program or
+ * the last RDAI_reset_stats
+ *
+ * @param op The operation class
+ * @param device The device to report (NULL for all calls of the class)
+ * @param stats The statistics to fill
+ * @return status (RDAI_REASON_UNIMPLEMENTED without RDAI_ENABLE_STATS)
+ */
+RDAI_Status RDAI_get_stats( RDAI_StatsOp op, const RDAI_Device *device, RDAI_OpStats *stats )
+{
+    return impl.get_stats( op, device, stats );
+}
+
+/**
+ * Clear the latency statistics of host API calls
+ *
+ * @return status (RDAI_REASON_UNIMPLEMENTED without RDAI_ENABLE_STATS)
+ */
+RDAI_Status RDAI_reset_stats( void )
+{
+    return impl.reset_stats();
+}
+
+/**
+ * Write the latency statistics of host API calls in the Prometheus text format
+ *
+ * The file is replaced atomically. Setting RDAI_STATS_FILE makes the host
+ * runtime write it periodically instead (every RDAI_STATS_INTERVAL_MS
+ * milliseconds, 10000 by default, and at exit)
+ *
+ * @param path The file to write
+ * @return status (RDAI_REASON_UNIMPLEMENTED without RDAI_ENABLE_STATS)
+ */
+RDAI_Status RDAI_dump_stats( const char *path )
+{
+    return impl.dump_stats( path );
+}
+
+/**
+ * Write the trace of host runtime activity to RDAI_TRACE_FILE
+ *
+ * Tracing is enabled by setting RDAI_TRACE_FILE. Host API calls, the
+ * platform operations they invoke and the span of every asynchronous handle
+ * from submission to completion are then recorded in per-thread rings of
+ * RDAI_TRACE_BUFFER_EVENTS events (65536 by default, oldest overwritten),
+ * and written as Chrome trace-event JSON, viewable in ui.perfetto.dev or
+ * chrome://tracing, at exit and on each call. Each device has a track of
+ * its own, and flow arrows link submissions to their synchronization
+ *
+ * @return status (RDAI_REASON_UNIMPLEMENTED when tracing is not enabled)
+ */
+RDAI_Status RDAI_trace_flush( void )
+{
+    return impl.trace_flush();
+}
+
+/**
+ * Enable or disable the host CPU counters of device runs
+ *
+ * While enabled, every device_run of a platform, whether from a synchronous,
+ * asynchronous, batched, launched, graph or VLNV run, is wrapped in a group
+ * of perf_event counters of the thread executing it: cycles, instructions,
+ * last level cache misses, branch misses and CPU time. Counts accumulate
+ * per device. Counting adds about a microsecond to each run. Setting
+ * RDAI_RUN_COUNTERS=1 enables the counters from the start of the program
+ *
+ * @param enable Non-zero to enable the counters
+ * @return status
+ */
+RDAI_Status RDAI_set_run_counters( int enable )
+{
+    return impl.set_run_counters( enable );
+}
+
+/**
+ * Get the host CPU counters of device runs
+ *
+ * Counters accumulate from the start of the program or the last
+ * RDAI_reset_run_counters. The counts of devices since unregistered stay in
+ * the totals by VLNV and of all devices, but no longer under the device
+ *
+ * @param device The device to report, or NULL
+ * @param vlnv When device is NULL, the VLNV of the devices to report
+ *             together, or NULL for all devices
+ * @param counters The counters to fill
+ * @return status
+ */
+RDAI_Status RDAI_get_run_counters( const RDAI_Device *device, const RDAI_VLNV *vlnv, RDAI_RunCounters *counters )
+{
+    return impl.get_run_counters( device, vlnv, counters );
+}
+
+/**
+ * Clear the host CPU counters of device runs
+ *
+ * @return status
+ */
+RDAI_Status RDAI_reset_run_counters( void )
+{
+    return impl.reset_run_counters();
+}
+
+/**
+ * Open a frame and make it the current frame of the calling thread
+ *
+ * Frames break the latency of an application unit of work (e.g. an image
+ * through a pipeline) into stages: input copies, queue waits, device
+ * compute, output copies and synchronization wake-ups (see
+ * RDAI_FrameStage). The copies and runs a thread issues while a frame is
+ * current belong to that frame; copies issued before the first run of the
+ * frame are its input copies, later ones its output copies. Async calls
+ * are attributed when they are synchronized (with RDAI_sync, sync_all or
+ * wait_any), from the profile of their handle (see
+ * RDAI_get_handle_profile). Queue commands (RDAI_queue_mem_copy and
+ * RDAI_queue_device_run) are timed when they execute, and the copies and
+ * runs of a graph launch as they execute. When the frame ends, each stage
+ * it used is added to the per-stage percentiles of RDAI_get_frame_stats.
+ * Setting RDAI_FRAME_REPORT_FILE writes the report to that file every
+ * RDAI_FRAME_REPORT_INTERVAL_MS milliseconds (10000 by default) and at
+ * exit
+ *
+ * @param frame_id The ID of the frame, chosen by the application (not 0)
+ * @return status (RDAI_REASON_INVALID_OBJECT if the frame is already open)
+ */
+RDAI_Status RDAI_frame_begin( uint64_t frame_id )
+{
+    return impl.frame_begin( frame_id );
+}
+
+/**
+ * Make an open frame the current frame of the calling thread
+ *
+ * Pipelines that interleave the operations of several frames select the
+ * frame of each operation before issuing it. Frames can be selected from
+ * any thread
+ *
+ * @param frame_id The ID of the frame, or 0 for no current frame
+ * @return status (RDAI_REASON_INVALID_OBJECT if the frame is not open)
+ */
+RDAI_Status RDAI_frame_select( uint64_t frame_id )
+{
+    return impl.frame_select( frame_id );
+}
+
+/**
+ * Close a frame and add its stages to the frame statistics
+ *
+ * Async calls and queue commands of the frame must be synchronized
+ * before: the ones synchronized later are not counted
+ *
+ * @param frame_id The ID of the frame
+ * @return status (RDAI_REASON_INVALID_OBJECT if the frame is not open)
+ */
+RDAI_Status RDAI_frame_end( uint64_t frame_id )
+{
+    return impl.frame_end( frame_id );
+}
+
+/**
+ * Get the latency percentiles of a frame stage
+ *
+ * count is the number of frames that had operations in the stage
+ *
+ * @param stage The stage to report
+ * @param stats The statistics to fill
+ * @return status
+ */
+RDAI_Status RDAI_get_frame_stats( RDAI_FrameStage stage, RDAI_OpStats *stats )
+{
+    return impl.get_frame_stats( stage, stats );
+}
+
+/**
+ * Clear the frame statistics
+ *
+ * @return status
+ */
+RDAI_Status RDAI_reset_frame_stats( void )
+{
+    return impl.reset_frame_stats();
+}
+
+/**
+ * Write the frame latency report, a text table of the percentiles of each
+ * stage
+ *
+ * The file is replaced atomically
+ *
+ * @param path The file to write
+ * @return status
+ */
+RDAI_Status RDAI_dump_frame_report( const char *path )
+{
+    return impl.dump_frame_report( path );
+}
+
+/**
+ * Asynchronously run an accelerator device once per memory object list
+ *
+ * The runs are queued together to the device's host runtime thread, in list
+ * order, and share one async handle. If the platform provides
+ * device_run_batch, the whole batch is passed to it; otherwise the runs are
+ * made one by one with device_run. The batch stops at the first run that
+ * fails, and synchronizing the handle returns that run's status.
+ * mem_object_lists and the lists it points to must stay valid until then
+ *
+ * @param device The device to run
+ * @param mem_object_lists An array of count NULL-terminated lists of memory
+ *                         object pointers (see RDAI_device_run)
+ * @param count The number of runs
+ * @return status (with async handle)
+ */
+RDAI_Status RDAI_device_run_batch( RDAI_Device *device, RDAI_MemObject ***mem_object_lists, size_t count )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_DEVICE_RUN_ASYNC, device );
+    return trace_submit( impl.device_run_batch( device, mem_object_lists, count ), FrameReport::OP_RUN );
+}
+
+/**
+ * Create a launch descriptor for repeated runs of a device
+ *
+ * The device, its platform and the memory objects are checked and the platform
+ * ops are looked up once, here. RDAI_launch_run and RDAI_launch_run_async then
+ * call the platform without any check, so a launch must be destroyed before
+ * the platform of its device is unregistered
+ *
+ * @param device The device to run
+ * @param mem_objects An array of count memory object pointers, in the order of
+ *                    a RDAI_device_run list (the last one is the output)
+ * @param count The number of memory objects
+ * @return The launch or NULL
+ */
+RDAI_Launch *RDAI_launch_create( RDAI_Device *device, RDAI_MemObject **mem_objects, size_t count )
+{
+    TRACE_SCOPE();
+    return impl.launch_create( device, mem_objects, count );
+}
+
+/**
+ * Destroy a launch descriptor
+ *
+ * Asynchronous runs of the launch must have completed
+ *
+ * @param launch The launch to destroy
+ * @return status
+ */
+RDAI_Status RDAI_launch_destroy( RDAI_Launch *launch )
+{
+    TRACE_SCOPE();
+    return impl.launch_destroy( launch );
+}
+
+/**
+ * Synchronously run the device of a launch descriptor
+ *
+ * While a graph is being captured on the calling thread, the run is recorded
+ * instead of executed (see RDAI_graph_begin_capture)
+ *
+ * @param launch The launch to run
+ * @return status
+ */
+RDAI_Status RDAI_launch_run( RDAI_Launch *launch )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_DEVICE_RUN, launch ? launch->device : NULL );
+    return impl.launch_run( launch );
+}
+
+/**
+ * Asynchronously run the device of a launch descriptor
+ *
+ * The run is queued to the device's host runtime thread, in submission order
+ * with the other asynchronous runs of the device
+ *
+ * @param launch The launch to run
+ * @return status (with async handle)
+ */
+RDAI_Status RDAI_launch_run_async( RDAI_Launch *launch )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_DEVICE_RUN_ASYNC, launch ? launch->device : NULL );
+    return trace_submit( impl.launch_run_async( launch ), FrameReport::OP_RUN );
+}
+
+/**
+ * Asynchronously run any device with a given VLNV
+ *
+ * The host runtime keeps a queue of runs for every device of the registered
+ * platforms that matches the VLNV, and queues the run on the device chosen
+ * by the dispatch policy (see RDAI_set_dispatch_policy). A device whose
+ * queue is empty takes runs from the queue of a busy device with the same
+ * VLNV, so identical accelerators share the load. Runs are not ordered with
+ * respect to each other
+ *
+ * @param vlnv The VLNV of the device to run
+ * @param mem_object_list A NULL-terminated list of memory object pointers
+ *                        (see RDAI_device_run)
+ * @return status (with async handle; RDAI_REASON_NO_DEVICE if no device of a
+ *         registered platform has the VLNV)
+ */
+RDAI_Status RDAI_submit_by_vlnv( const RDAI_VLNV *vlnv, RDAI_MemObject **mem_object_list )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_DEVICE_RUN_ASYNC, NULL );
+    return trace_submit( impl.submit_by_vlnv( vlnv, mem_object_list ), FrameReport::OP_RUN );
+}
+
+/**
+ * Set the policy choosing the device of each RDAI_submit_by_vlnv run
+ *
+ * The policy is called with the estimates of every device matching the VLNV
+ * (see RDAI_get_device_estimate) and returns the index of the device to use.
+ * The default policy picks the lowest expected completion time,
+ * (queue_depth + 1) * latency_ns. Policies are called with a host runtime
+ * lock held and must not call the RDAI API
+ *
+ * @param policy The policy (NULL restores the default policy)
+ * @param ctx The context pointer passed to policy
+ * @return status
+ */
+RDAI_Status RDAI_set_dispatch_policy( RDAI_DispatchPolicy policy, void *ctx )
+{
+    TRACE_SCOPE();
+    return impl.set_dispatch_policy( policy, ctx );
+}
+
+/**
+ * Get the latency and queue depth estimates of a device
+ *
+ * Estimates cover the runs dispatched to the device by RDAI_submit_by_vlnv
+ *
+ * @param device The device
+ * @param estimate The estimate to fill
+ * @return status (RDAI_REASON_NO_DEVICE if no run was submitted by VLNV for
+ *         the device)
+ */
+RDAI_Status RDAI_get_device_estimate( const RDAI_Device *device, RDAI_DeviceEstimate *estimate )
+{
+    TRACE_SCOPE();
+    return impl.get_device_estimate( device, estimate );
 }
 
 /**
  * Synchronize execution for an async call
  *
+ * A handle issued by the host runtime handle table can be synchronized once:
+ * synchronizing it again, or synchronizing a handle that was never issued,
+ * fails with RDAI_REASON_STALE_HANDLE
+ *
  * @param async_handle The handle to the async call to synchronize
  * @return status
  */
 RDAI_Status RDAI_sync( RDAI_AsyncHandle *async_handle )
 {
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_SYNC, NULL );
     return impl.sync( async_handle );
 }
 
+/**
+ * Synchronize execution for several async calls
+ *
+ * Blocks until every call has completed. All handles are synchronized, even
+ * when some calls fail
+ *
+ * @param async_handles An array of handles to the async calls to synchronize
+ * @param count The number of handles
+ * @return status (the status of the first failed call, if any)
+ */
+RDAI_Status RDAI_sync_all( RDAI_AsyncHandle *async_handles, size_t count )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_SYNC, NULL );
+    return impl.sync_all( async_handles, count );
+}
+
+/**
+ * Wait for any of several async calls to complete
+ *
+ * The completed call is synchronized and its status is returned. Handles
+ * that were already synchronized are skipped, so the same array can be
+ * passed again until every call has been retrieved; the call then fails
+ * with RDAI_REASON_STALE_HANDLE. Only handles issued by the host runtime
+ * (with a NULL platform) can be waited on
+ *
+ * @param async_handles An array of handles to the async calls to wait on
+ * @param count The number of handles
+ * @param timeout_us The maximum time to wait in microseconds (< 0 waits forever,
+ *                   0 only polls); RDAI_REASON_TIMEOUT is returned on expiry
+ * @param index The index in async_handles of the completed call (output)
+ * @return status of the completed call
+ */
+RDAI_Status RDAI_wait_any( RDAI_AsyncHandle *async_handles, size_t count, int64_t timeout_us, size_t *index )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_SYNC, NULL );
+    return impl.wait_any( async_handles, count, timeout_us, index );
+}
+
+/**
+ * Create a handle in the host runtime handle table
+ *
+ * Platforms use this to issue async handles whose completion is tracked by
+ * the host runtime instead of by the platform: the operation is reported
+ * finished with RDAI_async_handle_complete, and the application synchronizes
+ * it with RDAI_sync like any other handle. The handle platform is NULL
+ *
+ * @return status (with async handle), or RDAI_REASON_HANDLE_TABLE_FULL
+ */
+RDAI_Status RDAI_async_handle_create( void )
+{
+    TRACE_SCOPE();
+    return trace_submit( impl.async_handle_create() );
+}
+
+/**
+ * Complete a handle of the host runtime handle table
+ *
+ * Wakes up the threads synchronizing the handle, which receive status
+ *
+ * @param async_handle The handle to complete
+ * @param status The final status of the operation
+ * @return status (RDAI_REASON_STALE_HANDLE if the handle is not pending)
+ */
+RDAI_Status RDAI_async_handle_complete( const RDAI_AsyncHandle *async_handle, RDAI_Status status )
+{
+    TRACE_SCOPE();
+    return impl.async_handle_complete( async_handle, status );
+}
+
+/**
+ * Get the timeline of an async call
+ *
+ * Reports when the call was queued, submitted to its platform, started and
+ * ended on its device, and completed (see RDAI_HandleProfile), so that
+ * queueing delays can be told apart from execution time. The profile can
+ * be read while the call is pending and after it was synchronized, until
+ * the host runtime reuses the handle slot; read it right after RDAI_sync.
+ * Only handles issued by the host runtime (with a NULL platform) have a
+ * profile
+ *
+ * @param async_handle The handle of the async call
+ * @param profile The profile to fill
+ * @return status (RDAI_REASON_STALE_HANDLE if the handle was never issued
+ *         or its slot was reused)
+ */
+RDAI_Status RDAI_get_handle_profile( const RDAI_AsyncHandle *async_handle, RDAI_HandleProfile *profile )
+{
+    return impl.get_handle_profile( async_handle, profile );
+}
+
+/**
+ * Report when the device started and ended an async call
+ *
+ * Platforms that know when their device executed an operation (e.g. from
+ * device or driver timestamps) call this before completing it, with times
+ * converted to CLOCK_MONOTONIC nanoseconds. With a NULL handle, the times
+ * are those of the async call the calling thread executes for the host
+ * runtime: a device_run of the platform called for RDAI_device_run_async
+ * and similar calls reports its own execution this way, as does the sync
+ * of an operation started with device_run_async or mem_copy_async
+ *
+ * @param async_handle The handle of the call, or NULL
+ * @param started_ns When the device started the operation
+ * @param ended_ns When the device ended the operation
+ * @return status (RDAI_REASON_STALE_HANDLE if the call is not pending)
+ */
+RDAI_Status RDAI_set_handle_device_times( const RDAI_AsyncHandle *async_handle, uint64_t started_ns, uint64_t ended_ns )
+{
+    return impl.set_handle_device_times( async_handle, started_ns, ended_ns );
+}
+
+/**
+ * Create an in-order command queue bound to a device
+ *
+ * The commands of a queue execute one at a time, in submission order, and
+ * commands of different queues execute concurrently. A command is forwarded
+ * to the platform as soon as the previous command of its queue has completed
+ * and the events it waits on have been reached. Use separate queues (and
+ * events between them) to overlap transfers with device runs
+ *
+ * @param device The device the queue runs on
+ * @return The queue or NULL
+ */
+RDAI_Queue *RDAI_queue_create( RDAI_Device *device )
+{
+    TRACE_SCOPE();
+    return impl.queue_create( device );
+}
+
+/**
+ * Destroy a queue, once all the commands submitted to it have completed
+ *
+ * @param queue The queue to destroy
+ * @return status
+ */
+RDAI_Status RDAI_queue_destroy( RDAI_Queue *queue )
+{
+    TRACE_SCOPE();
+    return impl.queue_destroy( queue );
+}
+
+/**
+ * Submit a copy from a memory object to another to a queue
+ *
+ * The memory objects follow the rules of RDAI_mem_copy_async and must stay
+ * valid until the copy has completed
+ *
+ * @param queue The queue
+ * @param src The source memory object
+ * @param dest The destination memory object
+ * @return status (of the submission)
+ */
+RDAI_Status RDAI_queue_mem_copy( RDAI_Queue *queue, RDAI_MemObject *src, RDAI_MemObject *dest )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_MEM_COPY_ASYNC, copy_device( src, dest ) );
+    return impl.queue_mem_copy( queue, src, dest );
+}
+
+/**
+ * Submit a run of the queue device to a queue
+ *
+ * @param queue The queue
+ * @param mem_object_list A NULL-terminated list of memory object pointers
+ *                        (see RDAI_device_run), which must stay valid until
+ *                        the run has completed
+ * @return status (of the submission)
+ */
+RDAI_Status RDAI_queue_device_run( RDAI_Queue *queue, RDAI_MemObject **mem_object_list )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_DEVICE_RUN_ASYNC, NULL );
+    return impl.queue_device_run( queue, mem_object_list );
+}
+
+/**
+ * Record an event in a queue
+ *
+ * The event is reached once all the commands submitted to the queue before
+ * the record have completed. An event can be recorded again: waits refer to
+ * its last record at the time they are submitted
+ *
+ * @param queue The queue
+ * @param event The event to record
+ * @return status
+ */
+RDAI_Status RDAI_queue_record_event( RDAI_Queue *queue, RDAI_Event *event )
+{
+    TRACE_SCOPE();
+    return impl.queue_record_event( queue, event );
+}
+
+/**
+ * Make a queue wait for an event
+ *
+ * The commands submitted to the queue after the wait start once the last
+ * record of the event (at the time of the wait) is reached. Waiting on an
+ * event that was never recorded does not block
+ *
+ * @param queue The queue
+ * @param event The event to wait for
+ * @return status
+ */
+RDAI_Status RDAI_queue_wait_event( RDAI_Queue *queue, RDAI_Event *event )
+{
+    TRACE_SCOPE();
+    return impl.queue_wait_event( queue, event );
+}
+
+/**
+ * Wait for all the commands submitted to a queue
+ *
+ * @param queue The queue
+ * @return status (the status of the first command that failed since the
+ *         last RDAI_queue_sync, if any)
+ */
+RDAI_Status RDAI_queue_sync( RDAI_Queue *queue )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_SYNC, NULL );
+    return impl.queue_sync( queue );
+}
+
+/**
+ * Create an event
+ *
+ * @return The event or NULL
+ */
+RDAI_Event *RDAI_event_create( void )
+{
+    TRACE_SCOPE();
+    return impl.event_create();
+}
+
+/**
+ * Destroy an event
+ *
+ * Pending records and waits of the event are not affected
+ *
+ * @param event The event to destroy
+ * @return status
+ */
+RDAI_Status RDAI_event_destroy( RDAI_Event *event )
+{
+    TRACE_SCOPE();
+    return impl.event_destroy( event );
+}
+
+/**
+ * Wait for the last record of an event submitted so far
+ *
+ * @param event The event
+ * @return status
+ */
+RDAI_Status RDAI_event_sync( RDAI_Event *event )
+{
+    TRACE_SCOPE();
+    STATS_SCOPE( RDAI_STATS_SYNC, NULL );
+    return impl.event_sync( event );
+}
+
+/**
+ * Start capturing a graph on the calling thread
+ *
+ * Until RDAI_graph_end_capture, RDAI_mem_copy and RDAI_device_run calls made
+ * by this thread are validated and recorded into the graph instead of being
+ * executed, and return RDAI_STATUS_OK. Other calls are executed as usual
+ *
+ * @return status (RDAI_REASON_CAPTURE_ACTIVE if this thread is already capturing)
+ */
+RDAI_Status RDAI_graph_begin_capture( void )
+{
+    TRACE_SCOPE();
+    return impl.graph_begin_capture();
+}
+
+/**
+ * Stop capturing on the calling thread and get the captured graph
+ *
+ * @return The graph or NULL if this thread was not capturing
+ */
+RDAI_Graph *RDAI_graph_end_capture( void )
+{
+    TRACE_SCOPE();
+    return impl.graph_end_capture();
+}
+
+/**
+ * Execute the calls captured in a graph, in capture order
+ *
+ * The platform operations of the graph are resolved at capture time; a launch
+ * only checks that their platforms are still registered. Execution stops at
+ * the first call that fails and its status is returned
+ *
+ * @param graph The graph to launch
+ * @param bindings Memory objects to use in place of captured ones for this
+ *                 launch (or NULL)
+ * @param num_bindings The number of bindings
+ * @return status
+ */
+RDAI_Status RDAI_graph_launch( RDAI_Graph *graph, const RDAI_GraphBinding *bindings, size_t num_bindings )
+{
+    TRACE_SCOPE();
+    return impl.graph_launch( graph, bindings, num_bindings );
+}
+
+/**
+ * Destroy a graph
+ *
+ * @param graph The graph to destroy
+ * @return status
+ */
+RDAI_Status RDAI_graph_destroy( RDAI_Graph *graph )
+{
+    TRACE_SCOPE();
+    return impl.graph_destroy( graph );
+}
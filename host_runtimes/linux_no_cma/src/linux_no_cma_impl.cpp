@@ -16,13 +16,14 @@
  * under the License.
  */
 
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
-#include <map>
 #include <vector>
 #include <algorithm>
 
 #include "linux_no_cma_impl.h"
+#include "runtime_util.h"
 
 template <typename T>
 static T** convert_to_c_list( const std::vector<T *> &src )
@@ -59,36 +60,63 @@ static size_t get_size_of_c_list( T** c_list )
     return i;
 }
 
-static RDAI_Status make_status_error( RDAI_ErrorReason reason )
+// graph being captured by this thread (see RDAI_graph_begin_capture)
+static thread_local RDAI_Graph *capture_graph = NULL;
+
+static bool is_host_visible( const RDAI_MemObject *mem_object )
+{
+    return (mem_object->mem_type == RDAI_MemObjectType::RDAI_MEM_HOST) ||
+           (mem_object->mem_type == RDAI_MemObjectType::RDAI_MEM_SHARED);
+}
+
+static bool is_priority( RDAI_Priority priority )
+{
+    return (unsigned) priority < RDAI_NUM_PRIORITIES;
+}
+
+/**
+ * Get the RDAI_MEM_DEVICE memory object of a copy (src first), or NULL if the
+ * copy is between host-visible memory objects
+ */
+static RDAI_MemObject *get_device_mem_object( RDAI_MemObject *src, RDAI_MemObject *dest )
 {
-    RDAI_Status status;
-    status.status_code  = RDAI_StatusCode::RDAI_STATUS_ERROR;
-    status.error_reason = reason;
-    return status;
+    if( src->mem_type == RDAI_MemObjectType::RDAI_MEM_DEVICE ) return src;
+    if( dest->mem_type == RDAI_MemObjectType::RDAI_MEM_DEVICE ) return dest;
+    return NULL;
 }
 
-static RDAI_Status make_status_ok()
+static RDAI_Status check_host_copy( const RDAI_MemObject *src, const RDAI_MemObject *dest )
 {
-    RDAI_Status status;
-    status.status_code  = RDAI_StatusCode::RDAI_STATUS_OK;
-    return status;
+    if( !::is_host_visible( src ) || !::is_host_visible( dest ) ) {
+        return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+    }
+    if( dest->size < src->size ) {
+        return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_SIZE );
+    }
+    return make_status_ok();
 }
 
 RDAI_Platform** RDAI_Platform_Impl::get_all_platforms( void )
 {
+    RDAI_PROBE_SCOPE( get_all_platforms, NULL, 0 );
+    register_plugins();
     std::vector<RDAI_Platform *> ptfm_vector;
-    std::for_each( platform_to_ops.cbegin(), platform_to_ops.cend(), [&ptfm_vector]( const auto& p ) {
-                ptfm_vector.push_back( p.first );
+    PlatformRegistry::ReadGuard guard( registry );
+    registry.for_each( [&ptfm_vector]( const auto& e ) {
+                ptfm_vector.push_back( e.platform );
             });
     return ::convert_to_c_list<RDAI_Platform>( ptfm_vector );
 }
 
 RDAI_Platform** RDAI_Platform_Impl::get_platforms_with_type( const RDAI_PlatformType *platform_type )
 {
+    RDAI_PROBE_SCOPE( get_platforms_with_type, NULL, 0 );
     if( platform_type ) {
+        register_plugins();
         std::vector<RDAI_Platform *> ptfm_vector;
-        std::for_each( platform_to_ops.cbegin(), platform_to_ops.cend(), [&]( const auto& p ) {
-                    if( p.first->type == *platform_type ) ptfm_vector.push_back( p.first );
+        PlatformRegistry::ReadGuard guard( registry );
+        registry.for_each( [&]( const auto& e ) {
+                    if( e.platform->type == *platform_type ) ptfm_vector.push_back( e.platform );
                 });
         return ::convert_to_c_list<RDAI_Platform>( ptfm_vector );
     }
@@ -97,21 +125,30 @@ RDAI_Platform** RDAI_Platform_Impl::get_platforms_with_type( const RDAI_Platform
 
 RDAI_Platform** RDAI_Platform_Impl::get_platforms_with_property( const RDAI_Property *property )
 {
+    RDAI_PROBE_SCOPE( get_platforms_with_property, NULL, 0 );
     return NULL;
 }
 
 RDAI_Platform** RDAI_Platform_Impl::get_platforms_with_properties( const RDAI_Property **property_list )
 {
+    RDAI_PROBE_SCOPE( get_platforms_with_properties, NULL, 0 );
     return NULL;
 }
 
 RDAI_Platform* RDAI_Platform_Impl::get_platform_with_id( const RDAI_ID *id )
 {
+    RDAI_PROBE_SCOPE( get_platform_with_id, NULL, 0 );
+    if( id ) {
+        register_plugins();
+        PlatformRegistry::ReadGuard guard( registry );
+        return registry.find_platform( id->value );
+    }
     return NULL;
 }
 
 RDAI_Status RDAI_Platform_Impl::free_platform_list( RDAI_Platform **platform_list )
 {
+    RDAI_PROBE_SCOPE( free_platform_list, NULL, 0 );
     if( platform_list ) {
         free( platform_list );
         return ::make_status_ok();
@@ -121,6 +158,7 @@ RDAI_Status RDAI_Platform_Impl::free_platform_list( RDAI_Platform **platform_lis
 
 RDAI_Device** RDAI_Platform_Impl::get_all_devices( const RDAI_Platform *platform )
 {
+    RDAI_PROBE_PLATFORM_SCOPE( get_all_devices, platform );
     if( platform && platform->device_list ) {
         std::vector<RDAI_Device *> dev_vector;
         ::traverse_c_list<RDAI_Device>( platform->device_list, [&dev_vector](auto *p) {
@@ -134,6 +172,7 @@ RDAI_Device** RDAI_Platform_Impl::get_all_devices( const RDAI_Platform *platform
 RDAI_Device** RDAI_Platform_Impl::get_devices_with_vlnv( const RDAI_Platform *platform,
                                                          const RDAI_VLNV *vlnv )
 {
+    RDAI_PROBE_PLATFORM_SCOPE( get_devices_with_vlnv, platform );
     auto vlnv_comp = []( const auto &lhs, const auto &rhs ) -> bool {
         bool verdict = lhs.version == rhs.version;
         verdict = verdict && (strncmp( lhs.vendor.value, rhs.vendor.value, RDAI_STRING_ID_LENGTH ) == 0);
@@ -155,22 +194,26 @@ RDAI_Device** RDAI_Platform_Impl::get_devices_with_vlnv( const RDAI_Platform *pl
 RDAI_Device** RDAI_Platform_Impl::get_devices_with_property( const RDAI_Platform *platform,
                                                              const RDAI_Property *property )
 {
+    RDAI_PROBE_PLATFORM_SCOPE( get_devices_with_property, platform );
     return NULL;
 }
 
 RDAI_Device** RDAI_Platform_Impl::get_devices_with_properties( const RDAI_Platform *platform,
                                                                const RDAI_Property **property_list )
 {
+    RDAI_PROBE_PLATFORM_SCOPE( get_devices_with_properties, platform );
     return NULL;
 }
 
 RDAI_Device* RDAI_Platform_Impl::get_device_with_id( const RDAI_Platform *platform, const RDAI_ID *device_id )
 {
+    RDAI_PROBE_PLATFORM_SCOPE( get_device_with_id, platform );
     return NULL;
 }
 
 RDAI_Status RDAI_Platform_Impl::free_device_list( RDAI_Device **device_list )
 {
+    RDAI_PROBE_SCOPE( free_device_list, NULL, 0 );
     if( device_list ) {
         free( device_list );
     }
@@ -179,34 +222,34 @@ RDAI_Status RDAI_Platform_Impl::free_device_list( RDAI_Device **device_list )
 
 int RDAI_Platform_Impl::platform_has_property( const RDAI_Platform *platform, const RDAI_Property *property )
 {
+    RDAI_PROBE_PLATFORM_SCOPE( platform_has_property, platform );
     return 0;
 }
 
 int RDAI_Platform_Impl::platform_has_properties( const RDAI_Platform *platform, const RDAI_Property **property_list  )
 {
+    RDAI_PROBE_PLATFORM_SCOPE( platform_has_properties, platform );
     return 0;
 }
 
 int RDAI_Platform_Impl::device_has_property( const RDAI_Device *device, const RDAI_Property *property )
 {
+    RDAI_PROBE_SCOPE( device_has_property, device, 0 );
     return 0;
 }
 
 int RDAI_Platform_Impl::device_has_properties( const RDAI_Device *device, const RDAI_Property **property_list  )
 {
+    RDAI_PROBE_SCOPE( device_has_properties, device, 0 );
     return 0;
 }
 
 RDAI_Platform* RDAI_Platform_Impl::register_platform( RDAI_PlatformOps *platform_ops )
 {
+    RDAI_PROBE_SCOPE( register_platform, NULL, 0 );
     if( platform_ops ) {
-        RDAI_Platform *platform = ops_to_platform[platform_ops];
-        if( platform ) return platform;
-        platform = platform_ops->platform_create();
-        if( platform ) {
-            platform_to_ops[platform] = platform_ops;
-            ops_to_platform[platform_ops] = platform;
-        }
+        RDAI_Platform *platform = registry.add( platform_ops );
+        if( platform ) scheduler.platforms_changed();
         return platform;
     }
     return NULL;
@@ -214,11 +257,15 @@ RDAI_Platform* RDAI_Platform_Impl::register_platform( RDAI_PlatformOps *platform
 
 RDAI_Status RDAI_Platform_Impl::unregister_platform( RDAI_Platform *platform )
 {
+    RDAI_PROBE_PLATFORM_SCOPE( unregister_platform, platform );
     if( platform ) {
-        RDAI_PlatformOps *platform_ops = platform_to_ops[platform];
+        scheduler.remove_platform( platform );
+        RDAI_PlatformOps *platform_ops = registry.remove( platform );
+        // after remove: an initialization still in flight has recorded its
+        // latency, and a run its counters
+        inits.forget( platform );
+        profiler.remove_platform( platform );
         if( platform_ops ) {
-            platform_to_ops.erase( platform );
-            ops_to_platform.erase( platform_ops );
             return platform_ops->platform_destroy( platform );
         }
         else return ::make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
@@ -226,41 +273,72 @@ RDAI_Status RDAI_Platform_Impl::unregister_platform( RDAI_Platform *platform )
     return ::make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM );
 }
 
-RDAI_MemObject* RDAI_Platform_Impl::mem_host_allocate( size_t size )
+RDAI_Status RDAI_Platform_Impl::load_platform_plugin( const char *path )
 {
-    if( size ) {
-        RDAI_MemObject *mem_obj = (RDAI_MemObject *) malloc( sizeof( RDAI_MemObject ) );
-        if( mem_obj ) {
-            memset( mem_obj, 0, sizeof( RDAI_MemObject ) );
-            uint8_t *host_ptr = (uint8_t *) malloc( size );
-            if( host_ptr ) {
-                mem_obj->mem_type   = RDAI_MemObjectType::RDAI_MEM_HOST;
-                mem_obj->view_type  = RDAI_MemViewType::RDAI_VIEW_FULL;
-                mem_obj->device     = NULL;
-                mem_obj->parent     = NULL;
-                mem_obj->host_ptr   = host_ptr;
-                mem_obj->device_ptr = NULL;
-                mem_obj->size       = size;
-                mem_obj->flags      = 0;
-                mem_obj->user_tag   = NULL;
-            } else {
-                free( mem_obj );
-                mem_obj = NULL;
-            }
-        }
-        return mem_obj;
+    RDAI_PROBE_SCOPE( load_platform_plugin, NULL, 0 );
+    if( path ) {
+        if( plugins.load( path ) ) return ::make_status_ok();
+        return ::make_status_error( RDAI_ErrorReason::RDAI_REASON_PLUGIN_LOAD );
     }
-    return NULL;
+    return ::make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+/**
+ * Register the platforms of loaded plugins (RDAI_PLUGIN_PATH is scanned on
+ * the first call): platform_create is deferred until platforms are looked up
+ */
+void RDAI_Platform_Impl::register_plugins()
+{
+    plugins.scan();
+    plugins.register_pending( [this]( RDAI_PlatformOps *ops ) {
+                register_platform( ops );
+            });
+}
+
+RDAI_MemObject* RDAI_Platform_Impl::mem_host_allocate( size_t size )
+{
+    RDAI_PROBE_SCOPE( mem_host_allocate, NULL, size );
+    return mem_host_allocate_ex( size, 0 );
 }
 
 RDAI_MemObject* RDAI_Platform_Impl::mem_device_allocate( RDAI_Device *device, size_t size )
 {
+    RDAI_PROBE_SCOPE( mem_device_allocate, device, size );
     return NULL;
 }
 
 RDAI_MemObject* RDAI_Platform_Impl::mem_shared_allocate( size_t size )
 {
-    RDAI_MemObject *mem_obj = mem_host_allocate( size );
+    RDAI_PROBE_SCOPE( mem_shared_allocate, NULL, size );
+    return mem_shared_allocate_ex( size, 0 );
+}
+
+RDAI_MemObject* RDAI_Platform_Impl::mem_host_allocate_ex( size_t size, uint64_t flags )
+{
+    RDAI_PROBE_SCOPE( mem_host_allocate_ex, NULL, size );
+    const uint64_t known_flags = RDAI_MEM_FLAG_ALIGN_64 | RDAI_MEM_FLAG_ALIGN_4K | RDAI_MEM_FLAG_PINNED |
+                                 RDAI_MEM_FLAG_HUGE_PAGES | RDAI_MEM_FLAG_NUMA_BIND | RDAI_MEM_FLAG_NUMA_NODE_MASK;
+    if( size && !(flags & ~known_flags) ) {
+        RDAI_MemObject *mem_obj;
+        // pooled objects are always 64-byte aligned
+        if( flags & ~RDAI_MEM_FLAG_ALIGN_64 ) {
+            mem_obj = pool.allocate_mapped( size, flags );
+        } else {
+            mem_obj = pool.allocate( size );
+        }
+        if( mem_obj ) {
+            mem_obj->mem_type   = RDAI_MemObjectType::RDAI_MEM_HOST;
+            mem_obj->view_type  = RDAI_MemViewType::RDAI_VIEW_FULL;
+        }
+        return mem_obj;
+    }
+    return NULL;
+}
+
+RDAI_MemObject* RDAI_Platform_Impl::mem_shared_allocate_ex( size_t size, uint64_t flags )
+{
+    RDAI_PROBE_SCOPE( mem_shared_allocate_ex, NULL, size );
+    RDAI_MemObject *mem_obj = mem_host_allocate_ex( size, flags );
     if( mem_obj ) {
         mem_obj->mem_type = RDAI_MemObjectType::RDAI_MEM_SHARED;
     }
@@ -269,65 +347,293 @@ RDAI_MemObject* RDAI_Platform_Impl::mem_shared_allocate( size_t size )
 
 RDAI_Status RDAI_Platform_Impl::mem_free( RDAI_MemObject *mem_object )
 {
+    RDAI_PROBE_SCOPE( mem_free, mem_object ? mem_object->device : NULL, ::probe_size( mem_object ) );
     if( mem_object ) {
-        if( (mem_object->mem_type == RDAI_MemObjectType::RDAI_MEM_HOST) ||
-            (mem_object->mem_type == RDAI_MemObjectType::RDAI_MEM_SHARED) ) {
-            free( mem_object->host_ptr );
-            free( mem_object );
+        if( ::is_host_visible( mem_object ) && mem_object->view_type == RDAI_MemViewType::RDAI_VIEW_FULL ) {
+            pool.release( mem_object );
             return make_status_ok();
         }
     }
     return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
 }
 
+RDAI_Status RDAI_Platform_Impl::mem_pool_trim( void )
+{
+    RDAI_PROBE_SCOPE( mem_pool_trim, NULL, 0 );
+    pool.trim();
+    return make_status_ok();
+}
+
+RDAI_Status RDAI_Platform_Impl::mem_pool_get_stats( RDAI_MemPoolStats *stats )
+{
+    if( stats ) {
+        pool.get_stats( stats );
+        return make_status_ok();
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
 RDAI_Status RDAI_Platform_Impl::mem_copy( RDAI_MemObject *src, RDAI_MemObject *dest )
 {
-    return make_status_error( RDAI_ErrorReason::RDAI_REASON_UNIMPLEMENTED );
+    RDAI_PROBE_SCOPE( mem_copy, ::copy_device( src, dest ), ::probe_size( src ) );
+    if( src && dest ) {
+        RDAI_MemObject *device_mem = ::get_device_mem_object( src, dest );
+        if( device_mem ) {
+            if( !device_mem->device || !device_mem->device->platform ) {
+                return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+            }
+            PlatformRegistry::Pin pin( registry, device_mem->device->platform );
+            if( pin.ops ) {
+                if( capture_graph ) return capture_graph->add_device_copy( device_mem->device, pin.ops, src, dest );
+                RDAI_TRACE_SCOPE( tracer, "mem_copy", device_mem->device );
+                RDAI_FRAME_SCOPE( frames, FrameReport::OP_COPY );
+                return pin.ops->mem_copy( src, dest );
+            }
+            return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+        }
+
+        RDAI_Status status = ::check_host_copy( src, dest );
+        if( status.status_code == RDAI_StatusCode::RDAI_STATUS_OK ) {
+            if( capture_graph ) return capture_graph->add_host_copy( src, dest );
+            RDAI_FRAME_SCOPE( frames, FrameReport::OP_COPY );
+            copy_engine.copy( dest->host_ptr, src->host_ptr, src->size );
+        }
+        return status;
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
 }
 
 RDAI_Status RDAI_Platform_Impl::mem_copy_async( RDAI_MemObject *src, RDAI_MemObject *dest )
 {
-    return make_status_error( RDAI_ErrorReason::RDAI_REASON_UNIMPLEMENTED );
+    RDAI_PROBE_SCOPE( mem_copy_async, ::copy_device( src, dest ), ::probe_size( src ) );
+    return mem_copy_async_cb( src, dest, NULL, NULL );
+}
+
+RDAI_Status RDAI_Platform_Impl::mem_copy_async_prio( RDAI_MemObject *src, RDAI_MemObject *dest, RDAI_Priority priority )
+{
+    RDAI_PROBE_SCOPE( mem_copy_async_prio, ::copy_device( src, dest ), ::probe_size( src ) );
+    return mem_copy_async_cb( src, dest, NULL, NULL, priority );
+}
+
+RDAI_Status RDAI_Platform_Impl::mem_copy_async_cb( RDAI_MemObject *src, RDAI_MemObject *dest,
+                                                   RDAI_CompletionCallback callback, void *ctx,
+                                                   RDAI_Priority priority )
+{
+    RDAI_PROBE_SCOPE( mem_copy_async_cb, ::copy_device( src, dest ), ::probe_size( src ) );
+    if( !::is_priority( priority ) ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+    if( src && dest ) {
+        RDAI_MemObject *device_mem = ::get_device_mem_object( src, dest );
+        if( device_mem ) {
+            if( !device_mem->device || !device_mem->device->platform ) {
+                return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+            }
+            RDAI_Platform *platform = device_mem->device->platform;
+            bool native;
+            {
+                PlatformRegistry::ReadGuard guard( registry );
+                RDAI_PlatformOps *ops = registry.find_ops( platform );
+                if( !ops ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+                native = ops->mem_copy_async && ops->sync;
+            }
+            // executed in order with the runs of the device of the same
+            // priority, by the asynchronous copy of the platform or else
+            // by its synchronous copy
+            return native
+                ? executor.submit_started( device_mem->device, "mem_copy_async", src->size, [this, platform, src, dest]() {
+                          PlatformRegistry::Pin pin( registry, platform );
+                          if( !pin.ops ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+                          return pin.ops->mem_copy_async( src, dest );
+                      }, [this]( RDAI_AsyncHandle *async_handle ) {
+                          return sync_started( async_handle );
+                      }, callback, ctx, priority )
+                : executor.submit( device_mem->device, "mem_copy_async", src->size, [this, src, dest]() {
+                          return mem_copy( src, dest );
+                      }, callback, ctx, priority );
+        }
+
+        RDAI_Status status = ::check_host_copy( src, dest );
+        if( status.status_code == RDAI_StatusCode::RDAI_STATUS_OK ) {
+            uint32_t id = async_copy.submit( dest->host_ptr, src->host_ptr, src->size, callback, ctx, priority );
+            if( !id ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_HANDLE_TABLE_FULL );
+            return make_status_ok_async( id );
+        }
+        return status;
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
 }
 
 RDAI_MemObject* RDAI_Platform_Impl::mem_crop( RDAI_MemObject *src, size_t offset, size_t crop_size )
 {
-    return NULL;
+    RDAI_PROBE_SCOPE( mem_crop, src ? src->device : NULL, crop_size );
+    if( !src || !crop_size || offset > src->size || crop_size > src->size - offset ) return NULL;
+
+    if( src->mem_type == RDAI_MemObjectType::RDAI_MEM_DEVICE ) {
+        if( !src->device || !src->device->platform ) return NULL;
+        PlatformRegistry::ReadGuard guard( registry );
+        RDAI_PlatformOps *ops = registry.find_ops( src->device->platform );
+        return ops ? ops->mem_crop( src, offset, crop_size ) : NULL;
+    }
+    if( !::is_host_visible( src ) ) return NULL;
+
+    RDAI_MemObject *crop = (RDAI_MemObject *) malloc( sizeof(RDAI_MemObject) );
+    if( crop ) {
+        crop->mem_type   = src->mem_type;
+        crop->view_type  = RDAI_MemViewType::RDAI_VIEW_CROP;
+        crop->device     = src->device;
+        crop->parent     = src;
+        crop->host_ptr   = src->host_ptr + offset;
+        crop->device_ptr = src->device_ptr ? src->device_ptr + offset : NULL;
+        crop->size       = crop_size;
+        crop->user_tag   = src->user_tag;
+
+        // placement properties are inherited, alignment depends on the offset
+        crop->flags = src->flags & ~(RDAI_MEM_FLAG_ALIGN_64 | RDAI_MEM_FLAG_ALIGN_4K);
+        if( !((uintptr_t) crop->host_ptr & 63) ) crop->flags |= RDAI_MEM_FLAG_ALIGN_64;
+        if( !((uintptr_t) crop->host_ptr & 4095) ) crop->flags |= RDAI_MEM_FLAG_ALIGN_4K;
+    }
+    return crop;
 }
 
 RDAI_Status RDAI_Platform_Impl::mem_free_crop( RDAI_MemObject *mem_object )
 {
-    return make_status_error( RDAI_ErrorReason::RDAI_REASON_UNIMPLEMENTED );
+    RDAI_PROBE_SCOPE( mem_free_crop, mem_object ? mem_object->device : NULL, ::probe_size( mem_object ) );
+    if( mem_object && mem_object->view_type == RDAI_MemViewType::RDAI_VIEW_CROP ) {
+        if( mem_object->mem_type == RDAI_MemObjectType::RDAI_MEM_DEVICE ) {
+            if( !mem_object->device || !mem_object->device->platform ) {
+                return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+            }
+            PlatformRegistry::ReadGuard guard( registry );
+            RDAI_PlatformOps *ops = registry.find_ops( mem_object->device->platform );
+            if( ops ) {
+                return ops->mem_free_crop( mem_object );
+            }
+            return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+        }
+        if( ::is_host_visible( mem_object ) ) {
+            free( mem_object );
+            return make_status_ok();
+        }
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
 }
 
 RDAI_Status RDAI_Platform_Impl::platform_init( RDAI_Platform *platform, void *user_data )
 {
-    return make_status_error( RDAI_ErrorReason::RDAI_REASON_UNIMPLEMENTED );
+    RDAI_PROBE_PLATFORM_SCOPE( platform_init, platform );
+    if( platform ) {
+        // pinned rather than in a read-side section: loading a bitstream
+        // can take seconds, which would hold up every registry update
+        PlatformRegistry::Pin pin( registry, platform );
+        if( !pin.ops ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+        if( !pin.ops->platform_init ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_UNIMPLEMENTED );
+        auto start = std::chrono::steady_clock::now();
+        RDAI_Status status = pin.ops->platform_init( platform, user_data );
+        auto latency = std::chrono::steady_clock::now() - start;
+        inits.record( platform, (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>( latency ).count() );
+        return status;
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM );
 }
 
 RDAI_Status RDAI_Platform_Impl::platform_deinit( RDAI_Platform *platform, void *user_data )
 {
-    return make_status_error( RDAI_ErrorReason::RDAI_REASON_UNIMPLEMENTED );
+    RDAI_PROBE_PLATFORM_SCOPE( platform_deinit, platform );
+    if( platform ) {
+        PlatformRegistry::Pin pin( registry, platform );
+        if( !pin.ops ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+        if( !pin.ops->platform_deinit ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_UNIMPLEMENTED );
+        return pin.ops->platform_deinit( platform, user_data );
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM );
+}
+
+RDAI_Status RDAI_Platform_Impl::platform_init_async( RDAI_Platform *platform, void *user_data )
+{
+    RDAI_PROBE_PLATFORM_SCOPE( platform_init_async, platform );
+    if( platform ) {
+        {
+            PlatformRegistry::ReadGuard guard( registry );
+            if( !registry.find_ops( platform ) ) {
+                return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+            }
+        }
+        uint32_t id = inits.submit( "platform_init_async", [this, platform, user_data]() {
+                    return platform_init( platform, user_data );
+                });
+        if( !id ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_HANDLE_TABLE_FULL );
+        return make_status_ok_async( id );
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM );
+}
+
+RDAI_Status RDAI_Platform_Impl::get_platform_init_latency( const RDAI_Platform *platform, uint64_t *latency_ns )
+{
+    RDAI_PROBE_PLATFORM_SCOPE( get_platform_init_latency, platform );
+    if( platform && latency_ns ) {
+        if( inits.latency( platform, latency_ns ) ) return make_status_ok();
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
 }
 
 RDAI_Status RDAI_Platform_Impl::device_init( RDAI_Device *device, void *user_data )
 {
-    return make_status_error( RDAI_ErrorReason::RDAI_REASON_UNIMPLEMENTED );
+    RDAI_PROBE_SCOPE( device_init, device, 0 );
+    if( device && device->platform ) {
+        PlatformRegistry::Pin pin( registry, device->platform );
+        if( !pin.ops ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+        if( !pin.ops->device_init ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_UNIMPLEMENTED );
+        RDAI_TRACE_SCOPE( tracer, "device_init", device );
+        return pin.ops->device_init( device, user_data );
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
 }
 
 RDAI_Status RDAI_Platform_Impl::device_deinit( RDAI_Device *device, void *user_data )
 {
-    return make_status_error( RDAI_ErrorReason::RDAI_REASON_UNIMPLEMENTED );
+    RDAI_PROBE_SCOPE( device_deinit, device, 0 );
+    if( device && device->platform ) {
+        PlatformRegistry::Pin pin( registry, device->platform );
+        if( !pin.ops ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+        if( !pin.ops->device_deinit ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_UNIMPLEMENTED );
+        RDAI_TRACE_SCOPE( tracer, "device_deinit", device );
+        return pin.ops->device_deinit( device, user_data );
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::device_init_async( RDAI_Device *device, void *user_data )
+{
+    RDAI_PROBE_SCOPE( device_init_async, device, 0 );
+    if( device && device->platform ) {
+        {
+            PlatformRegistry::ReadGuard guard( registry );
+            if( !registry.find_ops( device->platform ) ) {
+                return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+            }
+        }
+        // on the lane of the device: async runs submitted after the init wait for it
+        return executor.submit( device, "device_init_async", 0, [this, device, user_data]() {
+                    return device_init( device, user_data );
+                });
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
 }
 
 RDAI_Status RDAI_Platform_Impl::device_run( RDAI_Device *device, RDAI_MemObject **mem_object_list )
 {
+    RDAI_PROBE_SCOPE( device_run, device, 0 );
     if( device && device->platform && mem_object_list ) {
         size_t num_els = ::get_size_of_c_list<RDAI_MemObject>( mem_object_list );
         if( num_els < 1 ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_BUFFER_COUNT );
-        RDAI_PlatformOps *ops = platform_to_ops[device->platform];
-        if( ops ) {
-            return ops->device_run( device, mem_object_list );
+        // pinned rather than read-locked: a run may last, and would hold up
+        // the registry updates of every other platform
+        PlatformRegistry::Pin pin( registry, device->platform );
+        if( pin.ops ) {
+            if( capture_graph ) return capture_graph->add_device_run( device->platform, pin.ops, device, mem_object_list, num_els );
+            RDAI_TRACE_SCOPE( tracer, "device_run", device );
+            RDAI_RUN_PROFILE_SCOPE( profiler, device );
+            RDAI_FRAME_SCOPE( frames, FrameReport::OP_RUN );
+            return pin.ops->device_run( device, mem_object_list );
         }
         return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
     }
@@ -336,26 +642,585 @@ RDAI_Status RDAI_Platform_Impl::device_run( RDAI_Device *device, RDAI_MemObject
 
 RDAI_Status RDAI_Platform_Impl::device_run_async( RDAI_Device *device, RDAI_MemObject **mem_object_list )
 {
-    if( device && device->platform && mem_object_list ) {
+    RDAI_PROBE_SCOPE( device_run_async, device, 0 );
+    return device_run_async_cb( device, mem_object_list, NULL, NULL );
+}
+
+RDAI_Status RDAI_Platform_Impl::device_run_async_prio( RDAI_Device *device, RDAI_MemObject **mem_object_list,
+                                                       RDAI_Priority priority )
+{
+    RDAI_PROBE_SCOPE( device_run_async_prio, device, 0 );
+    return device_run_async_cb( device, mem_object_list, NULL, NULL, priority );
+}
+
+RDAI_Status RDAI_Platform_Impl::device_run_async_cb( RDAI_Device *device, RDAI_MemObject **mem_object_list,
+                                                     RDAI_CompletionCallback callback, void *ctx,
+                                                     RDAI_Priority priority )
+{
+    RDAI_PROBE_SCOPE( device_run_async_cb, device, 0 );
+    if( device && device->platform && mem_object_list && ::is_priority( priority ) ) {
         size_t num_els = ::get_size_of_c_list<RDAI_MemObject>( mem_object_list );
         if( num_els < 1 ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_BUFFER_COUNT );
-        RDAI_PlatformOps *ops = platform_to_ops[device->platform];
-        if( ops ) {
-            return ops->device_run_async( device, mem_object_list );
+        bool native;
+        {
+            PlatformRegistry::ReadGuard guard( registry );
+            RDAI_PlatformOps *ops = registry.find_ops( device->platform );
+            if( !ops ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+            native = ops->device_run_async && ops->sync;
         }
-        return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+        // started by the asynchronous run of the platform, or else executed
+        // by its synchronous run on the device thread
+        return native
+            ? executor.submit_started( device, "device_run_async", 0, [this, device, mem_object_list]() {
+                      PlatformRegistry::Pin pin( registry, device->platform );
+                      if( !pin.ops ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+                      RDAI_TRACE_SCOPE( tracer, "device_run_async", device );
+                      RDAI_RUN_PROFILE_SCOPE( profiler, device );
+                      return pin.ops->device_run_async( device, mem_object_list );
+                  }, [this]( RDAI_AsyncHandle *async_handle ) {
+                      return sync_started( async_handle );
+                  }, callback, ctx, priority )
+            : executor.submit( device, "device_run_async", 0, [this, device, mem_object_list]() {
+                      return device_run( device, mem_object_list );
+                  }, callback, ctx, priority );
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::get_queue_wait_stats( RDAI_Priority priority, RDAI_QueueWaitStats *stats )
+{
+    if( stats && ::is_priority( priority ) ) {
+        wait_stats.get( priority, stats );
+        return make_status_ok();
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::reset_queue_wait_stats( void )
+{
+    wait_stats.reset();
+    return make_status_ok();
+}
+
+RDAI_Status RDAI_Platform_Impl::set_backpressure( RDAI_Backpressure mode )
+{
+    if( mode != RDAI_BACKPRESSURE_BLOCK && mode != RDAI_BACKPRESSURE_BUSY ) {
+        return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+    }
+    executor.set_backpressure( mode );
+    return make_status_ok();
+}
+
+RDAI_Status RDAI_Platform_Impl::get_stats( RDAI_StatsOp op, const RDAI_Device *device, RDAI_OpStats *op_stats )
+{
+#ifdef RDAI_ENABLE_STATS
+    if( op_stats && op >= 0 && op < RDAI_NUM_STATS_OPS ) {
+        stats.get( op, device, op_stats );
+        return make_status_ok();
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+#else
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_UNIMPLEMENTED );
+#endif // RDAI_ENABLE_STATS
+}
+
+RDAI_Status RDAI_Platform_Impl::reset_stats( void )
+{
+#ifdef RDAI_ENABLE_STATS
+    stats.reset();
+    return make_status_ok();
+#else
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_UNIMPLEMENTED );
+#endif // RDAI_ENABLE_STATS
+}
+
+RDAI_Status RDAI_Platform_Impl::dump_stats( const char *path )
+{
+#ifdef RDAI_ENABLE_STATS
+    if( path ) {
+        if( stats.dump( path ) ) return make_status_ok();
+        return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+#else
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_UNIMPLEMENTED );
+#endif // RDAI_ENABLE_STATS
+}
+
+RDAI_Status RDAI_Platform_Impl::trace_flush( void )
+{
+    if( !tracer.active() ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_UNIMPLEMENTED );
+    if( tracer.flush() ) return make_status_ok();
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::set_run_counters( int enable )
+{
+    profiler.set_enabled( enable != 0 );
+    return make_status_ok();
+}
+
+RDAI_Status RDAI_Platform_Impl::get_run_counters( const RDAI_Device *device, const RDAI_VLNV *vlnv,
+                                                  RDAI_RunCounters *counters )
+{
+    if( counters ) {
+        profiler.get( device, vlnv, counters );
+        return make_status_ok();
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::reset_run_counters( void )
+{
+    profiler.reset();
+    return make_status_ok();
+}
+
+RDAI_Status RDAI_Platform_Impl::frame_begin( uint64_t frame_id )
+{
+    if( frames.begin( frame_id ) ) return make_status_ok();
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::frame_select( uint64_t frame_id )
+{
+    if( frames.select( frame_id ) ) return make_status_ok();
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::frame_end( uint64_t frame_id )
+{
+    if( frames.end( frame_id ) ) return make_status_ok();
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::get_frame_stats( RDAI_FrameStage stage, RDAI_OpStats *stats )
+{
+    if( stats && stage >= 0 && stage < RDAI_NUM_FRAME_STAGES ) {
+        frames.get( stage, stats );
+        return make_status_ok();
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::reset_frame_stats( void )
+{
+    frames.reset();
+    return make_status_ok();
+}
+
+RDAI_Status RDAI_Platform_Impl::dump_frame_report( const char *path )
+{
+    if( path && frames.dump( path ) ) return make_status_ok();
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::device_run_batch( RDAI_Device *device, RDAI_MemObject ***mem_object_lists, size_t count )
+{
+    RDAI_PROBE_SCOPE( device_run_batch, device, 0 );
+    if( device && device->platform && mem_object_lists && count ) {
+        for( size_t i = 0; i < count; i++ ) {
+            if( ::get_size_of_c_list<RDAI_MemObject>( mem_object_lists[i] ) < 1 ) {
+                return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_BUFFER_COUNT );
+            }
+        }
+        {
+            PlatformRegistry::ReadGuard guard( registry );
+            if( !registry.find_ops( device->platform ) ) {
+                return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+            }
+        }
+        return executor.submit( device, "device_run_batch", 0, [this, device, mem_object_lists, count]() {
+                    return run_batch( device, mem_object_lists, count );
+                }, NULL, NULL );
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::run_batch( RDAI_Device *device, RDAI_MemObject ***mem_object_lists, size_t count )
+{
+    RDAI_PROBE_SCOPE( run_batch, device, 0 );
+    PlatformRegistry::Pin pin( registry, device->platform );
+    RDAI_PlatformOps *ops = pin.ops;
+    if( !ops ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+    RDAI_TRACE_SCOPE( tracer, "device_run_batch", device );
+    if( ops->device_run_batch ) {
+        RDAI_RUN_PROFILE_BATCH_SCOPE( profiler, device, count );
+        return ops->device_run_batch( device, mem_object_lists, count );
+    }
+    for( size_t i = 0; i < count; i++ ) {
+        RDAI_RUN_PROFILE_SCOPE( profiler, device );
+        RDAI_Status status = ops->device_run( device, mem_object_lists[i] );
+        if( status.status_code != RDAI_StatusCode::RDAI_STATUS_OK ) return status;
+    }
+    return make_status_ok();
+}
+
+RDAI_Launch* RDAI_Platform_Impl::launch_create( RDAI_Device *device, RDAI_MemObject **mem_objects, size_t count )
+{
+    RDAI_PROBE_SCOPE( launch_create, device, 0 );
+    if( !device || !device->platform || !mem_objects || count < 1 ) return NULL;
+    for( size_t i = 0; i < count; i++ ) {
+        if( !mem_objects[i] ) return NULL;
+    }
+    PlatformRegistry::ReadGuard guard( registry );
+    RDAI_PlatformOps *ops = registry.find_ops( device->platform );
+    if( !ops ) return NULL;
+
+    RDAI_Launch *launch = new RDAI_Launch;
+    launch->device = device;
+    launch->ops    = ops;
+    launch->mem_object_list.assign( mem_objects, mem_objects + count );
+    launch->mem_object_list.push_back( NULL );
+    return launch;
+}
+
+RDAI_Status RDAI_Platform_Impl::launch_destroy( RDAI_Launch *launch )
+{
+    RDAI_PROBE_SCOPE( launch_destroy, launch ? launch->device : NULL, 0 );
+    if( launch ) {
+        delete launch;
+        return make_status_ok();
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::launch_run( RDAI_Launch *launch )
+{
+    RDAI_PROBE_SCOPE( launch_run, launch->device, 0 );
+    if( capture_graph ) {
+        return capture_graph->add_device_run( launch->device->platform, launch->ops, launch->device,
+                                              launch->mem_object_list.data(), launch->mem_object_list.size() - 1 );
+    }
+    RDAI_TRACE_SCOPE( tracer, "device_run", launch->device );
+    RDAI_RUN_PROFILE_SCOPE( profiler, launch->device );
+    RDAI_FRAME_SCOPE( frames, FrameReport::OP_RUN );
+    return launch->ops->device_run( launch->device, launch->mem_object_list.data() );
+}
+
+RDAI_Status RDAI_Platform_Impl::launch_run_async( RDAI_Launch *launch )
+{
+    RDAI_PROBE_SCOPE( launch_run_async, launch->device, 0 );
+    return executor.submit( launch->device, "launch_run_async", 0, [this, launch]() {
+                RDAI_TRACE_SCOPE( tracer, "device_run", launch->device );
+                RDAI_RUN_PROFILE_SCOPE( profiler, launch->device );
+                return launch->ops->device_run( launch->device, launch->mem_object_list.data() );
+            }, NULL, NULL );
+}
+
+RDAI_Status RDAI_Platform_Impl::submit_by_vlnv( const RDAI_VLNV *vlnv, RDAI_MemObject **mem_object_list )
+{
+    RDAI_PROBE_SCOPE( submit_by_vlnv, NULL, 0 );
+    if( vlnv && mem_object_list ) {
+        size_t num_els = ::get_size_of_c_list<RDAI_MemObject>( mem_object_list );
+        if( num_els < 1 ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_BUFFER_COUNT );
+        register_plugins();
+        return scheduler.submit( vlnv, mem_object_list );
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::set_dispatch_policy( RDAI_DispatchPolicy policy, void *ctx )
+{
+    RDAI_PROBE_SCOPE( set_dispatch_policy, NULL, 0 );
+    scheduler.set_policy( policy, ctx );
+    return make_status_ok();
+}
+
+RDAI_Status RDAI_Platform_Impl::get_device_estimate( const RDAI_Device *device, RDAI_DeviceEstimate *estimate )
+{
+    RDAI_PROBE_SCOPE( get_device_estimate, device, 0 );
+    if( device && estimate ) {
+        if( scheduler.get_estimate( device, estimate ) ) return make_status_ok();
+        return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_DEVICE );
     }
     return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
 }
 
 RDAI_Status RDAI_Platform_Impl::sync( RDAI_AsyncHandle *async_handle )
 {
-    if( async_handle && async_handle->platform ) {
-        RDAI_PlatformOps *ops = platform_to_ops[async_handle->platform];
-        if( ops ) {
-            return ops->sync( async_handle );
+    RDAI_PROBE_HANDLE_SCOPE( sync, async_handle );
+    if( async_handle ) {
+        // handles issued by the host runtime have no platform
+        if( !async_handle->platform ) {
+            RDAI_Status status;
+            uint64_t sync_start_ns = frames.waiting() ? CompletionTable::profile_clock_ns() : 0;
+            if( completions.wait( async_handle->id.value, &status ) ) {
+                tracer.flow_end( async_handle->id.value );
+                if( sync_start_ns ) frames.synced( async_handle->id.value, sync_start_ns );
+                return status;
+            }
+            return make_status_error( RDAI_ErrorReason::RDAI_REASON_STALE_HANDLE );
+        }
+        PlatformRegistry::Pin pin( registry, async_handle->platform );
+        if( pin.ops ) {
+            return pin.ops->sync( async_handle );
         }
         return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
     }
     return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
 }
+
+RDAI_Status RDAI_Platform_Impl::sync_started( RDAI_AsyncHandle *async_handle )
+{
+    // operations started on a platform may still hand back a handle of the
+    // host runtime (see RDAI_async_handle_create)
+    if( !async_handle->platform ) {
+        RDAI_Status status;
+        if( completions.wait( async_handle->id.value, &status ) ) return status;
+        return make_status_error( RDAI_ErrorReason::RDAI_REASON_STALE_HANDLE );
+    }
+    // pinned rather than read-locked: the wait may last, and the platform
+    // must not be unregistered before it ends
+    PlatformRegistry::Pin pin( registry, async_handle->platform );
+    if( !pin.ops ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+    return pin.ops->sync( async_handle );
+}
+
+RDAI_Status RDAI_Platform_Impl::sync_all( RDAI_AsyncHandle *async_handles, size_t count )
+{
+    RDAI_PROBE_SCOPE( sync_all, NULL, 0 );
+    if( async_handles || !count ) {
+        RDAI_Status result = make_status_ok();
+        bool failed = false;
+        for( size_t i = 0; i < count; i++ ) {
+            RDAI_Status status = sync( &async_handles[i] );
+            if( !failed && status.status_code != RDAI_StatusCode::RDAI_STATUS_OK ) {
+                result = status;
+                failed = true;
+            }
+        }
+        return result;
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::wait_any( RDAI_AsyncHandle *async_handles, size_t count, int64_t timeout_us,
+                                          size_t *index )
+{
+    RDAI_PROBE_SCOPE( wait_any, NULL, 0 );
+    if( async_handles && count && index ) {
+        uint32_t local_ids[64];
+        std::vector<uint32_t> heap_ids;
+        uint32_t *ids = local_ids;
+        if( count > 64 ) {
+            heap_ids.resize( count );
+            ids = heap_ids.data();
+        }
+        for( size_t i = 0; i < count; i++ ) {
+            if( async_handles[i].platform ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+            ids[i] = async_handles[i].id.value;
+        }
+
+        RDAI_Status status;
+        uint64_t sync_start_ns = frames.waiting() ? CompletionTable::profile_clock_ns() : 0;
+        switch( completions.wait_any( ids, count, timeout_us, index, &status ) ) {
+        case CompletionTable::WAIT_COMPLETED:
+            tracer.flow_end( ids[*index] );
+            if( sync_start_ns ) frames.synced( ids[*index], sync_start_ns );
+            return status;
+        case CompletionTable::WAIT_TIMEOUT:
+            return make_status_error( RDAI_ErrorReason::RDAI_REASON_TIMEOUT );
+        case CompletionTable::WAIT_STALE:
+            return make_status_error( RDAI_ErrorReason::RDAI_REASON_STALE_HANDLE );
+        }
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Queue* RDAI_Platform_Impl::queue_create( RDAI_Device *device )
+{
+    RDAI_PROBE_SCOPE( queue_create, device, 0 );
+    if( device && device->platform ) {
+        PlatformRegistry::ReadGuard guard( registry );
+        if( registry.find_ops( device->platform ) ) return queues.create_queue( device );
+    }
+    return NULL;
+}
+
+RDAI_Status RDAI_Platform_Impl::queue_destroy( RDAI_Queue *queue )
+{
+    RDAI_PROBE_SCOPE( queue_destroy, queue ? queue->device : NULL, 0 );
+    if( queue ) {
+        queues.destroy_queue( queue );
+        return make_status_ok();
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::queue_mem_copy( RDAI_Queue *queue, RDAI_MemObject *src, RDAI_MemObject *dest )
+{
+    RDAI_PROBE_SCOPE( queue_mem_copy, ::copy_device( src, dest ), ::probe_size( src ) );
+    if( queue && src && dest ) {
+        RDAI_MemObject *device_mem = ::get_device_mem_object( src, dest );
+        if( device_mem ) {
+            if( !device_mem->device || !device_mem->device->platform ) {
+                return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+            }
+            queues.submit_device( queue, device_mem->device, FrameReport::OP_COPY, [this, src, dest]() {
+                        return mem_copy( src, dest );
+                    });
+            return make_status_ok();
+        }
+
+        RDAI_Status status = ::check_host_copy( src, dest );
+        if( status.status_code == RDAI_StatusCode::RDAI_STATUS_OK ) {
+            queues.submit_host_copy( queue, dest->host_ptr, src->host_ptr, src->size );
+        }
+        return status;
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::queue_device_run( RDAI_Queue *queue, RDAI_MemObject **mem_object_list )
+{
+    RDAI_PROBE_SCOPE( queue_device_run, queue ? queue->device : NULL, 0 );
+    if( queue && mem_object_list ) {
+        size_t num_els = ::get_size_of_c_list<RDAI_MemObject>( mem_object_list );
+        if( num_els < 1 ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_BUFFER_COUNT );
+        RDAI_Device *device = queue->device;
+        queues.submit_device( queue, device, FrameReport::OP_RUN, [this, device, mem_object_list]() {
+                    return device_run( device, mem_object_list );
+                });
+        return make_status_ok();
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::queue_record_event( RDAI_Queue *queue, RDAI_Event *event )
+{
+    RDAI_PROBE_SCOPE( queue_record_event, queue ? queue->device : NULL, 0 );
+    if( queue && event ) {
+        queues.record( queue, event );
+        return make_status_ok();
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::queue_wait_event( RDAI_Queue *queue, RDAI_Event *event )
+{
+    RDAI_PROBE_SCOPE( queue_wait_event, queue ? queue->device : NULL, 0 );
+    if( queue && event ) {
+        queues.wait( queue, event );
+        return make_status_ok();
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::queue_sync( RDAI_Queue *queue )
+{
+    RDAI_PROBE_SCOPE( queue_sync, queue ? queue->device : NULL, 0 );
+    if( queue ) {
+        RDAI_Status error;
+        if( queues.sync( queue, &error ) ) return make_status_ok();
+        return error;
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Event* RDAI_Platform_Impl::event_create( void )
+{
+    RDAI_PROBE_SCOPE( event_create, NULL, 0 );
+    RDAI_Event *event = new RDAI_Event;
+    event->state = std::make_shared<QueueEventState>();
+    return event;
+}
+
+RDAI_Status RDAI_Platform_Impl::event_destroy( RDAI_Event *event )
+{
+    RDAI_PROBE_SCOPE( event_destroy, NULL, 0 );
+    if( event ) {
+        delete event;
+        return make_status_ok();
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::event_sync( RDAI_Event *event )
+{
+    RDAI_PROBE_SCOPE( event_sync, NULL, 0 );
+    if( event ) {
+        queues.sync_event( event );
+        return make_status_ok();
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::async_handle_create( void )
+{
+    RDAI_PROBE_SCOPE( async_handle_create, NULL, 0 );
+    uint32_t id = completions.create();
+    if( id ) {
+        // the platform issuing the handle has the operation already
+        completions.mark_submitted( id );
+        RDAI_PROBE_SUBMIT( id, NULL, 0 );
+        return make_status_ok_async( id );
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_HANDLE_TABLE_FULL );
+}
+
+RDAI_Status RDAI_Platform_Impl::async_handle_complete( const RDAI_AsyncHandle *async_handle, RDAI_Status status )
+{
+    RDAI_PROBE_HANDLE_SCOPE( async_handle_complete, async_handle );
+    if( async_handle && !async_handle->platform ) {
+        if( completions.complete( async_handle->id.value, status ) ) return make_status_ok();
+        return make_status_error( RDAI_ErrorReason::RDAI_REASON_STALE_HANDLE );
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::get_handle_profile( const RDAI_AsyncHandle *async_handle, RDAI_HandleProfile *profile )
+{
+    if( async_handle && !async_handle->platform && profile ) {
+        if( completions.get_profile( async_handle->id.value, profile ) ) return make_status_ok();
+        return make_status_error( RDAI_ErrorReason::RDAI_REASON_STALE_HANDLE );
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::set_handle_device_times( const RDAI_AsyncHandle *async_handle, uint64_t started_ns,
+                                                         uint64_t ended_ns )
+{
+    if( (!async_handle || !async_handle->platform) && started_ns && started_ns <= ended_ns ) {
+        if( completions.set_device_times( async_handle ? async_handle->id.value : 0, started_ns, ended_ns ) ) {
+            return make_status_ok();
+        }
+        return make_status_error( RDAI_ErrorReason::RDAI_REASON_STALE_HANDLE );
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::graph_begin_capture( void )
+{
+    RDAI_PROBE_SCOPE( graph_begin_capture, NULL, 0 );
+    if( capture_graph ) return make_status_error( RDAI_ErrorReason::RDAI_REASON_CAPTURE_ACTIVE );
+    capture_graph = new RDAI_Graph;
+    return make_status_ok();
+}
+
+RDAI_Graph* RDAI_Platform_Impl::graph_end_capture( void )
+{
+    RDAI_PROBE_SCOPE( graph_end_capture, NULL, 0 );
+    RDAI_Graph *graph = capture_graph;
+    capture_graph = NULL;
+    return graph;
+}
+
+RDAI_Status RDAI_Platform_Impl::graph_launch( RDAI_Graph *graph, const RDAI_GraphBinding *bindings, size_t num_bindings )
+{
+    RDAI_PROBE_SCOPE( graph_launch, NULL, 0 );
+    if( graph && (bindings || !num_bindings) ) {
+        return graph->launch( bindings, num_bindings, copy_engine, registry, tracer, profiler, frames );
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
+
+RDAI_Status RDAI_Platform_Impl::graph_destroy( RDAI_Graph *graph )
+{
+    RDAI_PROBE_SCOPE( graph_destroy, NULL, 0 );
+    if( graph ) {
+        delete graph;
+        return make_status_ok();
+    }
+    return make_status_error( RDAI_ErrorReason::RDAI_REASON_INVALID_OBJECT );
+}
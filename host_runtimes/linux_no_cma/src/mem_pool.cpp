@@ -0,0 +1,454 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "mem_pool.h"
+
+#define MEM_POOL_ALIGNMENT          64
+#define MEM_POOL_CACHE_BYTES        (4u << 20)      // per class and thread
+#define MEM_POOL_CACHE_MAX_COUNT    64
+#define MEM_POOL_HUGE_PAGE_SIZE     (2u << 20)      // when /proc/meminfo does not tell
+
+// from <numaif.h>, so that libnuma is not required
+#define MEM_POOL_MPOL_BIND          2
+#define MEM_POOL_MPOL_MF_STRICT     (1 << 0)
+#define MEM_POOL_MAX_NUMA_NODES     1024
+
+struct MemPool::Block
+{
+    uint32_t size_class;
+    size_t payload_size;
+    Block *next;
+    void *mapping;
+    size_t mapping_size;
+    RDAI_MemObject object;
+};
+
+static const size_t BLOCK_HEADER_SIZE =
+    (sizeof( MemPool::Block ) + MEM_POOL_ALIGNMENT - 1) & ~(size_t)(MEM_POOL_ALIGNMENT - 1);
+
+static inline MemPool::Block *block_of( const RDAI_MemObject *mem_object )
+{
+    return (MemPool::Block *)( (uintptr_t) mem_object - offsetof( MemPool::Block, object ) );
+}
+
+static inline uint8_t *payload_of( MemPool::Block *block )
+{
+    return (uint8_t *) block + BLOCK_HEADER_SIZE;
+}
+
+static inline uint32_t cache_capacity( size_t size_class )
+{
+    size_t n = MEM_POOL_CACHE_BYTES / MemPool::class_to_size( size_class );
+    if( n > MEM_POOL_CACHE_MAX_COUNT ) n = MEM_POOL_CACHE_MAX_COUNT;
+    return n ? (uint32_t) n : 1;
+}
+
+// counters of a thread cache are only written by their owning thread
+template <typename T>
+static inline void bump( std::atomic<T> &counter, T delta )
+{
+    counter.store( counter.load( std::memory_order_relaxed ) + delta, std::memory_order_relaxed );
+}
+
+struct MemPoolThreadCache
+{
+    struct Bin
+    {
+        MemPool::Block *head;
+        uint32_t count;
+    };
+
+    MemPool *pool;
+    Bin bins[MEM_POOL_NUM_CLASSES];
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> bytes_held;
+    std::atomic<int64_t> bytes_in_use;
+    MemPoolThreadCache *prev;
+    MemPoolThreadCache *next;
+
+    ~MemPoolThreadCache()
+    {
+        if( pool ) pool->retire_cache( this );
+    }
+};
+
+static thread_local MemPoolThreadCache tls_cache;
+
+size_t MemPool::size_to_class( size_t size )
+{
+    if( size <= MEM_POOL_MIN_CLASS_SIZE ) return 0;
+    // 2^p < size <= 2^(p+1), split into 4 sub-classes
+    unsigned p   = 63 - __builtin_clzll( (unsigned long long)( size - 1 ) );
+    size_t sub   = ((size - 1) >> (p - 2)) & 3;
+    return (p - 6) * 4 + sub + 1;
+}
+
+size_t MemPool::class_to_size( size_t size_class )
+{
+    if( size_class == 0 ) return MEM_POOL_MIN_CLASS_SIZE;
+    size_t p   = (size_class - 1) / 4 + 6;
+    size_t sub = (size_class - 1) % 4;
+    return ((size_t) 1 << p) + (sub + 1) * ((size_t) 1 << (p - 2));
+}
+
+MemPoolThreadCache* MemPool::local_cache()
+{
+    MemPoolThreadCache *cache = &tls_cache;
+    if( cache->pool == this ) return cache;
+    if( cache->pool ) return nullptr;
+
+    cache->pool = this;
+    std::lock_guard<std::mutex> lock( caches_lock );
+    cache->prev = nullptr;
+    cache->next = caches;
+    if( caches ) caches->prev = cache;
+    caches = cache;
+    return cache;
+}
+
+MemPool::Block* MemPool::new_block( size_t size_class, size_t size )
+{
+    size_t alloc_size = (BLOCK_HEADER_SIZE + size + MEM_POOL_ALIGNMENT - 1) & ~(size_t)(MEM_POOL_ALIGNMENT - 1);
+    Block *block = (Block *) aligned_alloc( MEM_POOL_ALIGNMENT, alloc_size );
+    if( block ) {
+        block->size_class   = (uint32_t) size_class;
+        block->payload_size = size;
+        block->next         = nullptr;
+        block->mapping      = nullptr;
+        block->mapping_size = 0;
+    }
+    return block;
+}
+
+void MemPool::delete_block( Block *block )
+{
+    if( block->size_class == MEM_POOL_MAPPED_CLASS ) {
+        munmap( block->mapping, block->mapping_size );
+    }
+    free( block );
+}
+
+// the default size of MAP_HUGETLB pages, which mmap and munmap lengths
+// must be multiples of
+static size_t huge_page_size()
+{
+    static const size_t size = []() {
+        size_t kib = 0;
+        FILE *f = fopen( "/proc/meminfo", "r" );
+        if( f ) {
+            char line[128];
+            while( fgets( line, sizeof( line ), f ) ) {
+                if( sscanf( line, "Hugepagesize: %zu kB", &kib ) == 1 ) break;
+            }
+            fclose( f );
+        }
+        return kib ? kib << 10 : (size_t) MEM_POOL_HUGE_PAGE_SIZE;
+    }();
+    return size;
+}
+
+static bool bind_to_numa_node( void *addr, size_t length, uint32_t node )
+{
+    if( node >= MEM_POOL_MAX_NUMA_NODES ) return false;
+    unsigned long nodemask[MEM_POOL_MAX_NUMA_NODES / (8 * sizeof( unsigned long ))] = { 0 };
+    nodemask[node / (8 * sizeof( unsigned long ))] |= 1ul << (node % (8 * sizeof( unsigned long )));
+    return syscall( SYS_mbind, addr, length, MEM_POOL_MPOL_BIND, nodemask,
+                    (unsigned long) MEM_POOL_MAX_NUMA_NODES, MEM_POOL_MPOL_MF_STRICT ) == 0;
+}
+
+RDAI_MemObject* MemPool::allocate_mapped( size_t size, uint64_t flags )
+{
+    uint64_t granted = RDAI_MEM_FLAG_ALIGN_64 | RDAI_MEM_FLAG_ALIGN_4K;
+    size_t page_size = (size_t) sysconf( _SC_PAGESIZE );
+    size_t length = (size + page_size - 1) & ~(page_size - 1);
+    void *mapping = MAP_FAILED;
+
+    if( flags & RDAI_MEM_FLAG_HUGE_PAGES ) {
+        size_t huge_page = huge_page_size();
+        size_t huge_length = (size + huge_page - 1) & ~(huge_page - 1);
+        mapping = mmap( NULL, huge_length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+        if( mapping != MAP_FAILED ) {
+            length = huge_length;
+            granted |= RDAI_MEM_FLAG_HUGE_PAGES;
+        } else {
+            // no reserved huge pages: ask for transparent huge pages instead,
+            // which the kernel may or may not use (the flag is not granted)
+            mapping = mmap( NULL, huge_length, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+            if( mapping != MAP_FAILED ) {
+                length = huge_length;
+                madvise( mapping, length, MADV_HUGEPAGE );
+            }
+        }
+    } else {
+        mapping = mmap( NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    }
+    if( mapping == MAP_FAILED ) return NULL;
+
+    // bind before the pages are faulted in (mlock faults them in)
+    if( flags & RDAI_MEM_FLAG_NUMA_BIND ) {
+        if( !bind_to_numa_node( mapping, length, RDAI_MEM_FLAG_GET_NUMA_NODE( flags ) ) ) {
+            munmap( mapping, length );
+            return NULL;
+        }
+        granted |= flags & (RDAI_MEM_FLAG_NUMA_BIND | RDAI_MEM_FLAG_NUMA_NODE_MASK);
+    }
+    if( flags & RDAI_MEM_FLAG_PINNED ) {
+        if( mlock( mapping, length ) != 0 ) {
+            munmap( mapping, length );
+            return NULL;
+        }
+        granted |= RDAI_MEM_FLAG_PINNED;
+    }
+
+    Block *block = (Block *) aligned_alloc( MEM_POOL_ALIGNMENT, BLOCK_HEADER_SIZE );
+    if( !block ) {
+        munmap( mapping, length );
+        return NULL;
+    }
+    block->size_class   = MEM_POOL_MAPPED_CLASS;
+    block->payload_size = length;
+    block->next         = nullptr;
+    block->mapping      = mapping;
+    block->mapping_size = length;
+
+    MemPoolThreadCache *cache = local_cache();
+    if( cache ) {
+        bump<uint64_t>( cache->misses, 1 );
+        bump<int64_t>( cache->bytes_in_use, (int64_t) length );
+    } else {
+        retired_misses.fetch_add( 1, std::memory_order_relaxed );
+        retired_bytes_in_use.fetch_add( (int64_t) length, std::memory_order_relaxed );
+    }
+
+    memset( &block->object, 0, sizeof( RDAI_MemObject ) );
+    block->object.host_ptr = (uint8_t *) mapping;
+    block->object.size     = size;
+    block->object.flags    = granted;
+    return &block->object;
+}
+
+RDAI_MemObject* MemPool::allocate( size_t size )
+{
+    Block *block = nullptr;
+    size_t size_class = MEM_POOL_LARGE_CLASS;
+    size_t payload_size = size;
+    bool hit = false;
+
+    MemPoolThreadCache *cache = local_cache();
+    if( size <= MEM_POOL_MAX_CLASS_SIZE ) {
+        size_class   = size_to_class( size );
+        payload_size = class_to_size( size_class );
+        if( cache ) {
+            MemPoolThreadCache::Bin &bin = cache->bins[size_class];
+            if( !bin.head ) {
+                size_t n = pop_global( size_class, &bin.head, (cache_capacity( size_class ) + 1) / 2 );
+                bin.count = (uint32_t) n;
+                bump<uint64_t>( cache->bytes_held, n * payload_size );
+            }
+            if( bin.head ) {
+                block = bin.head;
+                bin.head = block->next;
+                bin.count--;
+                bump<uint64_t>( cache->bytes_held, -(uint64_t) payload_size );
+            }
+        } else {
+            pop_global( size_class, &block, 1 );
+        }
+        hit = (block != nullptr);
+    }
+
+    if( !block ) {
+        block = new_block( size_class, payload_size );
+        if( !block ) return NULL;
+    }
+
+    if( cache ) {
+        bump<uint64_t>( hit ? cache->hits : cache->misses, 1 );
+        bump<int64_t>( cache->bytes_in_use, (int64_t) payload_size );
+    } else {
+        (hit ? retired_hits : retired_misses).fetch_add( 1, std::memory_order_relaxed );
+        retired_bytes_in_use.fetch_add( (int64_t) payload_size, std::memory_order_relaxed );
+    }
+
+    block->next = nullptr;
+    memset( &block->object, 0, sizeof( RDAI_MemObject ) );
+    block->object.host_ptr = payload_of( block );
+    block->object.size     = size;
+    block->object.flags    = RDAI_MEM_FLAG_ALIGN_64;
+    return &block->object;
+}
+
+void MemPool::release( RDAI_MemObject *mem_object )
+{
+    Block *block = block_of( mem_object );
+
+    size_t size_class   = block->size_class;
+    size_t payload_size = block->payload_size;
+    MemPoolThreadCache *cache = local_cache();
+    if( cache ) {
+        bump<int64_t>( cache->bytes_in_use, -(int64_t) payload_size );
+    } else {
+        retired_bytes_in_use.fetch_sub( (int64_t) payload_size, std::memory_order_relaxed );
+    }
+
+    if( size_class == MEM_POOL_LARGE_CLASS || size_class == MEM_POOL_MAPPED_CLASS ) {
+        delete_block( block );
+        return;
+    }
+
+    if( !cache ) {
+        push_global( size_class, block, block, 1 );
+        return;
+    }
+
+    MemPoolThreadCache::Bin &bin = cache->bins[size_class];
+    block->next = bin.head;
+    bin.head = block;
+    bin.count++;
+    bump<uint64_t>( cache->bytes_held, payload_size );
+
+    uint32_t capacity = cache_capacity( size_class );
+    if( bin.count > capacity ) {
+        // keep half of the cache, give the rest back to the global list
+        uint32_t keep = capacity / 2;
+        Block *tail = bin.head;
+        for( uint32_t i = 1; i < keep; i++ ) tail = tail->next;
+        Block *head = keep ? tail->next : bin.head;
+        if( keep ) tail->next = nullptr;
+        else bin.head = nullptr;
+        size_t count = bin.count - keep;
+        bin.count = keep;
+
+        Block *last = head;
+        while( last->next ) last = last->next;
+        bump<uint64_t>( cache->bytes_held, -(uint64_t)( count * payload_size ) );
+        push_global( size_class, head, last, count );
+    }
+}
+
+void MemPool::push_global( size_t size_class, Block *head, Block *tail, size_t count )
+{
+    FreeList &fl = free_lists[size_class];
+    {
+        std::lock_guard<std::mutex> lock( fl.lock );
+        tail->next = fl.head;
+        fl.head = head;
+        fl.count += count;
+    }
+    global_bytes_held.fetch_add( count * class_to_size( size_class ), std::memory_order_relaxed );
+}
+
+size_t MemPool::pop_global( size_t size_class, Block **head, size_t max_count )
+{
+    FreeList &fl = free_lists[size_class];
+    size_t n = 0;
+    {
+        std::lock_guard<std::mutex> lock( fl.lock );
+        if( !fl.head ) {
+            *head = nullptr;
+            return 0;
+        }
+        Block *tail = fl.head;
+        n = 1;
+        while( n < max_count && tail->next ) {
+            tail = tail->next;
+            n++;
+        }
+        *head = fl.head;
+        fl.head = tail->next;
+        fl.count -= n;
+        tail->next = nullptr;
+    }
+    global_bytes_held.fetch_sub( n * class_to_size( size_class ), std::memory_order_relaxed );
+    return n;
+}
+
+static void flush_cache( MemPool *pool, MemPoolThreadCache *cache )
+{
+    for( size_t c = 0; c < MEM_POOL_NUM_CLASSES; c++ ) {
+        MemPoolThreadCache::Bin &bin = cache->bins[c];
+        if( !bin.head ) continue;
+        MemPool::Block *tail = bin.head;
+        while( tail->next ) tail = tail->next;
+        pool->push_global( c, bin.head, tail, bin.count );
+        bump<uint64_t>( cache->bytes_held, -(uint64_t)( bin.count * MemPool::class_to_size( c ) ) );
+        bin.head  = nullptr;
+        bin.count = 0;
+    }
+}
+
+void MemPool::retire_cache( MemPoolThreadCache *cache )
+{
+    flush_cache( this, cache );
+    std::lock_guard<std::mutex> lock( caches_lock );
+    if( cache->prev ) cache->prev->next = cache->next;
+    else caches = cache->next;
+    if( cache->next ) cache->next->prev = cache->prev;
+    retired_hits.fetch_add( cache->hits.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+    retired_misses.fetch_add( cache->misses.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+    retired_bytes_in_use.fetch_add( cache->bytes_in_use.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+    cache->pool = nullptr;
+}
+
+void MemPool::trim()
+{
+    MemPoolThreadCache *cache = local_cache();
+    if( cache ) flush_cache( this, cache );
+
+    for( size_t c = 0; c < MEM_POOL_NUM_CLASSES; c++ ) {
+        Block *head;
+        pop_global( c, &head, SIZE_MAX );
+        while( head ) {
+            Block *next = head->next;
+            delete_block( head );
+            head = next;
+        }
+    }
+}
+
+void MemPool::get_stats( RDAI_MemPoolStats *stats )
+{
+    uint64_t hits       = retired_hits.load( std::memory_order_relaxed );
+    uint64_t misses     = retired_misses.load( std::memory_order_relaxed );
+    uint64_t bytes_held = global_bytes_held.load( std::memory_order_relaxed );
+    int64_t bytes_in_use = retired_bytes_in_use.load( std::memory_order_relaxed );
+    {
+        std::lock_guard<std::mutex> lock( caches_lock );
+        for( MemPoolThreadCache *c = caches; c; c = c->next ) {
+            hits         += c->hits.load( std::memory_order_relaxed );
+            misses       += c->misses.load( std::memory_order_relaxed );
+            bytes_held   += c->bytes_held.load( std::memory_order_relaxed );
+            bytes_in_use += c->bytes_in_use.load( std::memory_order_relaxed );
+        }
+    }
+    stats->hits         = hits;
+    stats->misses       = misses;
+    stats->bytes_held   = bytes_held;
+    stats->bytes_in_use = bytes_in_use > 0 ? (uint64_t) bytes_in_use : 0;
+}
@@ -0,0 +1,175 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "platform_registry.h"
+
+static void futex_wait( std::atomic<uint32_t> *word, uint32_t expected )
+{
+    syscall( SYS_futex, (uint32_t *) word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0 );
+}
+
+static void futex_wake_all( std::atomic<uint32_t> *word )
+{
+    syscall( SYS_futex, (uint32_t *) word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0 );
+}
+
+PlatformRegistry::PlatformRegistry()
+{
+    pin_counts.emplace_back( 0 );
+    Snapshot *s = new Snapshot();
+    s->entries.push_back( Entry{ NULL, NULL, &pin_counts[0] } );
+    current.store( s, std::memory_order_release );
+}
+
+PlatformRegistry::~PlatformRegistry()
+{
+    for( auto &r : retired ) delete r.second;
+    delete current.load( std::memory_order_relaxed );
+}
+
+RDAI_Platform* PlatformRegistry::add( RDAI_PlatformOps *ops )
+{
+    std::lock_guard<std::mutex> lock( writer_lock );
+    const Snapshot *s = current.load( std::memory_order_relaxed );
+    for( const Entry &e : s->entries ) {
+        if( e.platform && e.ops == ops ) return e.platform;
+    }
+
+    RDAI_Platform *platform = ops->platform_create();
+    if( !platform ) return NULL;
+
+    Snapshot *next = new Snapshot( *s );
+    uint32_t id;
+    if( !free_ids.empty() ) {
+        // hand out the lowest free ID first to keep the table dense
+        std::pop_heap( free_ids.begin(), free_ids.end(), std::greater<uint32_t>() );
+        id = free_ids.back();
+        free_ids.pop_back();
+    } else {
+        id = (uint32_t) next->entries.size();
+        pin_counts.emplace_back( 0 );
+        next->entries.push_back( Entry{ NULL, NULL, &pin_counts[id] } );
+    }
+    next->entries[id].platform = platform;
+    next->entries[id].ops      = ops;
+    __atomic_store_n( &platform->id.value, id, __ATOMIC_RELAXED );
+
+    publish( next );
+    reclaim( false );
+    return platform;
+}
+
+RDAI_PlatformOps* PlatformRegistry::remove( RDAI_Platform *platform )
+{
+    RDAI_PlatformOps *ops;
+    std::atomic<uint32_t> *count;
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock( writer_lock );
+        const Snapshot *s = current.load( std::memory_order_relaxed );
+        id = platform->id.value;
+        if( id >= s->entries.size() || s->entries[id].platform != platform ) return NULL;
+
+        ops   = s->entries[id].ops;
+        count = s->entries[id].pins;
+        Snapshot *next = new Snapshot( *s );
+        next->entries[id].platform = NULL;
+        next->entries[id].ops      = NULL;
+
+        publish( next );
+        reclaim( true );
+
+        __atomic_store_n( &platform->id.value, 0, __ATOMIC_RELAXED );
+    }
+
+    // pins are taken in read-side sections, so none can be taken past
+    // reclaim: wait for the ones taken before, without blocking the writers
+    // of other platforms. The slot is only freed after, so that a late
+    // unpin never counts down the pins of the next platform
+    uint32_t pins = count->fetch_or( PIN_REMOVING ) | PIN_REMOVING;
+    while( pins != PIN_REMOVING ) {
+        futex_wait( count, pins );
+        pins = count->load();
+    }
+    count->store( 0, std::memory_order_relaxed );
+
+    std::lock_guard<std::mutex> lock( writer_lock );
+    free_ids.push_back( id );
+    std::push_heap( free_ids.begin(), free_ids.end(), std::greater<uint32_t>() );
+    return ops;
+}
+
+RDAI_Platform* PlatformRegistry::find_platform( const RDAI_PlatformOps *ops ) const
+{
+    const Snapshot *s = current.load( std::memory_order_acquire );
+    for( const Entry &e : s->entries ) {
+        if( e.platform && e.ops == ops ) return e.platform;
+    }
+    return NULL;
+}
+
+RDAI_Platform* PlatformRegistry::find_platform( uint32_t id ) const
+{
+    const Snapshot *s = current.load( std::memory_order_acquire );
+    if( id < s->entries.size() ) return s->entries[id].platform;
+    return NULL;
+}
+
+RDAI_PlatformOps* PlatformRegistry::pin( const RDAI_Platform *platform, std::atomic<uint32_t> **count )
+{
+    ReadGuard guard( *this );
+    const Snapshot *s = current.load( std::memory_order_acquire );
+    uint32_t id = __atomic_load_n( &platform->id.value, __ATOMIC_RELAXED );
+    if( id < s->entries.size() && s->entries[id].platform == platform ) {
+        s->entries[id].pins->fetch_add( 1 );
+        *count = s->entries[id].pins;
+        return s->entries[id].ops;
+    }
+    return NULL;
+}
+
+void PlatformRegistry::unpin( std::atomic<uint32_t> *count )
+{
+    // the last unpin of a platform being removed wakes the remover
+    if( count->fetch_sub( 1 ) == ( PIN_REMOVING | 1 ) ) futex_wake_all( count );
+}
+
+void PlatformRegistry::publish( Snapshot *next )
+{
+    const Snapshot *prev = current.exchange( next, std::memory_order_seq_cst );
+    retired.emplace_back( epochs.advance(), prev );
+}
+
+void PlatformRegistry::reclaim( bool wait )
+{
+    if( retired.empty() ) return;
+    if( wait ) {
+        epochs.synchronize();
+    } else if( !epochs.is_quiescent( retired.back().first ) ) {
+        return;
+    }
+    for( auto &r : retired ) delete r.second;
+    retired.clear();
+}
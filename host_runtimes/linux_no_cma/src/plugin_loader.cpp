@@ -0,0 +1,89 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+
+#include "plugin_loader.h"
+
+RDAI_PlatformOps* PluginLoader::load( const char *path )
+{
+    void *library = dlopen( path, RTLD_NOW | RTLD_LOCAL );
+    if( !library ) return NULL;
+    RDAI_PlatformOps **symbol = (RDAI_PlatformOps **) dlsym( library, RDAI_PLUGIN_OPS_SYMBOL );
+    RDAI_PlatformOps *ops = symbol ? *symbol : NULL;
+    if( !ops || !ops->platform_create || !ops->platform_destroy ) {
+        dlclose( library );
+        return NULL;
+    }
+
+    std::lock_guard<std::mutex> guard( lock );
+    // dlopen hands out the same handle for a library that is already open
+    if( std::find( libraries.begin(), libraries.end(), library ) != libraries.end() ) {
+        dlclose( library );
+    } else {
+        libraries.push_back( library );
+    }
+    if( std::find( pending.begin(), pending.end(), ops ) == pending.end() ) {
+        pending.push_back( ops );
+        has_pending.store( true, std::memory_order_release );
+    }
+    return ops;
+}
+
+void PluginLoader::scan_path()
+{
+    const char *value = getenv( "RDAI_PLUGIN_PATH" );
+    if( !value ) return;
+
+    std::string plugin_path( value );
+    size_t start = 0;
+    while( start <= plugin_path.size() ) {
+        size_t end = plugin_path.find( ':', start );
+        if( end == std::string::npos ) end = plugin_path.size();
+        std::string entry = plugin_path.substr( start, end - start );
+        start = end + 1;
+        if( entry.empty() ) continue;
+
+        struct stat st;
+        if( stat( entry.c_str(), &st ) != 0 ) continue;
+        if( !S_ISDIR( st.st_mode ) ) {
+            load( entry.c_str() );
+            continue;
+        }
+
+        // load the .so files of a directory in name order, so that platform
+        // IDs do not depend on the directory layout on disk
+        std::vector<std::string> files;
+        if( DIR *dir = opendir( entry.c_str() ) ) {
+            while( struct dirent *e = readdir( dir ) ) {
+                size_t len = strlen( e->d_name );
+                if( len > 3 && strcmp( e->d_name + len - 3, ".so" ) == 0 ) files.push_back( e->d_name );
+            }
+            closedir( dir );
+        }
+        std::sort( files.begin(), files.end() );
+        for( const std::string &f : files ) load( (entry + "/" + f).c_str() );
+    }
+}
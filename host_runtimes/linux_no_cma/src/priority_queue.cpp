@@ -0,0 +1,49 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cstdlib>
+
+#include "priority_queue.h"
+
+#define PRIORITY_AGING_DEFAULT_US   10000
+
+QueueWaitStats::QueueWaitStats()
+{
+    const char *value = getenv( "RDAI_PRIORITY_AGING_US" );
+    uint64_t us = (value && *value) ? strtoull( value, NULL, 0 ) : PRIORITY_AGING_DEFAULT_US;
+    aging = (us ? us : 1) * 1000;
+}
+
+void QueueWaitStats::get( RDAI_Priority priority, RDAI_QueueWaitStats *stats ) const
+{
+    const LatencyHistogram &h = waits[priority];
+    stats->count   = h.count();
+    stats->mean_ns = h.mean_ns();
+    stats->p50_ns  = h.percentile( 0.50 );
+    stats->p99_ns  = h.percentile( 0.99 );
+    stats->max_ns  = h.max_ns();
+    stats->aged    = num_aged[priority].load( std::memory_order_relaxed );
+}
+
+void QueueWaitStats::reset()
+{
+    for( int c = 0; c < RDAI_NUM_PRIORITIES; c++ ) {
+        waits[c].reset();
+        num_aged[c].store( 0, std::memory_order_relaxed );
+    }
+}
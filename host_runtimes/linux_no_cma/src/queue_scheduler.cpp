@@ -0,0 +1,217 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <algorithm>
+
+#include "queue_scheduler.h"
+
+RDAI_Queue *QueueScheduler::create_queue( RDAI_Device *device )
+{
+    RDAI_Queue *queue = new RDAI_Queue;
+    queue->device = device;
+    return queue;
+}
+
+void QueueScheduler::destroy_queue( RDAI_Queue *queue )
+{
+    RDAI_Status unused;
+    sync( queue, &unused );
+    delete queue;
+}
+
+void QueueScheduler::submit_device( RDAI_Queue *queue, RDAI_Device *device, FrameReport::Op op,
+                                    DeviceExecutor::Work work )
+{
+    RDAI_Queue::Command command = {};
+    command.kind   = RDAI_Queue::COMMAND_DEVICE;
+    command.device = device;
+    command.work   = std::move( work );
+    command.frame  = FrameReport::current();
+    command.op     = op;
+    enqueue( queue, std::move( command ) );
+}
+
+void QueueScheduler::submit_host_copy( RDAI_Queue *queue, void *dest, const void *src, size_t size )
+{
+    RDAI_Queue::Command command = {};
+    command.kind  = RDAI_Queue::COMMAND_HOST_COPY;
+    command.dest  = dest;
+    command.src   = src;
+    command.size  = size;
+    command.frame = FrameReport::current();
+    command.op    = FrameReport::OP_COPY;
+    enqueue( queue, std::move( command ) );
+}
+
+void QueueScheduler::record( RDAI_Queue *queue, RDAI_Event *event )
+{
+    RDAI_Queue::Command command = {};
+    command.kind  = RDAI_Queue::COMMAND_RECORD;
+    command.event = event->state;
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        command.target = ++event->state->recorded;
+    }
+    enqueue( queue, std::move( command ) );
+}
+
+void QueueScheduler::wait( RDAI_Queue *queue, RDAI_Event *event )
+{
+    RDAI_Queue::Command command = {};
+    command.kind  = RDAI_Queue::COMMAND_WAIT;
+    command.event = event->state;
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        command.target = event->state->recorded;
+    }
+    enqueue( queue, std::move( command ) );
+}
+
+bool QueueScheduler::sync( RDAI_Queue *queue, RDAI_Status *error )
+{
+    std::unique_lock<std::mutex> guard( lock );
+    cv.wait( guard, [queue]() { return queue->commands.empty(); } );
+    bool failed = queue->failed;
+    if( failed ) *error = queue->error;
+    queue->failed = false;
+    return !failed;
+}
+
+void QueueScheduler::sync_event( RDAI_Event *event )
+{
+    std::unique_lock<std::mutex> guard( lock );
+    QueueEventState *state = event->state.get();
+    uint64_t target = state->recorded;
+    cv.wait( guard, [state, target]() { return state->has_reached( target ); } );
+}
+
+void QueueScheduler::enqueue( RDAI_Queue *queue, RDAI_Queue::Command command )
+{
+    Ready ready;
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        queue->commands.push_back( std::move( command ) );
+        advance( queue, &ready );
+    }
+    dispatch( ready );
+}
+
+/**
+ * Resolve the commands at the head of a queue until one has to execute
+ * (the queue is then added to ready) or has to wait for an event
+ *
+ * Must be called with the scheduler lock held
+ */
+void QueueScheduler::advance( RDAI_Queue *queue, Ready *ready )
+{
+    std::vector<RDAI_Queue *> pending { queue };
+    bool progress = false;
+
+    while( !pending.empty() ) {
+        RDAI_Queue *q = pending.back();
+        pending.pop_back();
+
+        while( !q->busy && !q->commands.empty() ) {
+            RDAI_Queue::Command &head = q->commands.front();
+            if( head.kind == RDAI_Queue::COMMAND_RECORD ) {
+                QueueEventState *state = head.event.get();
+                state->reached.insert( head.target );
+                while( !state->reached.empty() && *state->reached.begin() == state->completed + 1 ) {
+                    state->reached.erase( state->reached.begin() );
+                    state->completed++;
+                }
+                // the queues waiting on the event may proceed now
+                pending.insert( pending.end(), state->waiters.begin(), state->waiters.end() );
+                state->waiters.clear();
+                q->commands.pop_front();
+                progress = true;
+            }
+            else if( head.kind == RDAI_Queue::COMMAND_WAIT ) {
+                QueueEventState *state = head.event.get();
+                if( !state->has_reached( head.target ) ) {
+                    if( std::find( state->waiters.begin(), state->waiters.end(), q ) == state->waiters.end() ) {
+                        state->waiters.push_back( q );
+                    }
+                    break;
+                }
+                q->commands.pop_front();
+                progress = true;
+            }
+            else {
+                // the emptied head stays in place until on_done
+                q->busy = true;
+                ready->emplace_back( q, std::move( head ) );
+            }
+        }
+    }
+    if( progress ) cv.notify_all();
+}
+
+/**
+ * Forward the head commands of ready queues, without the scheduler lock
+ * (called from the completion of a command too: neither post waits)
+ */
+void QueueScheduler::dispatch( Ready &ready )
+{
+    for( auto &entry : ready ) {
+        RDAI_Queue *queue = entry.first;
+        RDAI_Queue::Command &command = entry.second;
+        if( command.kind == RDAI_Queue::COMMAND_DEVICE ) {
+            executor.post( command.device, [this, queue, frame = command.frame, op = command.op,
+                                            work = std::move( command.work )]() {
+                        RDAI_Status status;
+                        {
+                            FrameReport::Scope framed( frames, op, frame );
+                            status = work();
+                        }
+                        on_done( queue, status );
+                    });
+        }
+        else {
+            // timed from the post: waiting for a copy thread counts as copying
+            uint64_t frame = command.frame;
+            uint64_t posted = frame ? CompletionTable::profile_clock_ns() : 0;
+            async_copy.post( command.dest, command.src, command.size, [this, queue, frame, posted]() {
+                        if( frame ) {
+                            frames.executed( frame, FrameReport::OP_COPY,
+                                             CompletionTable::profile_clock_ns() - posted );
+                        }
+                        RDAI_Status status = {};
+                        status.status_code = RDAI_StatusCode::RDAI_STATUS_OK;
+                        on_done( queue, status );
+                    });
+        }
+    }
+}
+
+void QueueScheduler::on_done( RDAI_Queue *queue, RDAI_Status status )
+{
+    Ready ready;
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        if( status.status_code != RDAI_StatusCode::RDAI_STATUS_OK && !queue->failed ) {
+            queue->failed = true;
+            queue->error  = status;
+        }
+        queue->commands.pop_front();
+        queue->busy = false;
+        advance( queue, &ready );
+        cv.notify_all();
+    }
+    dispatch( ready );
+}
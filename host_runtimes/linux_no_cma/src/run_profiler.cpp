@@ -0,0 +1,214 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "run_profiler.h"
+
+// the counters, in RDAI_COUNTER_* bit order
+static const struct
+{
+    uint32_t type;
+    uint64_t config;
+} counter_events[RunProfiler::NUM_COUNTERS] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },     // last level cache misses on most CPUs
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+};
+
+/**
+ * The perf_event group of a thread, closed when the thread exits
+ */
+class RunProfiler::Group
+{
+public:
+
+    Group()
+    {
+        for( size_t c = 0; c < NUM_COUNTERS; c++ ) {
+            struct perf_event_attr attr;
+            memset( &attr, 0, sizeof( attr ) );
+            attr.size           = sizeof( attr );
+            attr.type           = counter_events[c].type;
+            attr.config         = counter_events[c].config;
+            attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            // the first counter opened leads the group, and starts it
+            attr.disabled       = (num_fds == 0) ? 1 : 0;
+            int fd = (int) syscall( SYS_perf_event_open, &attr, 0, -1, num_fds ? fds[0] : -1, 0 );
+            if( fd < 0 ) continue;
+            fds[num_fds]    = fd;
+            counter[num_fds] = c;
+            available |= 1u << c;
+            num_fds++;
+        }
+        if( num_fds && ioctl( fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP ) != 0 ) close_all();
+    }
+
+    ~Group() { close_all(); }
+    Group( const Group& ) = delete;
+    Group& operator=( const Group& ) = delete;
+
+    bool read_sample( Sample &sample ) const
+    {
+        if( !num_fds ) return false;
+        uint64_t buffer[3 + NUM_COUNTERS];
+        ssize_t expected = (ssize_t) ((3 + num_fds) * sizeof( uint64_t ));
+        if( read( fds[0], buffer, sizeof( buffer ) ) != expected || buffer[0] != num_fds ) return false;
+        memset( &sample, 0, sizeof( sample ) );
+        sample.time_enabled = buffer[1];
+        sample.time_running = buffer[2];
+        for( size_t i = 0; i < num_fds; i++ ) sample.values[counter[i]] = buffer[3 + i];
+        return true;
+    }
+
+    uint32_t available = 0;
+
+private:
+    void close_all()
+    {
+        for( size_t i = num_fds; i-- > 0; ) close( fds[i] );
+        num_fds   = 0;
+        available = 0;
+    }
+
+    int fds[NUM_COUNTERS];
+    size_t counter[NUM_COUNTERS];
+    size_t num_fds = 0;
+};
+
+static thread_local std::unique_ptr<RunProfiler::Group> local_group;
+
+RunProfiler::RunProfiler()
+{
+    const char *value = getenv( "RDAI_RUN_COUNTERS" );
+    if( value && *value && strcmp( value, "0" ) != 0 ) enabled.store( true );
+}
+
+RunProfiler::~RunProfiler()
+{
+}
+
+RunProfiler::Group *RunProfiler::begin( Sample &start )
+{
+    if( !local_group ) local_group.reset( new Group() );
+    return local_group->read_sample( start ) ? local_group.get() : NULL;
+}
+
+void RunProfiler::end( Group *group, const RDAI_Device *device, size_t runs, const Sample &start )
+{
+    Sample sample;
+    if( !group->read_sample( sample ) ) return;
+
+    // counters multiplexed with other events only ran part of the time
+    uint64_t enabled_ns = sample.time_enabled - start.time_enabled;
+    uint64_t running_ns = sample.time_running - start.time_running;
+    double scale = (running_ns && running_ns < enabled_ns) ? (double) enabled_ns / (double) running_ns : 1.0;
+    uint64_t delta[NUM_COUNTERS];
+    for( size_t c = 0; c < NUM_COUNTERS; c++ ) {
+        delta[c] = (uint64_t) ((double) (sample.values[c] - start.values[c]) * scale);
+    }
+
+    std::lock_guard<std::mutex> guard( lock );
+    auto it = totals.find( device );
+    if( it == totals.end() ) {
+        // the VLNV is copied now: the device may be gone when totals are read
+        Totals t;
+        memset( &t, 0, sizeof( t ) );
+        if( device ) {
+            t.platform = device->platform;
+            t.vlnv     = device->vlnv;
+        }
+        it = totals.emplace( device, t ).first;
+    }
+    RDAI_RunCounters &c = it->second.counters;
+    c.runs          += runs;
+    c.cycles        += delta[0];
+    c.instructions  += delta[1];
+    c.llc_misses    += delta[2];
+    c.branch_misses += delta[3];
+    c.cpu_time_ns   += delta[4];
+    c.available     |= group->available;
+}
+
+static bool vlnv_equal( const RDAI_VLNV &lhs, const RDAI_VLNV &rhs )
+{
+    return lhs.version == rhs.version &&
+           strncmp( lhs.vendor.value, rhs.vendor.value, RDAI_STRING_ID_LENGTH ) == 0 &&
+           strncmp( lhs.library.value, rhs.library.value, RDAI_STRING_ID_LENGTH ) == 0 &&
+           strncmp( lhs.name.value, rhs.name.value, RDAI_STRING_ID_LENGTH ) == 0;
+}
+
+static void add_counters( RDAI_RunCounters *sum, const RDAI_RunCounters &c )
+{
+    sum->runs          += c.runs;
+    sum->cycles        += c.cycles;
+    sum->instructions  += c.instructions;
+    sum->llc_misses    += c.llc_misses;
+    sum->branch_misses += c.branch_misses;
+    sum->cpu_time_ns   += c.cpu_time_ns;
+    sum->available     |= c.available;
+}
+
+void RunProfiler::get( const RDAI_Device *device, const RDAI_VLNV *vlnv, RDAI_RunCounters *counters ) const
+{
+    memset( counters, 0, sizeof( *counters ) );
+    std::lock_guard<std::mutex> guard( lock );
+    for( const auto &entry : totals ) {
+        if( device && entry.first != device ) continue;
+        if( !device && vlnv && !vlnv_equal( entry.second.vlnv, *vlnv ) ) continue;
+        ::add_counters( counters, entry.second.counters );
+    }
+    if( device ) return;
+    for( const Totals &t : retired ) {
+        if( !vlnv || vlnv_equal( t.vlnv, *vlnv ) ) ::add_counters( counters, t.counters );
+    }
+}
+
+void RunProfiler::reset()
+{
+    std::lock_guard<std::mutex> guard( lock );
+    totals.clear();
+    retired.clear();
+}
+
+void RunProfiler::remove_platform( const RDAI_Platform *platform )
+{
+    std::lock_guard<std::mutex> guard( lock );
+    for( auto it = totals.begin(); it != totals.end(); ) {
+        if( !it->first || it->second.platform != platform ) {
+            ++it;
+            continue;
+        }
+        auto same = std::find_if( retired.begin(), retired.end(), [&]( const Totals &t ) {
+                    return vlnv_equal( t.vlnv, it->second.vlnv );
+                });
+        if( same != retired.end() ) ::add_counters( &same->counters, it->second.counters );
+        else retired.push_back( it->second );
+        it = totals.erase( it );
+    }
+}
@@ -0,0 +1,35 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cstdio>
+
+#include "runtime_util.h"
+
+bool write_file_atomic( const char *path, const std::string &contents )
+{
+    std::string tmp_path = std::string( path ) + ".tmp";
+    FILE *f = fopen( tmp_path.c_str(), "w" );
+    if( !f ) return false;
+    bool written = fwrite( contents.data(), 1, contents.size(), f ) == contents.size();
+    written = (fclose( f ) == 0) && written;
+    if( !written || rename( tmp_path.c_str(), path ) != 0 ) {
+        remove( tmp_path.c_str() );
+        return false;
+    }
+    return true;
+}
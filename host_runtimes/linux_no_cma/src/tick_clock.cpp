@@ -0,0 +1,49 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#include "tick_clock.h"
+
+#define TICK_CALIBRATION_MIN_MS     10
+
+bool TickClock::has_invariant_tsc()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned eax, ebx, ecx, edx;
+    if( __get_cpuid( 0x80000007, &eax, &ebx, &ecx, &edx ) ) return (edx & (1u << 8)) != 0;
+#endif
+    return false;
+}
+
+double TickClock::ns_per_tick() const
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if( !tsc_invariant() ) return 1.0;
+#elif !defined(__aarch64__)
+    return 1.0;
+#endif
+    std::this_thread::sleep_until( start_time + std::chrono::milliseconds( TICK_CALIBRATION_MIN_MS ) );
+    uint64_t t = now();
+    double ns = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start_time ).count();
+    return ns / (double) (t - start_ticks);
+}
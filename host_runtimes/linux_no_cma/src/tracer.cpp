@@ -0,0 +1,178 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "tracer.h"
+#include "runtime_util.h"
+
+#define TRACE_BUFFER_DEFAULT_EVENTS     65536
+
+thread_local Tracer::LocalRing Tracer::local;
+
+static std::string json_string( const char *value, size_t max_len )
+{
+    std::string s;
+    for( size_t i = 0; i < max_len && value[i]; i++ ) {
+        unsigned char c = (unsigned char) value[i];
+        if( c == '"' || c == '\\' ) {
+            s += '\\';
+            s += (char) c;
+        } else if( c >= 0x20 ) {
+            s += (char) c;
+        }
+    }
+    return s;
+}
+
+Tracer::Tracer()
+{
+    const char *file = getenv( "RDAI_TRACE_FILE" );
+    if( !file || !*file ) return;
+    const char *value = getenv( "RDAI_TRACE_BUFFER_EVENTS" );
+    uint64_t events = (value && *value) ? strtoull( value, NULL, 0 ) : TRACE_BUFFER_DEFAULT_EVENTS;
+    uint64_t capacity = 1;
+    while( capacity < events ) capacity <<= 1;
+    mask    = capacity - 1;
+    path    = file;
+    enabled = true;
+}
+
+Tracer::~Tracer()
+{
+    if( enabled ) flush();
+}
+
+Tracer::Ring* Tracer::attach()
+{
+    std::lock_guard<std::mutex> guard( lock );
+    Ring *ring;
+    if( !free_rings.empty() ) {
+        // the events of the exited thread stay until the new one overwrites them
+        ring = free_rings.back();
+        free_rings.pop_back();
+    } else {
+        rings.emplace_back( new Ring() );
+        ring = rings.back().get();
+        ring->words.reset( new uint64_t[(mask + 1) * EVENT_WORDS] );
+        ring->tid = (uint32_t) rings.size();
+    }
+    local.owner = this;
+    local.ring  = ring;
+    return ring;
+}
+
+void Tracer::detach( Ring *ring )
+{
+    std::lock_guard<std::mutex> guard( lock );
+    free_rings.push_back( ring );
+}
+
+uint32_t Tracer::add_track( Ring *ring, const RDAI_Device *device )
+{
+    std::lock_guard<std::mutex> guard( lock );
+    uint32_t index = 0;
+    while( index < devices.size() && devices[index] != device ) index++;
+    if( index == devices.size() ) {
+        // named now: the device may be gone by the time the trace is flushed
+        char name[256];
+        const RDAI_VLNV &v = device->vlnv;
+        snprintf( name, sizeof( name ), "%s:%s:%s:%u (platform %u, device %u)",
+                  json_string( v.vendor.value, RDAI_STRING_ID_LENGTH ).c_str(),
+                  json_string( v.library.value, RDAI_STRING_ID_LENGTH ).c_str(),
+                  json_string( v.name.value, RDAI_STRING_ID_LENGTH ).c_str(), (unsigned) v.version,
+                  device->platform ? (unsigned) device->platform->id.value : 0u, (unsigned) device->id.value );
+        devices.push_back( device );
+        device_names.push_back( name );
+    }
+    // track 0 is the host
+    ring->tracks.emplace_back( device, index + 1 );
+    return index + 1;
+}
+
+bool Tracer::flush()
+{
+    if( !enabled ) return false;
+    double us_per_tick = clock.ns_per_tick() / 1000.0;
+    uint64_t capacity = mask + 1;
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+                      "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"RDAI host\"}}";
+    char line[512];
+
+    std::lock_guard<std::mutex> guard( lock );
+    for( size_t d = 0; d < devices.size(); d++ ) {
+        snprintf( line, sizeof( line ),
+                  ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%zu,\"args\":{\"name\":\"device %s\"}}",
+                  d + 2, device_names[d].c_str() );
+        out += line;
+    }
+    std::vector<uint64_t> words( capacity * EVENT_WORDS );
+    for( auto &ring : rings ) {
+        snprintf( line, sizeof( line ),
+                  ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+                  ring->tid, ring->tid );
+        out += line;
+
+        // copy the ring, then drop the events its owner overwrote meanwhile
+        uint64_t head = ring->head.load( std::memory_order_acquire );
+        uint64_t first = head > capacity ? head - capacity : 0;
+        for( uint64_t i = first; i < head; i++ ) {
+            const uint64_t *w = &ring->words[(i & mask) * EVENT_WORDS];
+            for( size_t k = 0; k < EVENT_WORDS; k++ ) {
+                words[(i & mask) * EVENT_WORDS + k] = __atomic_load_n( &w[k], __ATOMIC_RELAXED );
+            }
+        }
+        uint64_t head_after = ring->head.load( std::memory_order_acquire );
+        if( head_after > capacity && head_after - capacity > first ) first = head_after - capacity;
+
+        for( uint64_t i = first; i < head; i++ ) {
+            const uint64_t *w = &words[(i & mask) * EVENT_WORDS];
+            char phase = (char) (w[4] & 0xff);
+            unsigned pid = (unsigned) (w[4] >> 8) + 1;
+            const char *name = (const char *) (uintptr_t) w[2];
+            double ts = (w[0] > clock.start()) ? (double) (w[0] - clock.start()) * us_per_tick : 0.0;
+            switch( phase ) {
+            case 'X':
+                snprintf( line, sizeof( line ),
+                          ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%u}",
+                          name, ts, (double) w[1] * us_per_tick, pid, ring->tid );
+                break;
+            case 'b':
+            case 'e':
+                snprintf( line, sizeof( line ),
+                          ",\n{\"name\":\"%s\",\"cat\":\"async\",\"ph\":\"%c\",\"id\":\"0x%llx\",\"ts\":%.3f,"
+                          "\"pid\":%u,\"tid\":%u,\"args\":{\"handle\":%llu}}",
+                          name, phase, (unsigned long long) w[3], ts, pid, ring->tid, (unsigned long long) w[3] );
+                break;
+            default:
+                snprintf( line, sizeof( line ),
+                          ",\n{\"name\":\"%s\",\"cat\":\"handle\",\"ph\":\"%c\",%s\"id\":%llu,\"ts\":%.3f,"
+                          "\"pid\":%u,\"tid\":%u}",
+                          name, phase, phase == 'f' ? "\"bp\":\"e\"," : "", (unsigned long long) w[3], ts,
+                          pid, ring->tid );
+                break;
+            }
+            out += line;
+        }
+    }
+    out += "\n]}\n";
+
+    return write_file_atomic( path.c_str(), out );
+}
@@ -0,0 +1,372 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "vlnv_scheduler.h"
+#include "runtime_util.h"
+#include "probes.h"
+
+static bool vlnv_equal( const RDAI_VLNV &lhs, const RDAI_VLNV &rhs )
+{
+    return lhs.version == rhs.version &&
+           strncmp( lhs.vendor.value, rhs.vendor.value, RDAI_STRING_ID_LENGTH ) == 0 &&
+           strncmp( lhs.library.value, rhs.library.value, RDAI_STRING_ID_LENGTH ) == 0 &&
+           strncmp( lhs.name.value, rhs.name.value, RDAI_STRING_ID_LENGTH ) == 0;
+}
+
+static std::string vlnv_key( const RDAI_VLNV &vlnv )
+{
+    std::string key;
+    key.append( vlnv.vendor.value, strnlen( vlnv.vendor.value, RDAI_STRING_ID_LENGTH ) ).push_back( ':' );
+    key.append( vlnv.library.value, strnlen( vlnv.library.value, RDAI_STRING_ID_LENGTH ) ).push_back( ':' );
+    key.append( vlnv.name.value, strnlen( vlnv.name.value, RDAI_STRING_ID_LENGTH ) ).push_back( ':' );
+    key.append( std::to_string( vlnv.version ) );
+    return key;
+}
+
+#define EWMA_WEIGHT_SHIFT   3               // each run weighs 1/8 of the average
+#define STEAL_RETRY_MAX_NS  (10u * 1000000)
+
+#define EWMA_MIN_RUNS       4               // runs before an estimate is trusted
+
+// a failed run counts as FAILED_RUN_FACTOR times the average, and at least
+// FAILED_RUN_MIN_NS, so that a device failing at once does not look fastest
+#define FAILED_RUN_FACTOR   4
+#define FAILED_RUN_MIN_NS   (10u * 1000000)
+
+/**
+ * Default dispatch policy: the lowest expected completion time. Devices with
+ * fewer than EWMA_MIN_RUNS runs are assumed as fast as the fastest known
+ * device, so that they get tried and one slow first run does not rule them out.
+ */
+static size_t expected_completion_policy( const RDAI_DeviceEstimate *estimates, size_t count, void * )
+{
+    uint64_t fastest = 0;
+    for( size_t i = 0; i < count; i++ ) {
+        uint64_t latency = estimates[i].latency_ns;
+        if( estimates[i].runs >= EWMA_MIN_RUNS && (!fastest || latency < fastest) ) fastest = latency;
+    }
+    if( !fastest ) fastest = 1;
+
+    size_t best = 0;
+    uint64_t best_cost = 0;
+    for( size_t i = 0; i < count; i++ ) {
+        uint64_t latency = (estimates[i].runs >= EWMA_MIN_RUNS) ? estimates[i].latency_ns : fastest;
+        uint64_t cost = (estimates[i].queue_depth + 1) * latency;
+        if( i == 0 || cost < best_cost ) {
+            best = i;
+            best_cost = cost;
+        }
+    }
+    return best;
+}
+
+VlnvScheduler::~VlnvScheduler()
+{
+    stopping.store( true );
+    for( auto &entry : groups ) {
+        Group *group = entry.second.get();
+        {
+            std::lock_guard<std::mutex> guard( group->lock );
+            group->cv.notify_all();
+        }
+        for( auto &worker : group->owned ) worker->thread.join();
+    }
+}
+
+VlnvScheduler::Group *VlnvScheduler::get_group( const RDAI_VLNV *vlnv )
+{
+    std::lock_guard<std::mutex> guard( groups_lock );
+    auto &group = groups[vlnv_key( *vlnv )];
+    if( !group ) {
+        group.reset( new Group );
+        group->vlnv = *vlnv;
+    }
+    return group.get();
+}
+
+void VlnvScheduler::rebuild( Group *group, const RDAI_Platform *removed )
+{
+    std::vector<RDAI_Device *> devices;
+    {
+        PlatformRegistry::ReadGuard guard( registry );
+        registry.for_each( [&]( const PlatformRegistry::Entry &e ) {
+                    if( e.platform == removed ) return;
+                    for( RDAI_Device **d = e.platform->device_list; d && *d; d++ ) {
+                        if( vlnv_equal( (*d)->vlnv, group->vlnv ) ) devices.push_back( *d );
+                    }
+                });
+    }
+
+    std::vector<Worker *> workers;
+    for( RDAI_Device *device : devices ) {
+        Worker *worker = NULL;
+        for( Worker *w : group->workers ) {
+            if( w->device == device ) worker = w;
+        }
+        if( !worker ) {
+            group->owned.emplace_back( new Worker );
+            worker = group->owned.back().get();
+            worker->device = device;
+            worker->group  = group;
+            worker->thread = std::thread( &VlnvScheduler::worker_loop, this, worker );
+        }
+        workers.push_back( worker );
+    }
+
+    // retire the workers of devices that are gone and requeue their runs
+    std::vector<Task> orphans;
+    for( Worker *w : group->workers ) {
+        if( std::find( workers.begin(), workers.end(), w ) != workers.end() ) continue;
+        std::lock_guard<std::mutex> guard( w->lock );
+        w->retired = true;
+        for( const Task &task : w->tasks ) orphans.push_back( task );
+        group->pending.fetch_sub( w->tasks.size() );
+        w->tasks.clear();
+    }
+    group->workers.swap( workers );
+    for( const Task &task : orphans ) {
+        if( group->workers.empty() ) {
+            completions.complete( task.id, ::make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_DEVICE ) );
+        }
+        else push( pick( group ), task );
+    }
+    group->cv.notify_all();
+}
+
+void VlnvScheduler::remove_platform( const RDAI_Platform *platform )
+{
+    std::lock_guard<std::mutex> groups_guard( groups_lock );
+    for( auto &entry : groups ) {
+        Group *group = entry.second.get();
+        std::lock_guard<std::mutex> guard( group->lock );
+        if( group->generation ) {
+            group->generation = generation.load( std::memory_order_acquire );
+            rebuild( group, platform );
+        }
+    }
+}
+
+void VlnvScheduler::fill_estimate( const Worker *worker, RDAI_DeviceEstimate *estimate ) const
+{
+    estimate->device      = worker->device;
+    estimate->latency_ns  = worker->latency_ns.load( std::memory_order_relaxed );
+    estimate->queue_depth = (uint32_t) worker->load.load( std::memory_order_relaxed );
+    estimate->runs        = worker->runs.load( std::memory_order_relaxed );
+}
+
+VlnvScheduler::Worker *VlnvScheduler::pick( Group *group )
+{
+    RDAI_DispatchPolicy fn;
+    void *ctx;
+    {
+        std::lock_guard<std::mutex> guard( policy_lock );
+        fn  = policy ? policy : expected_completion_policy;
+        ctx = policy_ctx;
+    }
+
+    // candidates are rotated so that ties do not always go to the same device
+    size_t n = group->workers.size();
+    size_t start = group->next++;
+    group->estimates.resize( n );
+    for( size_t i = 0; i < n; i++ ) {
+        fill_estimate( group->workers[(start + i) % n], &group->estimates[i] );
+    }
+    size_t chosen = fn( group->estimates.data(), n, ctx );
+    return group->workers[(start + (chosen < n ? chosen : 0)) % n];
+}
+
+void VlnvScheduler::set_policy( RDAI_DispatchPolicy fn, void *ctx )
+{
+    std::lock_guard<std::mutex> guard( policy_lock );
+    policy     = fn;
+    policy_ctx = ctx;
+}
+
+bool VlnvScheduler::get_estimate( const RDAI_Device *device, RDAI_DeviceEstimate *estimate )
+{
+    std::lock_guard<std::mutex> groups_guard( groups_lock );
+    for( auto &entry : groups ) {
+        Group *group = entry.second.get();
+        std::lock_guard<std::mutex> guard( group->lock );
+        for( Worker *w : group->workers ) {
+            if( w->device == device ) {
+                fill_estimate( w, estimate );
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void VlnvScheduler::push( Worker *worker, const Task &task )
+{
+    worker->load.fetch_add( 1, std::memory_order_relaxed );
+    {
+        std::lock_guard<std::mutex> guard( worker->lock );
+        worker->tasks.push_back( task );
+    }
+    worker->group->pending.fetch_add( 1 );
+}
+
+bool VlnvScheduler::pop( Worker *worker, Task &task )
+{
+    std::lock_guard<std::mutex> guard( worker->lock );
+    if( worker->tasks.empty() ) return false;
+    task = worker->tasks.front();
+    worker->tasks.pop_front();
+    worker->group->pending.fetch_sub( 1 );
+    return true;
+}
+
+bool VlnvScheduler::steal( Worker *thief, Task &task, uint64_t *retry_ns )
+{
+    Group *group = thief->group;
+    Worker *victim = NULL;
+    size_t most = 0;
+    for( Worker *w : group->workers ) {
+        if( w == thief ) continue;
+        std::lock_guard<std::mutex> guard( w->lock );
+        if( w->tasks.size() > most ) {
+            victim = w;
+            most = w->tasks.size();
+        }
+    }
+    if( !victim ) return false;
+
+    // the stolen run would start on the victim once its load is done: only
+    // take it if the thief is expected to finish it sooner
+    uint64_t thief_latency  = thief->latency_ns.load( std::memory_order_relaxed );
+    uint64_t victim_latency = victim->latency_ns.load( std::memory_order_relaxed );
+    uint64_t victim_wait    = victim_latency * victim->load.load( std::memory_order_relaxed );
+    if( thief_latency && victim_latency && thief_latency >= victim_wait ) {
+        *retry_ns = victim_latency;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard( victim->lock );
+    if( victim->tasks.empty() ) return false;
+    task = victim->tasks.back();
+    victim->tasks.pop_back();
+    group->pending.fetch_sub( 1 );
+    victim->load.fetch_sub( 1, std::memory_order_relaxed );
+    thief->load.fetch_add( 1, std::memory_order_relaxed );
+    return true;
+}
+
+RDAI_Status VlnvScheduler::submit( const RDAI_VLNV *vlnv, RDAI_MemObject **mem_object_list,
+                                   RDAI_CompletionCallback callback, void *callback_ctx )
+{
+    Group *group = get_group( vlnv );
+    std::lock_guard<std::mutex> guard( group->lock );
+    uint64_t current = generation.load( std::memory_order_acquire );
+    if( group->generation != current ) {
+        rebuild( group );
+        group->generation = current;
+    }
+    if( group->workers.empty() ) return ::make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_DEVICE );
+
+    Task task;
+    task.mem_object_list = mem_object_list;
+    task.id = completions.create( callback, callback_ctx );
+    if( !task.id ) return ::make_status_error( RDAI_ErrorReason::RDAI_REASON_HANDLE_TABLE_FULL );
+    task.submitted = tracer.active() ? TickClock::now() : 0;
+    RDAI_PROBE_SUBMIT( task.id, NULL, 0 );
+    push( pick( group ), task );
+    // the worker of the run may not be the one notify_one would wake
+    group->cv.notify_all();
+    return ::make_status_ok_async( task.id );
+}
+
+void VlnvScheduler::worker_loop( Worker *worker )
+{
+    Group *group = worker->group;
+    for( ;; ) {
+        Task task;
+        if( !pop( worker, task ) ) {
+            std::unique_lock<std::mutex> guard( group->lock );
+            if( stopping.load() || worker->retired ) return;
+            uint64_t retry_ns = 0;
+            if( !steal( worker, task, &retry_ns ) ) {
+                if( retry_ns ) {
+                    // runs are queued but better left where they are: look
+                    // again after a submission or once the victim progressed
+                    if( retry_ns > STEAL_RETRY_MAX_NS ) retry_ns = STEAL_RETRY_MAX_NS;
+                    group->cv.wait_for( guard, std::chrono::nanoseconds( retry_ns ) );
+                }
+                else {
+                    group->cv.wait( guard, [&]() {
+                                return stopping.load() || worker->retired || group->pending.load() > 0;
+                            });
+                }
+                continue;
+            }
+        }
+
+        // the device of a run is only known now: its span starts on that
+        // device's track at the time of submission
+        tracer.async_begin( "submit_by_vlnv", worker->device, task.id, task.submitted );
+        RDAI_Status status = run( worker, task );
+        worker->load.fetch_sub( 1, std::memory_order_relaxed );
+        tracer.async_end( "submit_by_vlnv", worker->device, task.id );
+        completions.complete( task.id, status );
+    }
+}
+
+/**
+ * Execute a run on the DeviceExecutor thread of the device of a worker, so
+ * that it is serialized with the other work of the device, and wait for it
+ */
+RDAI_Status VlnvScheduler::run( Worker *worker, const Task &task )
+{
+    RDAI_Status status;
+    {
+        std::lock_guard<std::mutex> guard( worker->lock );
+        worker->running = true;
+    }
+    executor.post( worker->device, [this, worker, &task, &status]() {
+                CompletionTable::Running executing( completions, task.id );
+                auto start = std::chrono::steady_clock::now();
+                {
+                    PlatformRegistry::Pin pin( registry, worker->device->platform );
+                    RDAI_TRACE_SCOPE( tracer, "device_run", worker->device );
+                    RDAI_RUN_PROFILE_SCOPE( profiler, worker->device );
+                    if( pin.ops ) status = pin.ops->device_run( worker->device, task.mem_object_list );
+                    else status = ::make_status_error( RDAI_ErrorReason::RDAI_REASON_NO_PLATFORM_OPS );
+                }
+                int64_t sample = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start ).count();
+                int64_t average = (int64_t) worker->latency_ns.load( std::memory_order_relaxed );
+                if( status.status_code != RDAI_StatusCode::RDAI_STATUS_OK ) {
+                    sample = std::max( { sample, average * FAILED_RUN_FACTOR, (int64_t) FAILED_RUN_MIN_NS } );
+                }
+                if( average ) average += (sample - average) >> EWMA_WEIGHT_SHIFT;
+                else average = sample;
+                worker->latency_ns.store( (uint64_t) (average > 0 ? average : 1), std::memory_order_relaxed );
+                worker->runs.fetch_add( 1, std::memory_order_relaxed );
+                std::lock_guard<std::mutex> guard( worker->lock );
+                worker->running = false;
+                worker->ran.notify_one();
+            });
+    std::unique_lock<std::mutex> guard( worker->lock );
+    worker->ran.wait( guard, [worker]() { return !worker->running; } );
+    return status;
+}
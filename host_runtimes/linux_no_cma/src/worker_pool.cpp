@@ -0,0 +1,67 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "worker_pool.h"
+
+WorkerPool::WorkerPool( size_t num_threads )
+    : num_threads( num_threads ? num_threads : std::thread::hardware_concurrency() )
+{
+    if( this->num_threads == 0 ) this->num_threads = 1;
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        stopping = true;
+    }
+    cv.notify_all();
+    for( auto &t : threads ) t.join();
+}
+
+void WorkerPool::start()
+{
+    for( size_t i = 0; i < num_threads; i++ ) {
+        threads.emplace_back( &WorkerPool::worker_loop, this );
+    }
+}
+
+void WorkerPool::submit( std::function<void()> task )
+{
+    std::call_once( started, &WorkerPool::start, this );
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        tasks.push_back( std::move( task ) );
+    }
+    cv.notify_one();
+}
+
+void WorkerPool::worker_loop()
+{
+    for( ;; ) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> guard( lock );
+            cv.wait( guard, [this]() { return stopping || !tasks.empty(); } );
+            if( tasks.empty() ) return;
+            task = std::move( tasks.front() );
+            tasks.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,154 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RDAI_BENCH_COMMON_H
+#define RDAI_BENCH_COMMON_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "rdai_api.h"
+
+// ================= Null platform
+//
+// A platform whose ops do no work, so that benchmarks only measure the
+// overhead of the host runtime. Each NullPlatform owns its own ops table,
+// which lets a benchmark register several distinct platforms.
+
+struct NullPlatform
+{
+    RDAI_Device device;
+    RDAI_Device *device_list[2];
+    RDAI_Platform platform;
+    RDAI_PlatformOps ops;
+};
+
+static NullPlatform *null_platform_creating = NULL;
+
+static inline RDAI_Status null_status_ok()
+{
+    RDAI_Status status;
+    memset( &status, 0, sizeof( status ) );
+    status.status_code = RDAI_STATUS_OK;
+    return status;
+}
+
+static inline RDAI_Status null_status_error( RDAI_ErrorReason reason )
+{
+    RDAI_Status status;
+    memset( &status, 0, sizeof( status ) );
+    status.status_code  = RDAI_STATUS_ERROR;
+    status.error_reason = reason;
+    return status;
+}
+
+static inline RDAI_MemObject *null_mem_allocate( RDAI_MemObjectType, size_t, RDAI_Device * ) { return NULL; }
+static inline RDAI_Status null_mem_free( RDAI_MemObject * ) { return null_status_ok(); }
+static inline RDAI_Status null_mem_copy( RDAI_MemObject *, RDAI_MemObject * ) { return null_status_ok(); }
+static inline RDAI_MemObject *null_mem_crop( RDAI_MemObject *, size_t, size_t ) { return NULL; }
+static inline RDAI_Platform *null_platform_create( void ) { return &null_platform_creating->platform; }
+static inline RDAI_Status null_platform_destroy( RDAI_Platform * ) { return null_status_ok(); }
+static inline RDAI_Status null_platform_init( RDAI_Platform *, void * ) { return null_status_ok(); }
+static inline RDAI_Status null_device_init( RDAI_Device *, void * ) { return null_status_ok(); }
+static inline RDAI_Status null_device_run( RDAI_Device *, RDAI_MemObject ** ) { return null_status_ok(); }
+static inline RDAI_Status null_sync( RDAI_AsyncHandle * ) { return null_status_ok(); }
+
+// asynchronous ops hand back a handle of the platform, already complete
+static inline RDAI_Status null_status_async( RDAI_Platform *platform )
+{
+    RDAI_Status status = null_status_ok();
+    status.async_handle.platform = platform;
+    return status;
+}
+
+static inline RDAI_Status null_mem_copy_async( RDAI_MemObject *src, RDAI_MemObject *dest )
+{
+    RDAI_MemObject *device_mem = src->mem_type == RDAI_MEM_DEVICE ? src : dest;
+    return null_status_async( device_mem->device->platform );
+}
+
+static inline RDAI_Status null_device_run_async( RDAI_Device *device, RDAI_MemObject ** )
+{
+    return null_status_async( device->platform );
+}
+
+static inline void null_platform_setup( NullPlatform *np )
+{
+    memset( np, 0, sizeof( NullPlatform ) );
+    np->device.id.value   = 1;
+    np->device.platform   = &np->platform;
+    np->device.num_inputs = 1;
+    strncpy( np->device.vlnv.vendor.value, "rdai", RDAI_STRING_ID_LENGTH - 1 );
+    strncpy( np->device.vlnv.library.value, "bench", RDAI_STRING_ID_LENGTH - 1 );
+    strncpy( np->device.vlnv.name.value, "null", RDAI_STRING_ID_LENGTH - 1 );
+    np->device.vlnv.version = 1;
+    np->device_list[0]    = &np->device;
+    np->device_list[1]    = NULL;
+    np->platform.type        = RDAI_UNKNOWN_PLATFORM;
+    np->platform.device_list = np->device_list;
+
+    np->ops.mem_allocate     = null_mem_allocate;
+    np->ops.mem_free         = null_mem_free;
+    np->ops.mem_copy         = null_mem_copy;
+    np->ops.mem_copy_async   = null_mem_copy_async;
+    np->ops.mem_crop         = null_mem_crop;
+    np->ops.mem_free_crop    = null_mem_free;
+    np->ops.platform_create  = null_platform_create;
+    np->ops.platform_destroy = null_platform_destroy;
+    np->ops.platform_init    = null_platform_init;
+    np->ops.platform_deinit  = null_platform_init;
+    np->ops.device_init      = null_device_init;
+    np->ops.device_deinit    = null_device_init;
+    np->ops.device_run       = null_device_run;
+    np->ops.device_run_async = null_device_run_async;
+    np->ops.sync             = null_sync;
+}
+
+static inline RDAI_Platform *null_platform_register( NullPlatform *np )
+{
+    null_platform_creating = np;
+    RDAI_Platform *platform = RDAI_register_platform( &np->ops );
+    null_platform_creating = NULL;
+    return platform;
+}
+
+// ================= Timing
+
+typedef std::chrono::steady_clock bench_clock;
+
+static inline double bench_elapsed_ns( bench_clock::time_point start, bench_clock::time_point end )
+{
+    return std::chrono::duration<double, std::nano>( end - start ).count();
+}
+
+/**
+ * Run a callable a number of times and return the mean time per call in ns
+ */
+template <typename Callable>
+static inline double bench_ns_per_call( size_t iterations, Callable&& c )
+{
+    auto start = bench_clock::now();
+    for( size_t i = 0; i < iterations; i++ ) {
+        c( i );
+    }
+    auto end = bench_clock::now();
+    return bench_elapsed_ns( start, end ) / (double) iterations;
+}
+
+#endif // RDAI_BENCH_COMMON_H
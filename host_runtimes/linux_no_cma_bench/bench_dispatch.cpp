@@ -0,0 +1,115 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Per-call dispatch cost of the host runtime: flat platform table indexed
+// by platform ID versus the std::map<RDAI_Platform*, RDAI_PlatformOps*>
+// lookup the runtime used previously.
+
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include "bench_common.h"
+#include "platform_registry.h"
+
+static const size_t PLATFORM_COUNTS[] = { 1, 4, 16, 64 };
+static const size_t MAX_PLATFORMS = 64;
+
+static NullPlatform platforms[MAX_PLATFORMS];
+static NullPlatform private_platforms[MAX_PLATFORMS];   // of the private registry
+
+// the previous dispatch path of RDAI_Platform_Impl::device_run
+static RDAI_Status map_device_run( std::map<RDAI_Platform *, RDAI_PlatformOps *> &platform_to_ops,
+                                   RDAI_Device *device, RDAI_MemObject **mem_object_list )
+{
+    if( device && device->platform && mem_object_list ) {
+        size_t num_els = 0;
+        while( mem_object_list[num_els] ) num_els++;
+        if( num_els < 1 ) return null_status_error( RDAI_REASON_INVALID_BUFFER_COUNT );
+        RDAI_PlatformOps *ops = platform_to_ops[device->platform];
+        if( ops ) {
+            return ops->device_run( device, mem_object_list );
+        }
+    }
+    return null_status_error( RDAI_REASON_NO_PLATFORM_OPS );
+}
+
+int main( int argc, char *argv[] )
+{
+    size_t iterations = (argc > 1) ? strtoull( argv[1], NULL, 10 ) : 10000000;
+
+    RDAI_MemObject output;
+    memset( &output, 0, sizeof( output ) );
+    RDAI_MemObject *mem_obj_list[2] = { &output, NULL };
+
+    printf( "%-10s %14s %14s %16s %16s\n", "platforms", "map lookup", "table lookup",
+            "map device_run", "RDAI_device_run" );
+
+    for( size_t num_platforms : PLATFORM_COUNTS ) {
+        std::map<RDAI_Platform *, RDAI_PlatformOps *> platform_to_ops;
+        PlatformRegistry registry;
+        std::vector<RDAI_Device *> devices, private_devices;
+
+        for( size_t i = 0; i < num_platforms; i++ ) {
+            null_platform_setup( &platforms[i] );
+            RDAI_Platform *platform = null_platform_register( &platforms[i] );
+            if( !platform ) {
+                fprintf( stderr, "failed to register platform %zu\n", i );
+                return 1;
+            }
+            platform_to_ops[platform] = &platforms[i].ops;
+            devices.push_back( &platforms[i].device );
+        }
+        // a private registry, with platforms of its own, so that the raw
+        // lookup can be timed in isolation
+        for( size_t i = 0; i < num_platforms; i++ ) {
+            null_platform_setup( &private_platforms[i] );
+            null_platform_creating = &private_platforms[i];
+            RDAI_Platform *platform = registry.add( &private_platforms[i].ops );
+            null_platform_creating = NULL;
+            if( !platform ) {
+                fprintf( stderr, "failed to add platform %zu to the private registry\n", i );
+                return 1;
+            }
+            private_devices.push_back( &private_platforms[i].device );
+        }
+
+        volatile uintptr_t sink = 0;
+        double map_lookup = bench_ns_per_call( iterations, [&]( size_t i ) {
+                    sink = sink + (uintptr_t) platform_to_ops[devices[i % num_platforms]->platform];
+                });
+        double table_lookup = bench_ns_per_call( iterations, [&]( size_t i ) {
+                    PlatformRegistry::ReadGuard guard( registry );
+                    sink = sink + (uintptr_t) registry.find_ops( private_devices[i % num_platforms]->platform );
+                });
+        double map_run = bench_ns_per_call( iterations, [&]( size_t i ) {
+                    sink = sink + map_device_run( platform_to_ops, devices[i % num_platforms], mem_obj_list ).status_code;
+                });
+        double table_run = bench_ns_per_call( iterations, [&]( size_t i ) {
+                    sink = sink + RDAI_device_run( devices[i % num_platforms], mem_obj_list ).status_code;
+                });
+
+        printf( "%-10zu %11.2f ns %11.2f ns %13.2f ns %13.2f ns\n", num_platforms,
+                map_lookup, table_lookup, map_run, table_run );
+
+        for( size_t i = 0; i < num_platforms; i++ ) {
+            RDAI_unregister_platform( &platforms[i].platform );
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Frame latency breakdown (see RDAI_frame_begin) of an image pipeline:
+// each frame copies its input into a staging buffer, runs on a device
+// whose runs take RUN_US, and copies the result out. FRAMES frames go
+// through the pipeline twice: one at a time, then with the input copy of
+// the next frame overlapping the run of the current one. Pipelining
+// finishes frames more often, but each frame lives longer: its input is
+// copied one run ahead. The second report is also written to a file with
+// RDAI_dump_frame_report. Ends with the cost of a frame around a run on a
+// null platform.
+//
+// usage: bench_frame_report [iterations] [report file, bench_frame_report.txt by default]
+
+#include <cstdlib>
+#include <thread>
+
+#include "bench_common.h"
+
+static const unsigned RUN_US        = 2000;
+static const size_t FRAMES          = 64;
+static const size_t FRAME_SIZE      = 4u << 20;
+
+static const char *stage_names[RDAI_NUM_FRAME_STAGES] = {
+    "input_copy", "queue_wait", "compute", "output_copy", "sync_wakeup", "total",
+};
+
+static RDAI_Status sleep_device_run( RDAI_Device *, RDAI_MemObject ** )
+{
+    std::this_thread::sleep_for( std::chrono::microseconds( RUN_US ) );
+    return null_status_ok();
+}
+
+static void print_report()
+{
+    printf( "%-12s %8s %10s %10s %10s %10s   (us)\n", "stage", "frames", "mean", "p50", "p90", "p99" );
+    for( int s = 0; s < RDAI_NUM_FRAME_STAGES; s++ ) {
+        RDAI_OpStats stats;
+        RDAI_get_frame_stats( (RDAI_FrameStage) s, &stats );
+        printf( "%-12s %8llu %10.1f %10.1f %10.1f %10.1f\n", stage_names[s], (unsigned long long) stats.count,
+                stats.mean_ns / 1e3, stats.p50_ns / 1e3, stats.p90_ns / 1e3, stats.p99_ns / 1e3 );
+    }
+    printf( "\n" );
+}
+
+int main( int argc, char *argv[] )
+{
+    size_t iterations = (argc > 1) ? strtoull( argv[1], NULL, 10 ) : 100000;
+    const char *report_path = (argc > 2) ? argv[2] : "bench_frame_report.txt";
+
+    NullPlatform np, sleeper;
+    null_platform_setup( &np );
+    null_platform_setup( &sleeper );
+    sleeper.device.id.value = 2;
+    sleeper.ops.device_run  = sleep_device_run;
+    sleeper.ops.device_run_async = NULL;      // asynchronous runs execute the run above
+    if( !null_platform_register( &np ) || !null_platform_register( &sleeper ) ) {
+        fprintf( stderr, "could not register the null platforms\n" );
+        return 1;
+    }
+
+    RDAI_MemObject *input  = RDAI_mem_host_allocate( FRAME_SIZE );
+    RDAI_MemObject *output = RDAI_mem_host_allocate( FRAME_SIZE );
+    RDAI_MemObject *staging[2] = { RDAI_mem_shared_allocate( FRAME_SIZE ), RDAI_mem_shared_allocate( FRAME_SIZE ) };
+    if( !input || !output || !staging[0] || !staging[1] ) {
+        fprintf( stderr, "allocation failed\n" );
+        return 1;
+    }
+    memset( input->host_ptr, 0x5a, FRAME_SIZE );
+
+    // one frame at a time
+    auto start = bench_clock::now();
+    for( uint64_t f = 1; f <= FRAMES; f++ ) {
+        RDAI_MemObject *mem_object_list[2] = { staging[0], NULL };
+        RDAI_frame_begin( f );
+        RDAI_mem_copy( input, staging[0] );
+        RDAI_AsyncHandle run = RDAI_device_run_async( &sleeper.device, mem_object_list ).async_handle;
+        RDAI_sync( &run );
+        RDAI_mem_copy( staging[0], output );
+        RDAI_frame_end( f );
+    }
+    double serial_ms = bench_elapsed_ns( start, bench_clock::now() ) / 1e6;
+    printf( "one frame at a time: %zu frames in %.1f ms\n", FRAMES, serial_ms );
+    print_report();
+    RDAI_reset_frame_stats();
+
+    // pipelined: the input copy of frame f + 1 is issued during the run of frame f
+    start = bench_clock::now();
+    RDAI_frame_begin( 1 );
+    RDAI_AsyncHandle copy = RDAI_mem_copy_async( input, staging[0] ).async_handle;
+    for( uint64_t f = 1; f <= FRAMES; f++ ) {
+        RDAI_MemObject *mem_object_list[2] = { staging[(f + 1) & 1], NULL };
+        RDAI_frame_select( f );
+        RDAI_sync( &copy );
+        RDAI_AsyncHandle run = RDAI_device_run_async( &sleeper.device, mem_object_list ).async_handle;
+        if( f < FRAMES ) {
+            RDAI_frame_begin( f + 1 );
+            copy = RDAI_mem_copy_async( input, staging[f & 1] ).async_handle;
+            RDAI_frame_select( f );
+        }
+        RDAI_sync( &run );
+        RDAI_mem_copy( staging[(f + 1) & 1], output );
+        RDAI_frame_end( f );
+    }
+    double pipelined_ms = bench_elapsed_ns( start, bench_clock::now() ) / 1e6;
+    printf( "pipelined: %zu frames in %.1f ms\n", FRAMES, pipelined_ms );
+    print_report();
+    RDAI_Status status = RDAI_dump_frame_report( report_path );
+    printf( "%s %s\n\n", status.status_code == RDAI_STATUS_OK ? "wrote" : "could not write", report_path );
+
+    RDAI_MemObject *mem_object_list[2] = { output, NULL };
+    double run_ns = bench_ns_per_call( iterations, [&]( size_t ) {
+                RDAI_device_run( &np.device, mem_object_list );
+            });
+    double framed_ns = bench_ns_per_call( iterations, [&]( size_t i ) {
+                RDAI_frame_begin( i + 1 );
+                RDAI_device_run( &np.device, mem_object_list );
+                RDAI_frame_end( i + 1 );
+            });
+    printf( "device_run on a null platform: %.1f ns, in a frame of its own: %.1f ns\n", run_ns, framed_ns );
+
+    RDAI_mem_free( input );
+    RDAI_mem_free( output );
+    RDAI_mem_free( staging[0] );
+    RDAI_mem_free( staging[1] );
+    return 0;
+}
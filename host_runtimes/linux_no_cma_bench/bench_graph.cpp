@@ -0,0 +1,139 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Per-frame cost of a small inference pipeline on the null platform: the
+// calls made one by one, the same calls captured once into a graph and
+// launched, and the graph launched with its input and output rebound to a
+// rotating set of frame buffers.
+//
+// A frame copies a 4 KiB host input into a shared staging buffer, uploads it
+// to the device, runs LAYERS device runs and downloads the result.
+//
+// usage: bench_graph [frames]
+
+#include <cstdlib>
+
+#include "bench_common.h"
+
+static const size_t FRAME_SIZE = 4096;
+static const size_t LAYERS     = 4;
+static const size_t NUM_FRAME_BUFFERS = 4;
+
+static NullPlatform np;
+
+static RDAI_MemObject make_device_mem_object( RDAI_Device *device, size_t size )
+{
+    RDAI_MemObject mem_object;
+    memset( &mem_object, 0, sizeof( mem_object ) );
+    mem_object.mem_type  = RDAI_MEM_DEVICE;
+    mem_object.view_type = RDAI_VIEW_FULL;
+    mem_object.device    = device;
+    mem_object.size      = size;
+    return mem_object;
+}
+
+struct Pipeline
+{
+    RDAI_MemObject *input;
+    RDAI_MemObject *staging;
+    RDAI_MemObject *output;
+    RDAI_MemObject device_mem[LAYERS + 1];
+    RDAI_MemObject *run_lists[LAYERS][3];
+
+    RDAI_Status frame()
+    {
+        RDAI_Status status = RDAI_mem_copy( input, staging );
+        if( status.status_code != RDAI_STATUS_OK ) return status;
+        status = RDAI_mem_copy( staging, &device_mem[0] );
+        if( status.status_code != RDAI_STATUS_OK ) return status;
+        for( size_t l = 0; l < LAYERS; l++ ) {
+            status = RDAI_device_run( &np.device, run_lists[l] );
+            if( status.status_code != RDAI_STATUS_OK ) return status;
+        }
+        return RDAI_mem_copy( &device_mem[LAYERS], output );
+    }
+};
+
+int main( int argc, char *argv[] )
+{
+    size_t frames = (argc > 1) ? strtoull( argv[1], NULL, 10 ) : 1000000;
+
+    null_platform_setup( &np );
+    if( !null_platform_register( &np ) ) {
+        fprintf( stderr, "could not register the null platform\n" );
+        return 1;
+    }
+
+    Pipeline p;
+    p.input   = RDAI_mem_host_allocate( FRAME_SIZE );
+    p.staging = RDAI_mem_shared_allocate( FRAME_SIZE );
+    p.output  = RDAI_mem_host_allocate( FRAME_SIZE );
+    if( !p.input || !p.staging || !p.output ) {
+        fprintf( stderr, "allocation failed\n" );
+        return 1;
+    }
+    for( size_t l = 0; l <= LAYERS; l++ ) p.device_mem[l] = make_device_mem_object( &np.device, FRAME_SIZE );
+    for( size_t l = 0; l < LAYERS; l++ ) {
+        p.run_lists[l][0] = &p.device_mem[l];
+        p.run_lists[l][1] = &p.device_mem[l + 1];
+        p.run_lists[l][2] = NULL;
+    }
+    RDAI_MemObject *inputs[NUM_FRAME_BUFFERS], *outputs[NUM_FRAME_BUFFERS];
+    for( size_t b = 0; b < NUM_FRAME_BUFFERS; b++ ) {
+        inputs[b]  = RDAI_mem_host_allocate( FRAME_SIZE );
+        outputs[b] = RDAI_mem_host_allocate( FRAME_SIZE );
+        if( !inputs[b] || !outputs[b] ) {
+            fprintf( stderr, "allocation failed\n" );
+            return 1;
+        }
+    }
+
+    RDAI_graph_begin_capture();
+    RDAI_Status status = p.frame();
+    RDAI_Graph *graph = RDAI_graph_end_capture();
+    if( status.status_code != RDAI_STATUS_OK || !graph ) {
+        fprintf( stderr, "capture failed\n" );
+        return 1;
+    }
+
+    double direct = bench_ns_per_call( frames, [&]( size_t ) { p.frame(); } );
+    double launch = bench_ns_per_call( frames, [&]( size_t ) { RDAI_graph_launch( graph, NULL, 0 ); } );
+    double rebind = bench_ns_per_call( frames, [&]( size_t i ) {
+                RDAI_GraphBinding bindings[2] = {
+                    { p.input, inputs[i % NUM_FRAME_BUFFERS] },
+                    { p.output, outputs[i % NUM_FRAME_BUFFERS] },
+                };
+                RDAI_graph_launch( graph, bindings, 2 );
+            });
+
+    printf( "%zu calls per frame, %zu frames\n", LAYERS + 3, frames );
+    printf( "%-16s %12s\n", "", "ns/frame" );
+    printf( "%-16s %12.1f\n", "direct calls", direct );
+    printf( "%-16s %12.1f\n", "graph launch", launch );
+    printf( "%-16s %12.1f\n", "graph rebound", rebind );
+
+    RDAI_graph_destroy( graph );
+    for( size_t b = 0; b < NUM_FRAME_BUFFERS; b++ ) {
+        RDAI_mem_free( inputs[b] );
+        RDAI_mem_free( outputs[b] );
+    }
+    RDAI_mem_free( p.input );
+    RDAI_mem_free( p.staging );
+    RDAI_mem_free( p.output );
+    return 0;
+}
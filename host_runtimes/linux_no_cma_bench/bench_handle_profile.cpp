@@ -0,0 +1,110 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Handle profiles (see RDAI_get_handle_profile). Submits a burst of async
+// runs to a device whose runs take RUN_US, so that each run waits for the
+// ones before it, and splits the life of every run into its queueing delay
+// (queued to submitted), its host-side dispatch (submitted to started), its
+// device execution (started to ended) and its completion (ended to
+// completed). The device reports device times: SETUP_US of host work
+// precede the RUN_US of each run on the "device". Also times an async run
+// and sync on a null platform, which includes the cost of the profile.
+//
+// usage: bench_handle_profile [iterations]
+
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include "bench_common.h"
+
+static const unsigned SETUP_US  = 200;
+static const unsigned RUN_US    = 1000;
+static const size_t BURST       = 16;
+
+static uint64_t monotonic_ns()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+static RDAI_Status timed_device_run( RDAI_Device *, RDAI_MemObject ** )
+{
+    std::this_thread::sleep_for( std::chrono::microseconds( SETUP_US ) );
+    uint64_t started_ns = monotonic_ns();
+    std::this_thread::sleep_for( std::chrono::microseconds( RUN_US ) );
+    RDAI_set_handle_device_times( NULL, started_ns, monotonic_ns() );
+    return null_status_ok();
+}
+
+int main( int argc, char *argv[] )
+{
+    size_t iterations = (argc > 1) ? strtoull( argv[1], NULL, 10 ) : 100000;
+
+    NullPlatform np, timed;
+    null_platform_setup( &np );
+    null_platform_setup( &timed );
+    timed.device.id.value = 2;
+    timed.ops.device_run  = timed_device_run;
+    timed.ops.device_run_async = NULL;      // asynchronous runs execute the run above
+    if( !null_platform_register( &np ) || !null_platform_register( &timed ) ) {
+        fprintf( stderr, "could not register the null platforms\n" );
+        return 1;
+    }
+
+    RDAI_MemObject *dest = RDAI_mem_host_allocate( 64 );
+    RDAI_MemObject *mem_object_list[2] = { dest, NULL };
+    RDAI_HandleProfile profile;
+    double async_ns = bench_ns_per_call( iterations, [&]( size_t ) {
+                RDAI_Status status = RDAI_device_run_async( &np.device, mem_object_list );
+                RDAI_sync( &status.async_handle );
+            });
+    double profiled_ns = bench_ns_per_call( iterations, [&]( size_t ) {
+                RDAI_Status status = RDAI_device_run_async( &np.device, mem_object_list );
+                RDAI_sync( &status.async_handle );
+                RDAI_get_handle_profile( &status.async_handle, &profile );
+            });
+    printf( "device_run_async + sync: %.1f ns, with RDAI_get_handle_profile: %.1f ns\n\n", async_ns, profiled_ns );
+
+    std::vector<RDAI_AsyncHandle> handles;
+    for( size_t i = 0; i < BURST; i++ ) {
+        handles.push_back( RDAI_device_run_async( &timed.device, mem_object_list ).async_handle );
+    }
+    printf( "%u us of setup then %u us on the device per run, %zu runs submitted at once (us):\n",
+            SETUP_US, RUN_US, BURST );
+    printf( "%4s %10s %10s %10s %10s %10s\n", "run", "queued", "dispatch", "device", "complete", "total" );
+    for( size_t i = 0; i < BURST; i++ ) {
+        RDAI_sync( &handles[i] );
+        if( RDAI_get_handle_profile( &handles[i], &profile ).status_code != RDAI_STATUS_OK ) {
+            printf( "%4zu no profile\n", i );
+            continue;
+        }
+        printf( "%4zu %10.1f %10.1f %10.1f %10.1f %10.1f%s\n", i,
+                (profile.submitted_ns - profile.queued_ns) / 1e3,
+                (profile.started_ns - profile.submitted_ns) / 1e3,
+                (profile.ended_ns - profile.started_ns) / 1e3,
+                (profile.completed_ns - profile.ended_ns) / 1e3,
+                (profile.completed_ns - profile.queued_ns) / 1e3,
+                (profile.flags & RDAI_PROFILE_DEVICE_TIMES) ? "" : "   (host times)" );
+    }
+
+    RDAI_mem_free( dest );
+    return 0;
+}
@@ -0,0 +1,89 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Bring-up of several platforms whose platform_init is slow (standing in for
+// a bitstream load): each platform sleeps for its own init time. The
+// platforms are initialized one after the other with RDAI_platform_init,
+// then all at once with RDAI_platform_init_async, reporting when the first
+// platform is ready (RDAI_wait_any), when all of them are, and the init
+// latency of each platform.
+//
+// usage: bench_init [init ms of platform 0] [init ms of platform 1] ...
+
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "bench_common.h"
+
+static RDAI_Status sleep_platform_init( RDAI_Platform *, void *user_data )
+{
+    std::this_thread::sleep_for( std::chrono::milliseconds( *(unsigned *) user_data ) );
+    return null_status_ok();
+}
+
+int main( int argc, char *argv[] )
+{
+    std::vector<unsigned> init_ms = { 200, 50, 150, 100 };
+    if( argc > 1 ) {
+        init_ms.clear();
+        for( int i = 1; i < argc; i++ ) init_ms.push_back( (unsigned) strtoul( argv[i], NULL, 10 ) );
+    }
+    size_t count = init_ms.size();
+
+    std::vector<NullPlatform> platforms( count );
+    std::vector<RDAI_Platform *> registered( count );
+    for( size_t i = 0; i < count; i++ ) {
+        null_platform_setup( &platforms[i] );
+        platforms[i].ops.platform_init = sleep_platform_init;
+        registered[i] = null_platform_register( &platforms[i] );
+        if( !registered[i] ) {
+            fprintf( stderr, "could not register null platform %zu\n", i );
+            return 1;
+        }
+    }
+
+    auto start = bench_clock::now();
+    for( size_t i = 0; i < count; i++ ) RDAI_platform_init( registered[i], &init_ms[i] );
+    double sequential_ms = bench_elapsed_ns( start, bench_clock::now() ) / 1e6;
+
+    std::vector<RDAI_AsyncHandle> handles( count );
+    start = bench_clock::now();
+    for( size_t i = 0; i < count; i++ ) {
+        handles[i] = RDAI_platform_init_async( registered[i], &init_ms[i] ).async_handle;
+    }
+    size_t first;
+    RDAI_wait_any( handles.data(), count, -1, &first );
+    double first_ms = bench_elapsed_ns( start, bench_clock::now() ) / 1e6;
+    RDAI_sync_all( handles.data(), count );
+    double all_ms = bench_elapsed_ns( start, bench_clock::now() ) / 1e6;
+
+    printf( "%zu platforms\n", count );
+    printf( "sequential init:     %10.1f ms\n", sequential_ms );
+    printf( "async, first ready:  %10.1f ms  (platform %zu)\n", first_ms, first );
+    printf( "async, all ready:    %10.1f ms\n\n", all_ms );
+    printf( "%-10s %12s %12s\n", "platform", "init ms", "latency ms" );
+    for( size_t i = 0; i < count; i++ ) {
+        uint64_t latency_ns = 0;
+        RDAI_get_platform_init_latency( registered[i], &latency_ns );
+        printf( "%-10zu %12u %12.1f\n", i, init_ms[i], latency_ns / 1e6 );
+    }
+
+    for( size_t i = 0; i < count; i++ ) RDAI_unregister_platform( registered[i] );
+    return 0;
+}
@@ -0,0 +1,77 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Per-run overhead of the host runtime on the null platform: RDAI_device_run,
+// which validates its arguments and looks up the platform ops on every call,
+// versus RDAI_launch_run on a descriptor validated once. The asynchronous
+// variants are measured with one RDAI_sync per run.
+//
+// usage: bench_launch [iterations]
+
+#include <cstdlib>
+
+#include "bench_common.h"
+
+static const size_t NUM_INPUTS = 4;
+
+int main( int argc, char *argv[] )
+{
+    size_t iterations = (argc > 1) ? strtoull( argv[1], NULL, 10 ) : 10000000;
+
+    NullPlatform np;
+    null_platform_setup( &np );
+    if( !null_platform_register( &np ) ) {
+        fprintf( stderr, "could not register the null platform\n" );
+        return 1;
+    }
+
+    RDAI_MemObject mem_objects[NUM_INPUTS + 1];
+    RDAI_MemObject *mem_object_list[NUM_INPUTS + 2];
+    memset( mem_objects, 0, sizeof( mem_objects ) );
+    for( size_t i = 0; i <= NUM_INPUTS; i++ ) mem_object_list[i] = &mem_objects[i];
+    mem_object_list[NUM_INPUTS + 1] = NULL;
+
+    RDAI_Launch *launch = RDAI_launch_create( &np.device, mem_object_list, NUM_INPUTS + 1 );
+    if( !launch ) {
+        fprintf( stderr, "could not create the launch\n" );
+        return 1;
+    }
+
+    double run = bench_ns_per_call( iterations, [&]( size_t ) {
+                RDAI_device_run( &np.device, mem_object_list );
+            });
+    double launch_run = bench_ns_per_call( iterations, [&]( size_t ) {
+                RDAI_launch_run( launch );
+            });
+    size_t async_iterations = iterations / 100 ? iterations / 100 : 1;
+    double run_async = bench_ns_per_call( async_iterations, [&]( size_t ) {
+                RDAI_Status status = RDAI_device_run_async( &np.device, mem_object_list );
+                RDAI_sync( &status.async_handle );
+            });
+    double launch_run_async = bench_ns_per_call( async_iterations, [&]( size_t ) {
+                RDAI_Status status = RDAI_launch_run_async( launch );
+                RDAI_sync( &status.async_handle );
+            });
+
+    printf( "%-12s %14s %14s   (ns/run, %zu inputs)\n", "", "device_run", "launch_run", NUM_INPUTS );
+    printf( "%-12s %14.1f %14.1f\n", "sync", run, launch_run );
+    printf( "%-12s %14.1f %14.1f\n", "async+sync", run_async, launch_run_async );
+
+    RDAI_launch_destroy( launch );
+    return 0;
+}
@@ -0,0 +1,104 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Cost of a per-frame allocate/touch/free cycle of host memory objects:
+// the pooled RDAI_mem_host_allocate versus the previous header + payload
+// malloc pair. Every page of the payload is written, so that page faults
+// taken on fresh memory are part of the measurement.
+//
+// usage: bench_mem_alloc [iterations] [threads]
+
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "bench_common.h"
+
+static const size_t SIZES[] = { 64, 4096, 65536, 1 << 20, 8 << 20 };
+static const size_t BUFFERS_PER_FRAME = 4;
+
+static void touch( uint8_t *p, size_t size )
+{
+    for( size_t off = 0; off < size; off += 4096 ) p[off] = (uint8_t) off;
+    p[size - 1] = 1;
+}
+
+// the previous RDAI_Platform_Impl::mem_host_allocate / mem_free pair
+static RDAI_MemObject *malloc_allocate( size_t size )
+{
+    RDAI_MemObject *mem_obj = (RDAI_MemObject *) malloc( sizeof( RDAI_MemObject ) );
+    if( mem_obj ) {
+        memset( mem_obj, 0, sizeof( RDAI_MemObject ) );
+        mem_obj->host_ptr = (uint8_t *) malloc( size );
+        mem_obj->size = size;
+    }
+    return mem_obj;
+}
+
+static void malloc_free( RDAI_MemObject *mem_obj )
+{
+    free( mem_obj->host_ptr );
+    free( mem_obj );
+}
+
+template <typename Alloc, typename Free>
+static double frame_ns( size_t size, size_t iterations, size_t threads, Alloc&& alloc, Free&& release )
+{
+    auto run = [&]() {
+        RDAI_MemObject *frame[BUFFERS_PER_FRAME];
+        for( size_t i = 0; i < iterations; i++ ) {
+            for( size_t b = 0; b < BUFFERS_PER_FRAME; b++ ) {
+                frame[b] = alloc( size );
+                touch( frame[b]->host_ptr, size );
+            }
+            for( size_t b = 0; b < BUFFERS_PER_FRAME; b++ ) release( frame[b] );
+        }
+    };
+    auto start = bench_clock::now();
+    std::vector<std::thread> workers;
+    for( size_t t = 1; t < threads; t++ ) workers.emplace_back( run );
+    run();
+    for( auto &w : workers ) w.join();
+    return bench_elapsed_ns( start, bench_clock::now() ) / (double)( iterations * threads );
+}
+
+int main( int argc, char *argv[] )
+{
+    size_t iterations = (argc > 1) ? strtoull( argv[1], NULL, 10 ) : 2000;
+    size_t threads    = (argc > 2) ? strtoull( argv[2], NULL, 10 ) : 1;
+    if( threads < 1 ) threads = 1;
+
+    printf( "%zu thread(s), %zu buffers per frame\n", threads, BUFFERS_PER_FRAME );
+    printf( "%-10s %16s %16s %10s\n", "size", "malloc ns/frame", "pool ns/frame", "speedup" );
+
+    for( size_t size : SIZES ) {
+        double m = frame_ns( size, iterations, threads, malloc_allocate, malloc_free );
+        double p = frame_ns( size, iterations, threads, RDAI_mem_host_allocate, RDAI_mem_free );
+        printf( "%-10zu %16.0f %16.0f %9.2fx\n", size, m, p, m / p );
+    }
+
+    RDAI_MemPoolStats stats;
+    RDAI_mem_pool_get_stats( &stats );
+    printf( "\npool: hits %llu, misses %llu, bytes held %llu, bytes in use %llu\n",
+            (unsigned long long) stats.hits, (unsigned long long) stats.misses,
+            (unsigned long long) stats.bytes_held, (unsigned long long) stats.bytes_in_use );
+    RDAI_mem_pool_trim();
+    RDAI_mem_pool_get_stats( &stats );
+    printf( "after trim: bytes held %llu\n", (unsigned long long) stats.bytes_held );
+    return 0;
+}
@@ -0,0 +1,153 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Host copy bandwidth from 4 KiB to 1 GiB: plain memcpy, each CopyEngine
+// strategy forced, and RDAI_mem_copy between a HOST and a SHARED object
+// (which picks the strategy from the thresholds calibrated by the bench,
+// passed on to the runtime). Sizes whose buffers cannot be allocated are
+// skipped. Every strategy is first checked to copy the exact bytes, with
+// unaligned heads and tails; the bench exits with 1 if one does not.
+//
+// usage: bench_mem_copy [max size in MiB]
+
+#include <cstdlib>
+
+#include "bench_common.h"
+#include "copy_engine.h"
+
+// bytes copied per measurement, so that small sizes are repeated enough
+static const size_t BYTES_PER_POINT = 512u << 20;
+
+template <typename Callable>
+static double copy_gbps( size_t size, Callable&& c )
+{
+    size_t reps = BYTES_PER_POINT / size;
+    if( reps < 2 ) reps = 2;
+    c();    // warm up: page faults stay out of the measurement
+    double ns = bench_ns_per_call( reps, [&]( size_t ) { c(); } );
+    return (double) size / ns;
+}
+
+// every strategy copies exactly the bytes asked, whatever the alignment of
+// both ends: checked against a pattern, with guard bytes around the copy
+static bool check_copies( CopyEngine &engine )
+{
+    const size_t sizes[] = { 1, 15, 63, 255, 4096 + 33, (64u << 10) + 7, (4u << 20) + 129 };
+    const size_t offsets[] = { 0, 1, 17, 63 };
+    const CopyEngine::Strategy strategies[] = {
+        CopyEngine::COPY_MEMCPY, CopyEngine::COPY_STREAM, CopyEngine::COPY_PARALLEL
+    };
+    const char *names[] = { "memcpy", "stream", "parallel" };
+    const size_t guard = 64;
+    const size_t max_size = (4u << 20) + 129;
+    const size_t buffer_size = (max_size + 64 + 2 * guard + 4095) & ~(size_t) 4095;
+
+    uint8_t *src  = (uint8_t *) aligned_alloc( 4096, buffer_size );
+    uint8_t *dest = (uint8_t *) aligned_alloc( 4096, buffer_size );
+    if( !src || !dest ) {
+        fprintf( stderr, "allocation failed\n" );
+        free( src );
+        free( dest );
+        return false;
+    }
+    for( size_t i = 0; i < buffer_size; i++ ) src[i] = (uint8_t) (i * 131 + 7);
+
+    bool ok = true;
+    for( size_t k = 0; k < 3 && ok; k++ ) {
+        for( size_t size : sizes ) {
+            for( size_t src_offset : offsets ) {
+                for( size_t dest_offset : offsets ) {
+                    uint8_t *d = dest + guard + dest_offset;
+                    memset( d - guard, 0xee, size + 2 * guard );
+                    engine.copy( d, src + src_offset, size, strategies[k] );
+                    bool copied = memcmp( d, src + src_offset, size ) == 0;
+                    for( size_t i = 1; i <= guard && copied; i++ ) {
+                        copied = d[-(ptrdiff_t) i] == 0xee && d[size + i - 1] == 0xee;
+                    }
+                    if( !copied ) {
+                        fprintf( stderr, "%s copy of %zu bytes (src +%zu, dest +%zu) is wrong\n",
+                                 names[k], size, src_offset, dest_offset );
+                        ok = false;
+                    }
+                }
+            }
+        }
+    }
+    free( src );
+    free( dest );
+    return ok;
+}
+
+static const char *size_label( size_t size, char *buf, size_t len )
+{
+    if( size >= (1u << 30) ) snprintf( buf, len, "%zuG", size >> 30 );
+    else if( size >= (1u << 20) ) snprintf( buf, len, "%zuM", size >> 20 );
+    else snprintf( buf, len, "%zuK", size >> 10 );
+    return buf;
+}
+
+int main( int argc, char *argv[] )
+{
+    size_t max_size = ((argc > 1) ? strtoull( argv[1], NULL, 10 ) : 1024) << 20;
+
+    WorkerPool workers;
+    CopyEngine engine( workers );
+    if( !check_copies( engine ) ) return 1;
+
+    // the runtime takes the same thresholds, rather than calibrating in the
+    // background of the measurements
+    CopyEngine::Config config = engine.config();
+    char threshold[32];
+    snprintf( threshold, sizeof( threshold ), "%zu", config.stream_threshold );
+    setenv( "RDAI_COPY_STREAM_THRESHOLD", threshold, 1 );
+    snprintf( threshold, sizeof( threshold ), "%zu", config.parallel_threshold );
+    setenv( "RDAI_COPY_PARALLEL_THRESHOLD", threshold, 1 );
+
+    printf( "%-8s %10s %10s %10s %10s   (GB/s)\n", "size", "memcpy", "stream", "parallel", "mem_copy" );
+    for( size_t size = 4096; size <= max_size; size *= 4 ) {
+        char label[16];
+        RDAI_MemObject *src  = RDAI_mem_host_allocate( size );
+        RDAI_MemObject *dest = RDAI_mem_shared_allocate( size );
+        if( !src || !dest ) {
+            printf( "%-8s skipped (allocation failed)\n", size_label( size, label, sizeof( label ) ) );
+            if( src ) RDAI_mem_free( src );
+            if( dest ) RDAI_mem_free( dest );
+            continue;
+        }
+        memset( src->host_ptr, 0x5a, size );
+        memset( dest->host_ptr, 0, size );
+
+        double m = copy_gbps( size, [&]() { memcpy( dest->host_ptr, src->host_ptr, size ); } );
+        double s = copy_gbps( size, [&]() {
+                    engine.copy( dest->host_ptr, src->host_ptr, size, CopyEngine::COPY_STREAM );
+                });
+        double p = copy_gbps( size, [&]() {
+                    engine.copy( dest->host_ptr, src->host_ptr, size, CopyEngine::COPY_PARALLEL );
+                });
+        double r = copy_gbps( size, [&]() { RDAI_mem_copy( src, dest ); } );
+        printf( "%-8s %10.2f %10.2f %10.2f %10.2f\n", size_label( size, label, sizeof( label ) ), m, s, p, r );
+
+        RDAI_mem_free( src );
+        RDAI_mem_free( dest );
+    }
+
+    printf( "\ncalibration: isa %s, %zu worker(s), stream from %zd bytes, parallel from %zd bytes (-1: never)\n",
+            config.isa, config.num_threads, (ssize_t) config.stream_threshold,
+            (ssize_t) config.parallel_threshold );
+    return 0;
+}
@@ -0,0 +1,66 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Cost of loading a platform plugin: RDAI_load_platform_plugin (dlopen and
+// symbol lookup), the first platform lookup (which registers the plugin and
+// calls its platform_create) and the lookups after it.
+//
+// usage: bench_plugin [plugin path]
+
+#include <dlfcn.h>
+
+#include "bench_common.h"
+
+static const size_t LOOKUPS = 100000;
+
+int main( int argc, char *argv[] )
+{
+    const char *path = (argc > 1) ? argv[1] : "./libplugin_null.so";
+
+    auto start = bench_clock::now();
+    RDAI_Status status = RDAI_load_platform_plugin( path );
+    double load_ns = bench_elapsed_ns( start, bench_clock::now() );
+    if( status.status_code != RDAI_STATUS_OK ) {
+        fprintf( stderr, "could not load %s (reason %d)\n", path, (int) status.error_reason );
+        return 1;
+    }
+
+    // the plugin is already open: this only looks the counter up
+    void *library = dlopen( path, RTLD_NOW | RTLD_NOLOAD );
+    int *create_calls = library ? (int *) dlsym( library, "plugin_null_create_calls" ) : NULL;
+    int created_at_load = create_calls ? *create_calls : -1;
+
+    start = bench_clock::now();
+    RDAI_Platform **platforms = RDAI_get_all_platforms();
+    double first_ns = bench_elapsed_ns( start, bench_clock::now() );
+    size_t num_platforms = 0;
+    while( platforms && platforms[num_platforms] ) num_platforms++;
+    int created_at_lookup = create_calls ? *create_calls : -1;
+    RDAI_free_platform_list( platforms );
+
+    double lookup_ns = bench_ns_per_call( LOOKUPS, [&]( size_t ) {
+                RDAI_free_platform_list( RDAI_get_all_platforms() );
+            });
+
+    printf( "load_platform_plugin:   %10.1f us  (platform_create calls: %d)\n", load_ns / 1000.0, created_at_load );
+    printf( "first get_all_platforms %10.1f us  (platform_create calls: %d, %zu platform(s))\n",
+            first_ns / 1000.0, created_at_lookup, num_platforms );
+    printf( "get_all_platforms       %10.1f ns\n", lookup_ns );
+    if( library ) dlclose( library );
+    return 0;
+}
@@ -0,0 +1,126 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Latency of interactive runs mixed with a bulk background load on the same
+// device. A background thread keeps BULK_IN_FLIGHT runs queued on a null
+// device whose runs sleep for RUN_US, while the main thread submits one
+// run at a time and waits for it. Both are first submitted as
+// RDAI_PRIORITY_NORMAL, then as RDAI_PRIORITY_HIGH (interactive) and
+// RDAI_PRIORITY_LOW (bulk). The queue wait statistics of each class are
+// printed for both passes.
+//
+// usage: bench_priority [interactive runs]
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "bench_common.h"
+#include "latency_histogram.h"
+
+static const unsigned RUN_US        = 100;
+static const size_t BULK_IN_FLIGHT  = 32;
+
+static RDAI_Status sleep_device_run( RDAI_Device *, RDAI_MemObject ** )
+{
+    std::this_thread::sleep_for( std::chrono::microseconds( RUN_US ) );
+    return null_status_ok();
+}
+
+static void bulk_loop( RDAI_Device *device, RDAI_MemObject **mem_object_list, RDAI_Priority priority,
+                       std::atomic<bool> *stop, size_t *bulk_runs )
+{
+    std::vector<RDAI_AsyncHandle> handles( BULK_IN_FLIGHT );
+    for( auto &h : handles ) h = RDAI_device_run_async_prio( device, mem_object_list, priority ).async_handle;
+    size_t outstanding = BULK_IN_FLIGHT;
+    while( outstanding ) {
+        size_t index;
+        RDAI_wait_any( handles.data(), BULK_IN_FLIGHT, -1, &index );
+        (*bulk_runs)++;
+        if( stop->load() ) outstanding--;
+        else handles[index] = RDAI_device_run_async_prio( device, mem_object_list, priority ).async_handle;
+    }
+}
+
+static void print_wait_stats( const char *label )
+{
+    static const char *names[RDAI_NUM_PRIORITIES] = { "high", "normal", "low" };
+    for( int p = 0; p < RDAI_NUM_PRIORITIES; p++ ) {
+        RDAI_QueueWaitStats stats;
+        RDAI_get_queue_wait_stats( (RDAI_Priority) p, &stats );
+        if( !stats.count ) continue;
+        printf( "%-12s %-8s %10llu %12.1f %12.1f %12.1f %10llu\n", label, names[p],
+                (unsigned long long) stats.count, stats.p50_ns / 1000.0, stats.p99_ns / 1000.0,
+                stats.max_ns / 1000.0, (unsigned long long) stats.aged );
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    size_t runs = (argc > 1) ? strtoull( argv[1], NULL, 10 ) : 500;
+
+    NullPlatform np;
+    null_platform_setup( &np );
+    np.ops.device_run = sleep_device_run;
+    np.ops.device_run_async = NULL;      // asynchronous runs execute the run above
+    if( !null_platform_register( &np ) ) {
+        fprintf( stderr, "could not register the null platform\n" );
+        return 1;
+    }
+
+    RDAI_MemObject output;
+    memset( &output, 0, sizeof( output ) );
+    RDAI_MemObject *mem_object_list[2] = { &output, NULL };
+
+    printf( "run: %u us, %zu bulk runs in flight, %zu interactive runs\n\n", RUN_US, BULK_IN_FLIGHT, runs );
+    printf( "%-12s %12s %12s %12s\n", "interactive", "p50 us", "p99 us", "bulk run/s" );
+
+    const char *labels[2] = { "no classes", "high/low" };
+    for( int pass = 0; pass < 2; pass++ ) {
+        RDAI_Priority interactive = pass ? RDAI_PRIORITY_HIGH : RDAI_PRIORITY_NORMAL;
+        RDAI_Priority bulk = pass ? RDAI_PRIORITY_LOW : RDAI_PRIORITY_NORMAL;
+
+        RDAI_reset_queue_wait_stats();
+        std::atomic<bool> stop { false };
+        size_t bulk_runs = 0;
+        std::thread background( bulk_loop, &np.device, mem_object_list, bulk, &stop, &bulk_runs );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+
+        LatencyHistogram latency;
+        auto start = bench_clock::now();
+        for( size_t i = 0; i < runs; i++ ) {
+            auto submitted = bench_clock::now();
+            RDAI_Status status = RDAI_device_run_async_prio( &np.device, mem_object_list, interactive );
+            RDAI_sync( &status.async_handle );
+            latency.record( (uint64_t) bench_elapsed_ns( submitted, bench_clock::now() ) );
+            std::this_thread::sleep_for( std::chrono::microseconds( RUN_US ) );
+        }
+        double seconds = bench_elapsed_ns( start, bench_clock::now() ) / 1e9;
+        stop.store( true );
+        background.join();
+
+        printf( "%-12s %12.1f %12.1f %12.0f\n", labels[pass], latency.percentile( 0.5 ) / 1000.0,
+                latency.percentile( 0.99 ) / 1000.0, (double) bulk_runs / seconds );
+        printf( "\n%-12s %-8s %10s %12s %12s %12s %10s\n", "queue wait", "class", "count", "p50 us",
+                "p99 us", "max us", "aged" );
+        print_wait_stats( labels[pass] );
+        printf( "\n" );
+    }
+    return 0;
+}
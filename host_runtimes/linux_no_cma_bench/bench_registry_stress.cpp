@@ -0,0 +1,104 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Dispatch throughput of RDAI_device_run from 1 to N worker threads while a
+// control thread keeps registering and unregistering platforms.
+//
+// usage: bench_registry_stress [max_threads] [ms_per_step]
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "bench_common.h"
+
+static const size_t STABLE_PLATFORMS = 8;
+static const size_t CHURN_PLATFORMS  = 8;
+
+static NullPlatform stable[STABLE_PLATFORMS];
+static NullPlatform churn[CHURN_PLATFORMS];
+
+int main( int argc, char *argv[] )
+{
+    size_t max_threads = (argc > 1) ? strtoull( argv[1], NULL, 10 ) : std::thread::hardware_concurrency();
+    size_t step_ms     = (argc > 2) ? strtoull( argv[2], NULL, 10 ) : 500;
+    if( max_threads < 1 ) max_threads = 1;
+
+    for( size_t i = 0; i < STABLE_PLATFORMS; i++ ) {
+        null_platform_setup( &stable[i] );
+        if( !null_platform_register( &stable[i] ) ) {
+            fprintf( stderr, "failed to register platform %zu\n", i );
+            return 1;
+        }
+    }
+    for( size_t i = 0; i < CHURN_PLATFORMS; i++ ) null_platform_setup( &churn[i] );
+
+    printf( "%-8s %14s %18s %14s %10s\n", "threads", "runs/s", "runs/s/thread", "churn ops/s", "errors" );
+
+    for( size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2 ) {
+        std::atomic<bool> stop { false };
+        std::atomic<uint64_t> total_runs { 0 };
+        std::atomic<uint64_t> total_errors { 0 };
+        uint64_t churn_ops = 0;
+
+        std::vector<std::thread> workers;
+        for( size_t t = 0; t < num_threads; t++ ) {
+            workers.emplace_back( [&, t]() {
+                        RDAI_MemObject output;
+                        memset( &output, 0, sizeof( output ) );
+                        RDAI_MemObject *mem_obj_list[2] = { &output, NULL };
+                        uint64_t runs = 0, errors = 0;
+                        size_t i = t;
+                        while( !stop.load( std::memory_order_relaxed ) ) {
+                            for( int k = 0; k < 256; k++, i++ ) {
+                                RDAI_Status status = RDAI_device_run( &stable[i % STABLE_PLATFORMS].device, mem_obj_list );
+                                errors += (status.status_code != RDAI_STATUS_OK);
+                            }
+                            runs += 256;
+                        }
+                        total_runs += runs;
+                        total_errors += errors;
+                    });
+        }
+
+        // control thread: this one
+        auto start = bench_clock::now();
+        auto deadline = start + std::chrono::milliseconds( step_ms );
+        size_t c = 0;
+        while( bench_clock::now() < deadline ) {
+            NullPlatform *np = &churn[c % CHURN_PLATFORMS];
+            RDAI_Platform *platform = null_platform_register( np );
+            if( platform ) RDAI_unregister_platform( platform );
+            churn_ops += 2;
+            c++;
+        }
+        stop.store( true );
+        for( auto &w : workers ) w.join();
+        double secs = bench_elapsed_ns( start, bench_clock::now() ) / 1e9;
+
+        printf( "%-8zu %14.0f %18.0f %14.0f %10llu\n", num_threads,
+                total_runs / secs, total_runs / secs / num_threads, churn_ops / secs,
+                (unsigned long long) total_errors.load() );
+    }
+
+    for( size_t i = 0; i < STABLE_PLATFORMS; i++ ) {
+        RDAI_unregister_platform( &stable[i].platform );
+    }
+    return 0;
+}
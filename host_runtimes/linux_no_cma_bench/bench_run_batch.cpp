@@ -0,0 +1,73 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Cost of submitting many small runs on the null platform: one
+// RDAI_device_run_async per run followed by RDAI_sync_all, versus a single
+// RDAI_device_run_batch, both with the host runtime's device_run loop and
+// with a platform device_run_batch op.
+//
+// usage: bench_run_batch [repetitions]
+
+#include <cstdlib>
+#include <vector>
+
+#include "bench_common.h"
+
+static const size_t BATCH_SIZES[] = { 1, 16, 256, 1000 };
+
+static RDAI_Status null_device_run_batch( RDAI_Device *, RDAI_MemObject ***, size_t ) { return null_status_ok(); }
+
+int main( int argc, char *argv[] )
+{
+    size_t repetitions = (argc > 1) ? strtoull( argv[1], NULL, 10 ) : 200;
+
+    NullPlatform loop_np, batch_np;
+    null_platform_setup( &loop_np );
+    null_platform_setup( &batch_np );
+    batch_np.ops.device_run_batch = null_device_run_batch;
+    if( !null_platform_register( &loop_np ) || !null_platform_register( &batch_np ) ) {
+        fprintf( stderr, "could not register the null platforms\n" );
+        return 1;
+    }
+
+    RDAI_MemObject output;
+    memset( &output, 0, sizeof( output ) );
+    RDAI_MemObject *mem_object_list[2] = { &output, NULL };
+    std::vector<RDAI_MemObject **> lists( 1000, mem_object_list );
+    std::vector<RDAI_AsyncHandle> handles( 1000 );
+
+    printf( "%-8s %14s %14s %14s   (ns/run)\n", "runs", "run_async", "batch (loop)", "batch (op)" );
+    for( size_t count : BATCH_SIZES ) {
+        double async = bench_ns_per_call( repetitions, [&]( size_t ) {
+                    for( size_t i = 0; i < count; i++ ) {
+                        handles[i] = RDAI_device_run_async( &loop_np.device, lists[i] ).async_handle;
+                    }
+                    RDAI_sync_all( handles.data(), count );
+                });
+        double loop = bench_ns_per_call( repetitions, [&]( size_t ) {
+                    RDAI_Status status = RDAI_device_run_batch( &loop_np.device, lists.data(), count );
+                    RDAI_sync( &status.async_handle );
+                });
+        double op = bench_ns_per_call( repetitions, [&]( size_t ) {
+                    RDAI_Status status = RDAI_device_run_batch( &batch_np.device, lists.data(), count );
+                    RDAI_sync( &status.async_handle );
+                });
+        printf( "%-8zu %14.1f %14.1f %14.1f\n", count, async / count, loop / count, op / count );
+    }
+    return 0;
+}
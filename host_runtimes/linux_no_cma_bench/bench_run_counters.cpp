@@ -0,0 +1,171 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Host CPU counters of device runs (see RDAI_get_run_counters). Measures
+// what counting adds to a run on a null platform, then counts runs of two
+// CPU-emulated devices with opposite profiles: a compute device (a hash
+// loop in registers) and a memory device (a pointer chase through a buffer
+// larger than the last level cache). The compute device is registered
+// twice with the same VLNV, to show per-device and per-VLNV totals.
+// Hardware counters need a PMU the process may use (perf_event_paranoid
+// below 3 and, in a virtual machine, a virtual PMU); without one, only the
+// CPU time is reported.
+//
+// usage: bench_run_counters [iterations]
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "bench_common.h"
+
+static const size_t COMPUTE_STEPS   = 200000;
+static const size_t CHASE_SIZE      = 64u << 20;
+static const size_t CHASE_STEPS     = 200000;
+static const size_t DEVICE_RUNS     = 50;
+
+static volatile uint64_t sink;
+static std::vector<size_t> chase;
+
+static RDAI_Status compute_device_run( RDAI_Device *, RDAI_MemObject ** )
+{
+    uint64_t x = 0x9e3779b97f4a7c15ull;
+    for( size_t i = 0; i < COMPUTE_STEPS; i++ ) {
+        x ^= x >> 31;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x += (x & 1) ? i : ~i;      // a branch the predictor cannot learn
+    }
+    sink = x;
+    return null_status_ok();
+}
+
+static RDAI_Status memory_device_run( RDAI_Device *, RDAI_MemObject ** )
+{
+    size_t p = 0;
+    for( size_t i = 0; i < CHASE_STEPS; i++ ) p = chase[p];
+    sink = p;
+    return null_status_ok();
+}
+
+// one random cycle through all the slots, so that no prefetcher can follow
+static void chase_setup()
+{
+    size_t n = CHASE_SIZE / sizeof( size_t );
+    std::vector<size_t> order( n );
+    for( size_t i = 0; i < n; i++ ) order[i] = i;
+    std::shuffle( order.begin(), order.end(), std::mt19937_64( 42 ) );
+    chase.resize( n );
+    for( size_t i = 0; i < n; i++ ) chase[order[i]] = order[(i + 1) % n];
+}
+
+// a counter per run, or "-" when it was not measured
+static const char *per_run( const RDAI_RunCounters &c, uint32_t flag, uint64_t value, char *buf, size_t len )
+{
+    if( c.available & flag ) snprintf( buf, len, "%.0f", (double) value / (double) c.runs );
+    else snprintf( buf, len, "-" );
+    return buf;
+}
+
+static void print_counters( const char *label, const RDAI_RunCounters &c )
+{
+    if( !c.runs ) {
+        printf( "%-18s no runs counted\n", label );
+        return;
+    }
+    char cycles[32], instructions[32], ipc[32], llc[32], branch[32], cpu[32];
+    if( (c.available & RDAI_COUNTER_CYCLES) && (c.available & RDAI_COUNTER_INSTRUCTIONS) && c.cycles ) {
+        snprintf( ipc, sizeof( ipc ), "%.2f", (double) c.instructions / (double) c.cycles );
+    } else {
+        snprintf( ipc, sizeof( ipc ), "-" );
+    }
+    printf( "%-18s %6llu %12s %12s %6s %10s %10s %10s\n", label, (unsigned long long) c.runs,
+            per_run( c, RDAI_COUNTER_CYCLES, c.cycles, cycles, sizeof( cycles ) ),
+            per_run( c, RDAI_COUNTER_INSTRUCTIONS, c.instructions, instructions, sizeof( instructions ) ), ipc,
+            per_run( c, RDAI_COUNTER_LLC_MISSES, c.llc_misses, llc, sizeof( llc ) ),
+            per_run( c, RDAI_COUNTER_BRANCH_MISSES, c.branch_misses, branch, sizeof( branch ) ),
+            per_run( c, RDAI_COUNTER_CPU_TIME, c.cpu_time_ns, cpu, sizeof( cpu ) ) );
+}
+
+int main( int argc, char *argv[] )
+{
+    size_t iterations = (argc > 1) ? strtoull( argv[1], NULL, 10 ) : 200000;
+
+    NullPlatform np, compute[2], memory;
+    null_platform_setup( &np );
+    for( NullPlatform *p : { &compute[0], &compute[1], &memory } ) {
+        null_platform_setup( p );
+        p->device.id.value = 2;
+    }
+    strncpy( compute[0].device.vlnv.name.value, "compute", RDAI_STRING_ID_LENGTH - 1 );
+    strncpy( compute[1].device.vlnv.name.value, "compute", RDAI_STRING_ID_LENGTH - 1 );
+    strncpy( memory.device.vlnv.name.value, "memory", RDAI_STRING_ID_LENGTH - 1 );
+    compute[1].device.id.value = 3;
+    compute[0].ops.device_run = compute_device_run;
+    compute[1].ops.device_run = compute_device_run;
+    compute[1].ops.device_run_async = NULL;      // asynchronous runs execute the run above
+    memory.ops.device_run     = memory_device_run;
+    if( !null_platform_register( &np ) || !null_platform_register( &compute[0] ) ||
+        !null_platform_register( &compute[1] ) || !null_platform_register( &memory ) ) {
+        fprintf( stderr, "could not register the null platforms\n" );
+        return 1;
+    }
+    chase_setup();
+
+    // overhead of counting
+    RDAI_MemObject *dest = RDAI_mem_host_allocate( 64 );
+    RDAI_MemObject *mem_object_list[2] = { dest, NULL };
+    auto run = [&]( size_t ) { RDAI_device_run( &np.device, mem_object_list ); };
+    RDAI_set_run_counters( 0 );
+    double off_ns = bench_ns_per_call( iterations, run );
+    RDAI_set_run_counters( 1 );
+    double on_ns = bench_ns_per_call( iterations, run );
+    printf( "device_run on a null platform: %.1f ns uncounted, %.1f ns counted (+%.1f ns)\n\n",
+            off_ns, on_ns, on_ns - off_ns );
+
+    RDAI_reset_run_counters();
+    for( size_t i = 0; i < DEVICE_RUNS; i++ ) {
+        RDAI_device_run( &compute[0].device, mem_object_list );
+        RDAI_device_run( &memory.device, mem_object_list );
+    }
+    // the second compute device runs asynchronously, on its device thread
+    for( size_t i = 0; i < DEVICE_RUNS; i++ ) {
+        RDAI_Status status = RDAI_device_run_async( &compute[1].device, mem_object_list );
+        RDAI_sync( &status.async_handle );
+    }
+
+    RDAI_RunCounters c;
+    printf( "%-18s %6s %12s %12s %6s %10s %10s %10s   (per run)\n", "", "runs", "cycles", "instructions",
+            "IPC", "LLC miss", "br miss", "cpu ns" );
+    RDAI_get_run_counters( &compute[0].device, NULL, &c );
+    print_counters( "compute device 2", c );
+    RDAI_get_run_counters( &compute[1].device, NULL, &c );
+    print_counters( "compute device 3", c );
+    RDAI_get_run_counters( &memory.device, NULL, &c );
+    print_counters( "memory device", c );
+    RDAI_get_run_counters( NULL, &compute[0].device.vlnv, &c );
+    print_counters( "compute VLNV", c );
+    RDAI_get_run_counters( NULL, NULL, &c );
+    print_counters( "all devices", c );
+    if( !(c.available & RDAI_COUNTER_CYCLES) ) {
+        printf( "\nhardware counters are not available to this process\n" );
+    }
+
+    RDAI_mem_free( dest );
+    return 0;
+}
@@ -0,0 +1,89 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Overhead of the host API statistics: the cost per call of a few cheap
+// entry points on a null platform, and the statistics recorded for them.
+// Build with "make STATS=1" to time the calls and compare against the
+// default build, in which the instrumentation is compiled out.
+//
+// usage: bench_stats [iterations] [Prometheus file to write]
+
+#include <cstdlib>
+
+#include "bench_common.h"
+
+static const char *op_labels[RDAI_NUM_STATS_OPS] = {
+    "mem_allocate", "mem_free", "mem_copy", "mem_copy_async", "device_run", "device_run_async", "sync",
+};
+
+int main( int argc, char *argv[] )
+{
+    size_t iterations = (argc > 1) ? strtoull( argv[1], NULL, 10 ) : 1000000;
+    const char *dump_path = (argc > 2) ? argv[2] : NULL;
+
+    NullPlatform np;
+    null_platform_setup( &np );
+    if( !null_platform_register( &np ) ) {
+        fprintf( stderr, "could not register the null platform\n" );
+        return 1;
+    }
+
+    RDAI_MemObject *src  = RDAI_mem_host_allocate( 64 );
+    RDAI_MemObject *dest = RDAI_mem_host_allocate( 64 );
+    RDAI_MemObject *mem_object_list[2] = { dest, NULL };
+
+    RDAI_OpStats probe;
+    bool enabled = RDAI_get_stats( RDAI_STATS_SYNC, NULL, &probe ).status_code == RDAI_STATUS_OK;
+    printf( "statistics %s\n\n", enabled ? "enabled" : "compiled out" );
+
+    RDAI_reset_stats();
+    double run_ns = bench_ns_per_call( iterations, [&]( size_t ) {
+                RDAI_device_run( &np.device, mem_object_list );
+            });
+    double copy_ns = bench_ns_per_call( iterations, [&]( size_t ) {
+                RDAI_mem_copy( src, dest );
+            });
+    double alloc_ns = bench_ns_per_call( iterations, [&]( size_t ) {
+                RDAI_mem_free( RDAI_mem_host_allocate( 256 ) );
+            });
+    printf( "%-28s %8.1f ns\n", "device_run", run_ns );
+    printf( "%-28s %8.1f ns\n", "mem_copy (64 bytes)", copy_ns );
+    printf( "%-28s %8.1f ns\n", "mem_host_allocate + free", alloc_ns );
+
+    if( enabled ) {
+        printf( "\n%-18s %10s %10s %10s %10s %10s %10s\n", "op", "count", "mean ns", "p50 ns", "p90 ns",
+                "p99 ns", "max ns" );
+        for( int op = 0; op < RDAI_NUM_STATS_OPS; op++ ) {
+            RDAI_OpStats stats;
+            RDAI_get_stats( (RDAI_StatsOp) op, NULL, &stats );
+            if( !stats.count ) continue;
+            printf( "%-18s %10llu %10llu %10llu %10llu %10llu %10llu\n", op_labels[op],
+                    (unsigned long long) stats.count, (unsigned long long) stats.mean_ns,
+                    (unsigned long long) stats.p50_ns, (unsigned long long) stats.p90_ns,
+                    (unsigned long long) stats.p99_ns, (unsigned long long) stats.max_ns );
+        }
+        if( dump_path ) {
+            RDAI_Status status = RDAI_dump_stats( dump_path );
+            printf( "\n%s %s\n", status.status_code == RDAI_STATUS_OK ? "wrote" : "could not write", dump_path );
+        }
+    }
+
+    RDAI_mem_free( src );
+    RDAI_mem_free( dest );
+    return 0;
+}
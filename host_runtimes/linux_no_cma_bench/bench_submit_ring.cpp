@@ -0,0 +1,188 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Submission to a device from 1 to 64 producer threads. First the MpscRing
+// of the device executor against the mutex-protected deque it replaces:
+// producers push items that one consumer takes in batches. Then
+// RDAI_device_run_async on one null device: each producer submits BATCH
+// runs and syncs them, first with blocking backpressure, then with
+// RDAI_BACKPRESSURE_BUSY, retrying busy submissions. The ring size of the
+// device is set with RDAI_SUBMIT_RING_SIZE (4096 by default): with 64
+// producers, BATCH * 64 runs do not fit in the default ring.
+//
+// usage: bench_submit_ring [ms_per_step]
+
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bench_common.h"
+#include "mpsc_ring.h"
+
+static const size_t MAX_PRODUCERS    = 64;
+static const size_t RING_SIZE        = 4096;
+static const size_t CONSUMER_BATCH   = 256;
+static const size_t BATCH            = 256;
+
+// Runs producer(t) on num_threads threads until stop, and consumer() on this
+// one; returns the items per second counted by the consumer
+template <typename Producer, typename Consumer>
+static double items_per_s( size_t num_threads, size_t step_ms, Producer &&producer, Consumer &&consumer )
+{
+    std::atomic<bool> stop { false };
+    std::vector<std::thread> producers;
+    for( size_t t = 0; t < num_threads; t++ ) {
+        producers.emplace_back( [&, t]() { producer( t, stop ); } );
+    }
+    uint64_t items = 0;
+    auto start = bench_clock::now();
+    auto end = start + std::chrono::milliseconds( step_ms );
+    while( bench_clock::now() < end ) {
+        for( int k = 0; k < 64; k++ ) items += consumer();
+    }
+    double ns = bench_elapsed_ns( start, bench_clock::now() );
+    stop = true;
+    // unblock producers waiting for room
+    for( size_t n = 1; n; ) {
+        n = 0;
+        for( int k = 0; k < 1024; k++ ) n += consumer();
+    }
+    for( auto &producer_thread : producers ) producer_thread.join();
+    return items * 1e9 / ns;
+}
+
+static double ring_items_per_s( size_t num_threads, size_t step_ms )
+{
+    MpscRing<uint64_t> ring( RING_SIZE );
+    return items_per_s( num_threads, step_ms, [&]( size_t t, std::atomic<bool> &stop ) {
+                uint64_t item = t;
+                while( !stop.load( std::memory_order_relaxed ) ) {
+                    if( !ring.try_push( std::move( item ) ) ) std::this_thread::yield();
+                }
+            }, [&]() {
+                return ring.drain( []( uint64_t && ) {}, CONSUMER_BATCH );
+            });
+}
+
+static double mutex_items_per_s( size_t num_threads, size_t step_ms )
+{
+    std::mutex lock;
+    std::deque<uint64_t> queue;
+    return items_per_s( num_threads, step_ms, [&]( size_t t, std::atomic<bool> &stop ) {
+                while( !stop.load( std::memory_order_relaxed ) ) {
+                    bool full;
+                    {
+                        std::lock_guard<std::mutex> guard( lock );
+                        full = queue.size() >= RING_SIZE;
+                        if( !full ) queue.push_back( t );
+                    }
+                    if( full ) std::this_thread::yield();
+                }
+            }, [&]() {
+                std::lock_guard<std::mutex> guard( lock );
+                size_t n = queue.size() < CONSUMER_BATCH ? queue.size() : CONSUMER_BATCH;
+                queue.erase( queue.begin(), queue.begin() + n );
+                return n;
+            });
+}
+
+struct RunResult
+{
+    double runs_per_s;
+    uint64_t busy;
+    uint64_t errors;
+};
+
+static RunResult runs_per_s( RDAI_Device *device, size_t num_threads, size_t step_ms )
+{
+    std::atomic<bool> stop { false };
+    std::atomic<uint64_t> total_runs { 0 }, total_busy { 0 }, total_errors { 0 };
+    RDAI_MemObject output;
+    memset( &output, 0, sizeof( output ) );
+    RDAI_MemObject *mem_object_list[2] = { &output, NULL };
+
+    std::vector<std::thread> producers;
+    auto start = bench_clock::now();
+    for( size_t t = 0; t < num_threads; t++ ) {
+        producers.emplace_back( [&]() {
+                    std::vector<RDAI_AsyncHandle> handles( BATCH );
+                    uint64_t runs = 0, busy = 0, errors = 0;
+                    while( !stop.load( std::memory_order_relaxed ) ) {
+                        for( size_t i = 0; i < BATCH; i++ ) {
+                            RDAI_Status status = RDAI_device_run_async( device, mem_object_list );
+                            while( status.status_code != RDAI_STATUS_OK &&
+                                   status.error_reason == RDAI_REASON_BUSY ) {
+                                busy++;
+                                std::this_thread::yield();
+                                status = RDAI_device_run_async( device, mem_object_list );
+                            }
+                            errors += (status.status_code != RDAI_STATUS_OK);
+                            handles[i] = status.async_handle;
+                        }
+                        for( size_t i = 0; i < BATCH; i++ ) RDAI_sync( &handles[i] );
+                        runs += BATCH;
+                    }
+                    total_runs += runs;
+                    total_busy += busy;
+                    total_errors += errors;
+                });
+    }
+    std::this_thread::sleep_for( std::chrono::milliseconds( step_ms ) );
+    stop = true;
+    for( auto &producer : producers ) producer.join();
+    double ns = bench_elapsed_ns( start, bench_clock::now() );
+
+    RunResult result = { total_runs * 1e9 / ns, total_busy.load(), total_errors.load() };
+    return result;
+}
+
+int main( int argc, char *argv[] )
+{
+    size_t step_ms = (argc > 1) ? strtoull( argv[1], NULL, 10 ) : 300;
+
+    printf( "items from producers to one consumer (ring of %zu, batches of %zu)\n", RING_SIZE, CONSUMER_BATCH );
+    printf( "%-10s %16s %16s %8s\n", "producers", "ring items/s", "mutex items/s", "ratio" );
+    for( size_t n = 1; n <= MAX_PRODUCERS; n *= 2 ) {
+        double ring = ring_items_per_s( n, step_ms );
+        double mutex = mutex_items_per_s( n, step_ms );
+        printf( "%-10zu %16.0f %16.0f %8.2f\n", n, ring, mutex, ring / mutex );
+    }
+
+    NullPlatform np;
+    null_platform_setup( &np );
+    if( !null_platform_register( &np ) ) {
+        fprintf( stderr, "could not register the null platform\n" );
+        return 1;
+    }
+    const char *ring_size = getenv( "RDAI_SUBMIT_RING_SIZE" );
+    printf( "\nRDAI_device_run_async on one device, batches of %zu (ring of %s)\n", BATCH,
+            ring_size ? ring_size : "4096" );
+    printf( "%-10s %14s %14s %14s %8s\n", "producers", "block runs/s", "busy runs/s", "busy returns", "errors" );
+    for( size_t n = 1; n <= MAX_PRODUCERS; n *= 2 ) {
+        RDAI_set_backpressure( RDAI_BACKPRESSURE_BLOCK );
+        RunResult block = runs_per_s( &np.device, n, step_ms );
+        RDAI_set_backpressure( RDAI_BACKPRESSURE_BUSY );
+        RunResult busy = runs_per_s( &np.device, n, step_ms );
+        printf( "%-10zu %14.0f %14.0f %14llu %8llu\n", n, block.runs_per_s, busy.runs_per_s,
+                (unsigned long long) busy.busy, (unsigned long long) (block.errors + busy.errors) );
+    }
+    return 0;
+}
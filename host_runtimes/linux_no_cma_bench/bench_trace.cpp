@@ -0,0 +1,171 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Overhead of the trace recorder, and a trace of copies overlapping with
+// device runs. Tracing is configured when the program starts, so the
+// benchmark first times a few calls on a null platform untraced, then runs
+// itself again with RDAI_TRACE_FILE set. The second pass prints the cost of
+// each recorded event, then pipelines FRAMES frames: the host copy of a
+// frame overlaps with the run of the previous one on a device whose runs
+// sleep for RUN_US. Open the trace file in ui.perfetto.dev to see the copy
+// spans on the host next to the run spans on the device track.
+//
+// usage: bench_trace [iterations] [trace file, bench_trace.json by default]
+
+#include <cstdlib>
+#include <thread>
+#include <unistd.h>
+
+#include "bench_common.h"
+
+static const unsigned RUN_US        = 2000;
+static const size_t FRAMES          = 16;
+static const size_t FRAME_SIZE      = 8u << 20;
+
+// events recorded per call of each measurement: API call and platform op
+// for a run; API call for a copy; submit, span begin/end, run, sync and
+// flow begin/end for an async run
+static const double RUN_EVENTS      = 2;
+static const double COPY_EVENTS     = 1;
+static const double ASYNC_EVENTS    = 7;
+
+static RDAI_Status sleep_device_run( RDAI_Device *, RDAI_MemObject ** )
+{
+    std::this_thread::sleep_for( std::chrono::microseconds( RUN_US ) );
+    return null_status_ok();
+}
+
+struct Costs
+{
+    double run_ns;
+    double copy_ns;
+    double async_ns;
+};
+
+static Costs measure( size_t iterations, RDAI_Device *device )
+{
+    RDAI_MemObject *src  = RDAI_mem_host_allocate( 64 );
+    RDAI_MemObject *dest = RDAI_mem_host_allocate( 64 );
+    RDAI_MemObject *mem_object_list[2] = { dest, NULL };
+
+    Costs costs;
+    costs.run_ns = bench_ns_per_call( iterations, [&]( size_t ) {
+                RDAI_device_run( device, mem_object_list );
+            });
+    costs.copy_ns = bench_ns_per_call( iterations, [&]( size_t ) {
+                RDAI_mem_copy( src, dest );
+            });
+    costs.async_ns = bench_ns_per_call( iterations / 10, [&]( size_t ) {
+                RDAI_Status status = RDAI_device_run_async( device, mem_object_list );
+                RDAI_sync( &status.async_handle );
+            });
+
+    RDAI_mem_free( src );
+    RDAI_mem_free( dest );
+    return costs;
+}
+
+static void pipeline( RDAI_Device *device )
+{
+    RDAI_MemObject *input = RDAI_mem_host_allocate( FRAME_SIZE );
+    RDAI_MemObject *staging[2] = { RDAI_mem_shared_allocate( FRAME_SIZE ), RDAI_mem_shared_allocate( FRAME_SIZE ) };
+    if( !input || !staging[0] || !staging[1] ) {
+        printf( "pipeline skipped (allocation failed)\n" );
+        return;
+    }
+    memset( input->host_ptr, 0x5a, FRAME_SIZE );
+
+    // serial: copy a frame, then run on it
+    auto start = bench_clock::now();
+    for( size_t i = 0; i < FRAMES; i++ ) {
+        RDAI_MemObject *mem_object_list[2] = { staging[0], NULL };
+        RDAI_mem_copy( input, staging[0] );
+        RDAI_device_run( device, mem_object_list );
+    }
+    double serial_ms = bench_elapsed_ns( start, bench_clock::now() ) / 1e6;
+
+    // pipelined: copy frame i + 1 into the other staging buffer during run i
+    start = bench_clock::now();
+    RDAI_AsyncHandle copy = RDAI_mem_copy_async( input, staging[0] ).async_handle;
+    for( size_t i = 0; i < FRAMES; i++ ) {
+        RDAI_MemObject *mem_object_list[2] = { staging[i & 1], NULL };
+        RDAI_sync( &copy );
+        RDAI_AsyncHandle run = RDAI_device_run_async( device, mem_object_list ).async_handle;
+        if( i + 1 < FRAMES ) copy = RDAI_mem_copy_async( input, staging[(i + 1) & 1] ).async_handle;
+        RDAI_sync( &run );
+    }
+    double pipelined_ms = bench_elapsed_ns( start, bench_clock::now() ) / 1e6;
+
+    printf( "\n%zu frames of %zu MiB, %u us runs: serial %.1f ms, pipelined %.1f ms\n",
+            FRAMES, FRAME_SIZE >> 20, RUN_US, serial_ms, pipelined_ms );
+
+    RDAI_mem_free( input );
+    RDAI_mem_free( staging[0] );
+    RDAI_mem_free( staging[1] );
+}
+
+int main( int argc, char *argv[] )
+{
+    size_t iterations = (argc > 1) ? strtoull( argv[1], NULL, 10 ) : 1000000;
+    const char *trace_path = (argc > 2) ? argv[2] : "bench_trace.json";
+    const char *baseline = getenv( "BENCH_TRACE_BASELINE" );
+
+    NullPlatform np, sleeper;
+    null_platform_setup( &np );
+    null_platform_setup( &sleeper );
+    sleeper.device.id.value = 2;
+    sleeper.ops.device_run  = sleep_device_run;
+    sleeper.ops.device_run_async = NULL;      // asynchronous runs execute the run above
+    if( !null_platform_register( &np ) || !null_platform_register( &sleeper ) ) {
+        fprintf( stderr, "could not register the null platforms\n" );
+        return 1;
+    }
+
+    bool traced = RDAI_trace_flush().status_code == RDAI_STATUS_OK;
+    Costs costs = measure( iterations, &np.device );
+    if( !traced ) {
+        if( baseline ) {
+            fprintf( stderr, "tracing is not enabled in the traced pass\n" );
+            return 1;
+        }
+        char value[128];
+        snprintf( value, sizeof( value ), "%f %f %f", costs.run_ns, costs.copy_ns, costs.async_ns );
+        setenv( "BENCH_TRACE_BASELINE", value, 1 );
+        setenv( "RDAI_TRACE_FILE", trace_path, 1 );
+        fflush( stdout );
+        execv( "/proc/self/exe", argv );
+        perror( "execv" );
+        return 1;
+    }
+
+    Costs base = { 0, 0, 0 };
+    if( baseline ) sscanf( baseline, "%lf %lf %lf", &base.run_ns, &base.copy_ns, &base.async_ns );
+    printf( "%-28s %12s %12s %8s %12s\n", "call", "untraced ns", "traced ns", "events", "ns/event" );
+    printf( "%-28s %12.1f %12.1f %8.0f %12.1f\n", "device_run", base.run_ns, costs.run_ns, RUN_EVENTS,
+            (costs.run_ns - base.run_ns) / RUN_EVENTS );
+    printf( "%-28s %12.1f %12.1f %8.0f %12.1f\n", "mem_copy (64 bytes)", base.copy_ns, costs.copy_ns, COPY_EVENTS,
+            (costs.copy_ns - base.copy_ns) / COPY_EVENTS );
+    printf( "%-28s %12.1f %12.1f %8.0f %12.1f\n", "device_run_async + sync", base.async_ns, costs.async_ns,
+            ASYNC_EVENTS, (costs.async_ns - base.async_ns) / ASYNC_EVENTS );
+
+    pipeline( &sleeper.device );
+
+    RDAI_Status status = RDAI_trace_flush();
+    printf( "\n%s %s\n", status.status_code == RDAI_STATUS_OK ? "wrote" : "could not write", trace_path );
+    return 0;
+}
@@ -0,0 +1,149 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Throughput of RDAI_submit_by_vlnv as identical devices are added, with
+// WINDOW_PER_DEVICE runs in flight per device. Each device is a null
+// platform whose device_run sleeps for RUN_US, standing in for an
+// accelerator that keeps the host CPU free while it computes.
+//
+// A second pass makes every other device four times slower, once with a
+// least-loaded dispatch policy and once with the default expected-completion
+// policy, which learns the latency of each device. Both are measured at full
+// load (throughput) and with a single run in flight (latency of a run). The
+// estimates of the last pass are printed.
+//
+// usage: bench_vlnv_scheduler [runs per measurement]
+
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "bench_common.h"
+
+static const size_t MAX_DEVICES = 8;
+static const unsigned RUN_US    = 500;
+static const size_t WINDOW_PER_DEVICE = 2;     // runs kept in flight per device
+
+static NullPlatform platforms[MAX_DEVICES];
+static unsigned run_us[MAX_DEVICES + 1];            // by device ID
+
+static RDAI_Status sleep_device_run( RDAI_Device *device, RDAI_MemObject ** )
+{
+    std::this_thread::sleep_for( std::chrono::microseconds( run_us[device->id.value] ) );
+    return null_status_ok();
+}
+
+static size_t least_loaded_policy( const RDAI_DeviceEstimate *estimates, size_t count, void * )
+{
+    size_t best = 0;
+    for( size_t i = 1; i < count; i++ ) {
+        if( estimates[i].queue_depth < estimates[best].queue_depth ) best = i;
+    }
+    return best;
+}
+
+static RDAI_AsyncHandle submit_run( RDAI_MemObject **mem_object_list )
+{
+    RDAI_Status status = RDAI_submit_by_vlnv( &platforms[0].device.vlnv, mem_object_list );
+    if( status.status_code != RDAI_STATUS_OK ) {
+        fprintf( stderr, "submission failed (reason %d)\n", (int) status.error_reason );
+        exit( 1 );
+    }
+    return status.async_handle;
+}
+
+// keeps window runs in flight, submitting a new run as each one completes
+static double runs_per_second( size_t runs, size_t window, RDAI_MemObject **mem_object_list )
+{
+    std::vector<RDAI_AsyncHandle> handles( window );
+    auto start = bench_clock::now();
+    size_t submitted = 0, outstanding = 0;
+    for( ; submitted < window && submitted < runs; submitted++, outstanding++ ) {
+        handles[submitted] = submit_run( mem_object_list );
+    }
+    while( outstanding ) {
+        size_t index;
+        RDAI_Status status = RDAI_wait_any( handles.data(), window, -1, &index );
+        if( status.status_code != RDAI_STATUS_OK ) {
+            fprintf( stderr, "run failed (reason %d)\n", (int) status.error_reason );
+            exit( 1 );
+        }
+        outstanding--;
+        if( submitted < runs ) {
+            handles[index] = submit_run( mem_object_list );
+            submitted++;
+            outstanding++;
+        }
+    }
+    double ns = bench_elapsed_ns( start, bench_clock::now() );
+    return (double) runs * 1e9 / ns;
+}
+
+int main( int argc, char *argv[] )
+{
+    size_t runs = (argc > 1) ? strtoull( argv[1], NULL, 10 ) : 2000;
+
+    RDAI_MemObject output;
+    memset( &output, 0, sizeof( output ) );
+    RDAI_MemObject *mem_object_list[2] = { &output, NULL };
+
+    printf( "run: %u us, %zu runs, %zu in flight per device\n"
+            "mixed: least loaded policy (ll) and expected completion policy (ec)\n\n",
+            RUN_US, runs, WINDOW_PER_DEVICE );
+    printf( "%-8s %14s %10s %14s %14s %14s %14s\n", "devices", "uniform run/s", "scaling",
+            "ll run/s", "ec run/s", "ll 1 run us", "ec 1 run us" );
+    size_t registered = 0;
+    double single = 0;
+    for( size_t devices = 1; devices <= MAX_DEVICES; devices *= 2 ) {
+        for( ; registered < devices; registered++ ) {
+            NullPlatform *np = &platforms[registered];
+            null_platform_setup( np );
+            np->device.id.value = (uint32_t) registered + 1;
+            np->ops.device_run  = sleep_device_run;
+            if( !null_platform_register( np ) ) {
+                fprintf( stderr, "could not register the null platforms\n" );
+                return 1;
+            }
+        }
+
+        for( size_t d = 1; d <= devices; d++ ) run_us[d] = RUN_US;
+        double uniform = runs_per_second( runs, WINDOW_PER_DEVICE * devices, mem_object_list );
+        if( devices == 1 ) single = uniform;
+
+        // odd device IDs are fast, even ones four times slower
+        for( size_t d = 1; d <= devices; d++ ) run_us[d] = (d % 2) ? RUN_US : 4 * RUN_US;
+        double mixed[2], latency_us[2];
+        for( int p = 0; p < 2; p++ ) {
+            RDAI_set_dispatch_policy( p ? NULL : least_loaded_policy, NULL );
+            mixed[p] = runs_per_second( runs, WINDOW_PER_DEVICE * devices, mem_object_list );
+            latency_us[p] = 1e6 / runs_per_second( runs / 4, 1, mem_object_list );
+        }
+
+        printf( "%-8zu %14.0f %9.2fx %14.0f %14.0f %14.1f %14.1f\n", devices, uniform, uniform / single,
+                mixed[0], mixed[1], latency_us[0], latency_us[1] );
+    }
+
+    printf( "\n%-8s %12s %12s %10s\n", "device", "latency us", "queue depth", "runs" );
+    for( size_t d = 0; d < registered; d++ ) {
+        RDAI_DeviceEstimate estimate;
+        if( RDAI_get_device_estimate( &platforms[d].device, &estimate ).status_code != RDAI_STATUS_OK ) continue;
+        printf( "%-8zu %12.1f %12u %10llu\n", d + 1, (double) estimate.latency_ns / 1000.0,
+                estimate.queue_depth, (unsigned long long) estimate.runs );
+    }
+    return 0;
+}
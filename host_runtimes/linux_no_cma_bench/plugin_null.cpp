@@ -0,0 +1,46 @@
+/* Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Null platform built as a platform plugin (libplugin_null.so) for
+// bench_plugin. platform_create counts its calls so that the benchmark can
+// check that creation is deferred.
+
+#include "bench_common.h"
+
+static NullPlatform plugin_platform;
+
+extern "C" {
+int plugin_null_create_calls = 0;
+}
+
+static RDAI_Platform *plugin_platform_create( void )
+{
+    plugin_null_create_calls++;
+    return &plugin_platform.platform;
+}
+
+static RDAI_PlatformOps *plugin_setup( void )
+{
+    null_platform_setup( &plugin_platform );
+    plugin_platform.ops.platform_create = plugin_platform_create;
+    return &plugin_platform.ops;
+}
+
+extern "C" {
+RDAI_PlatformOps *rdai_platform_ops = plugin_setup();
+}
@@ -1,11 +1,143 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <thread>
 
 #include "rdai_api.h"
 
 extern RDAI_PlatformOps ops;
 
+static bool check( bool condition, const char *what )
+{
+    if( !condition ) std::cout << "check failed: " << what << "\n";
+    return condition;
+}
+
+static bool is_ok( RDAI_Status status )
+{
+    return status.status_code == RDAI_STATUS_OK;
+}
+
+static bool is_error( RDAI_Status status, RDAI_ErrorReason reason )
+{
+    return status.status_code == RDAI_STATUS_ERROR && status.error_reason == reason;
+}
+
+// a handle of the host runtime syncs once, then is stale
+static bool test_stale_handles( RDAI_Device *device, RDAI_MemObject **mem_obj_list )
+{
+    bool passed = true;
+    RDAI_Status status = RDAI_device_run_async( device, mem_obj_list );
+    passed &= check( is_ok( status ) && !status.async_handle.platform, "device_run_async returns a host handle" );
+    RDAI_AsyncHandle handle = status.async_handle;
+    passed &= check( is_ok( RDAI_sync( &handle ) ), "first sync succeeds" );
+    passed &= check( is_error( RDAI_sync( &handle ), RDAI_REASON_STALE_HANDLE ), "second sync is stale" );
+
+    RDAI_AsyncHandle never_issued = handle;
+    never_issued.id.value ^= 0x00ffff00;
+    passed &= check( is_error( RDAI_sync( &never_issued ), RDAI_REASON_STALE_HANDLE ),
+                     "sync of a handle never issued is stale" );
+    return passed;
+}
+
+// sync_all syncs every handle, wait_any returns each once, then is stale
+static bool test_sync_all_wait_any( RDAI_Device *device, RDAI_MemObject **mem_obj_list )
+{
+    const size_t count = 8;
+    bool passed = true;
+    RDAI_AsyncHandle handles[count];
+    for( size_t i = 0; i < count; i++ ) handles[i] = RDAI_device_run_async( device, mem_obj_list ).async_handle;
+    passed &= check( is_ok( RDAI_sync_all( handles, count ) ), "sync_all succeeds" );
+    for( size_t i = 0; i < count; i++ ) {
+        passed &= check( is_error( RDAI_sync( &handles[i] ), RDAI_REASON_STALE_HANDLE ),
+                         "sync_all synced every handle" );
+    }
+
+    for( size_t i = 0; i < count; i++ ) handles[i] = RDAI_device_run_async( device, mem_obj_list ).async_handle;
+    bool retrieved[count] = {};
+    for( size_t i = 0; i < count; i++ ) {
+        size_t index = count;
+        passed &= check( is_ok( RDAI_wait_any( handles, count, -1, &index ) ), "wait_any succeeds" );
+        passed &= check( index < count && !retrieved[index], "wait_any returns each handle once" );
+        if( index < count ) retrieved[index] = true;
+    }
+    size_t index;
+    passed &= check( is_error( RDAI_wait_any( handles, count, -1, &index ), RDAI_REASON_STALE_HANDLE ),
+                     "wait_any is stale once every handle is retrieved" );
+    return passed;
+}
+
+static void count_callback( const RDAI_AsyncHandle *, RDAI_Status, void *ctx )
+{
+    ((std::atomic<int> *) ctx)->fetch_add( 1 );
+}
+
+// RDAI_sync racing the callback: the status until the callback returned,
+// stale after, and the callback called once either way
+static bool test_callback_race( RDAI_Device *device, RDAI_MemObject **mem_obj_list )
+{
+    bool passed = true;
+    for( int i = 0; i < 1000 && passed; i++ ) {
+        std::atomic<int> calls( 0 );
+        RDAI_Status status = RDAI_device_run_async_cb( device, mem_obj_list, count_callback, &calls );
+        passed &= check( is_ok( status ), "device_run_async_cb succeeds" );
+        if( !passed ) break;
+        RDAI_Status synced = RDAI_sync( &status.async_handle );
+        if( is_error( synced, RDAI_REASON_STALE_HANDLE ) ) {
+            passed &= check( calls.load() == 1, "a stale sync follows the callback" );
+        } else {
+            passed &= check( is_ok( synced ), "a sync before the callback returns the run status" );
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 5 );
+        while( calls.load() == 0 && std::chrono::steady_clock::now() < deadline ) std::this_thread::yield();
+        // a second call would have come right after the first
+        std::this_thread::yield();
+        passed &= check( calls.load() == 1, "the callback is called once" );
+    }
+    return passed;
+}
+
+// a queue waiting on an event recorded by another starts after the commands
+// recorded before it: the copy of the second queue sees the run of the first
+static bool test_queue_events( RDAI_Device *device )
+{
+    const size_t size = 16u << 20;
+    bool passed = true;
+    RDAI_MemObject *mid = RDAI_mem_host_allocate( size );
+    RDAI_MemObject *dest = RDAI_mem_host_allocate( size );
+    RDAI_Queue *producer = RDAI_queue_create( device );
+    RDAI_Queue *consumer = RDAI_queue_create( device );
+    RDAI_Event *event = RDAI_event_create();
+    if( !check( mid && dest && producer && consumer && event, "queue test setup" ) ) return false;
+    RDAI_MemObject *run_list[2] = { mid, NULL };
+
+    for( int round = 0; round < 4 && passed; round++ ) {
+        memset( mid->host_ptr, 0, size );
+        memset( dest->host_ptr, 0, size );
+        passed &= check( is_ok( RDAI_queue_device_run( producer, run_list ) ), "producer run submitted" );
+        passed &= check( is_ok( RDAI_queue_record_event( producer, event ) ), "event recorded" );
+        passed &= check( is_ok( RDAI_queue_wait_event( consumer, event ) ), "event waited" );
+        passed &= check( is_ok( RDAI_queue_mem_copy( consumer, mid, dest ) ), "consumer copy submitted" );
+        passed &= check( is_ok( RDAI_queue_sync( consumer ) ), "consumer synced" );
+        bool ordered = true;
+        for( size_t i = 0; i < size && ordered; i++ ) ordered = dest->host_ptr[i] == (uint8_t) i;
+        passed &= check( ordered, "the consumer copy follows the recorded producer run" );
+        passed &= check( is_ok( RDAI_event_sync( event ) ), "event synced" );
+        passed &= check( is_ok( RDAI_queue_sync( producer ) ), "producer synced" );
+    }
+
+    RDAI_event_destroy( event );
+    RDAI_queue_destroy( consumer );
+    RDAI_queue_destroy( producer );
+    RDAI_mem_free( dest );
+    RDAI_mem_free( mid );
+    return passed;
+}
+
 int main(int argc, char *argv[])
 {
+    bool test_passed = false;
     RDAI_VLNV dev_vlnv = {
         { "aha" },
         { "halide_hardware" },
@@ -35,7 +167,7 @@ int main(int argc, char *argv[])
                 RDAI_MemObject *output = RDAI_mem_shared_allocate( 256 );
                 if( output ) {
                     std::cout << "allocated output buffer of size " << output->size << "\n";
-                    for(int i = 0; i < 258; i++) {
+                    for(size_t i = 0; i < output->size; i++) {
                         output->host_ptr[i] = 0;
                     }
                     std::cout << "cleared output buffer \n";
@@ -47,8 +179,13 @@ int main(int argc, char *argv[])
                         for(size_t i = 0; i <= 255; i++) {
                             if( output->host_ptr[i] != i ) passed = false;
                         }
+                        passed &= test_stale_handles( device, mem_obj_list );
+                        passed &= test_sync_all_wait_any( device, mem_obj_list );
+                        passed &= test_callback_race( device, mem_obj_list );
+                        passed &= test_queue_events( device );
                         if( passed ) {
                             std::cout << "TEST PASSED!\n";
+                            test_passed = true;
                         } else {
                             std::cout << "TEST FAILED\n";
                         }
@@ -72,5 +209,5 @@ int main(int argc, char *argv[])
         std::cout << "no platforms found\n";
     }
 
-    return 0;
+    return test_passed ? 0 : 1;
 }
@@ -123,7 +123,14 @@ static RDAI_Status op_device_run( RDAI_Device *device, RDAI_MemObject **mem_obje
 
 static RDAI_Status op_device_run_async( RDAI_Device *device, RDAI_MemObject **mem_object_list )
 {
-    return op_device_run( device, mem_object_list );
+    // the run is over on return: the handle only has to sync
+    RDAI_Status status = op_device_run( device, mem_object_list );
+    if( status.status_code == RDAI_STATUS_OK ) {
+        status.async_handle.id.value  = 1;
+        status.async_handle.platform  = device->platform;
+        status.async_handle.user_data = NULL;
+    }
+    return status;
 }
 
 static RDAI_Status op_sync( RDAI_AsyncHandle *handle )
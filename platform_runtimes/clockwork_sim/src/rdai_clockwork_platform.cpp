@@ -253,6 +253,11 @@ struct RDAI_PlatformOps rdai_clockwork_sim_ops = {
     .sync               = op_sync
 };
 
+#ifdef RDAI_PLATFORM_PLUGIN
+// entry point of the platform when built as a plugin (see RDAI_load_platform_plugin)
+RDAI_PlatformOps *rdai_platform_ops = &rdai_clockwork_sim_ops;
+#endif // RDAI_PLATFORM_PLUGIN
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
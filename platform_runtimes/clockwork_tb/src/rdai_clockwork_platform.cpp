@@ -162,3 +162,10 @@ RDAI_PlatformOps rdai_clockwork_sim_ops = {
     .sync               = op_sync
 };
 
+#ifdef RDAI_PLATFORM_PLUGIN
+// entry point of the platform when built as a plugin (see RDAI_load_platform_plugin)
+extern "C" {
+RDAI_PlatformOps *rdai_platform_ops = &rdai_clockwork_sim_ops;
+}
+#endif // RDAI_PLATFORM_PLUGIN
+
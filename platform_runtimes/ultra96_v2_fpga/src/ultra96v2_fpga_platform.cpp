@@ -24,9 +24,12 @@
 #include "rdai-cma.h"
 
 #include <future>
+#include <map>
+#include <mutex>
 #include <vector>
 #include <string.h>
 #include <sstream>
+#include <time.h>
 
 using namespace std;
 
@@ -37,6 +40,10 @@ static RDAI_VLNV urdai_vlnv;
 static vector<future<RDAI_Status> > asyncStatuses;
 static uint32_t async_id = 1;
 
+// start of the runs in flight, by platform handle ID, until their sync
+static mutex run_started_lock;
+static map<uint32_t, uint64_t> run_started_ns;
+
 static map<string, string> = {
         {"bitstream", "example.bit.bin"},
         {"dtbo", "pl.dtbo"}
@@ -96,6 +103,18 @@ static RDAI_Status make_status_ok()
     return status;
 }
 
+/**
+ * Get the time in the clock of RDAI handle profiles
+ *
+ * @return CLOCK_MONOTONIC time in ns
+ */
+static uint64_t monotonic_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
 // =================== Platform Ops Implementation ==============================
 //
 // See RDAI API documentation for the functionality of these APIs
@@ -277,10 +296,17 @@ static RDAI_Status op_device_run_async( RDAI_Device *device,
 
     int status;
     printf("starting device run async\n");
+    // the driver has no device timestamps: the engine runs from the run
+    // ioctl to the return of the sync ioctl
+    uint64_t started_ns = monotonic_ns();
     if(status = ioctl(fd_dma, DEVICE_RUN_ASYNC, &udata)) {
         printf("device run async failed!\n");
+        return make_status_error();
     }
-    return (status == 0)? make_status_ok_async(&udata) : make_status_error();
+    RDAI_Status async_status = make_status_ok_async(&udata);
+    lock_guard<mutex> guard(run_started_lock);
+    run_started_ns[async_status.async_handle.id.value] = started_ns;
+    return async_status;
 }
 
 static RDAI_Status op_sync( RDAI_AsyncHandle *async_handle )
@@ -289,7 +315,24 @@ static RDAI_Status op_sync( RDAI_AsyncHandle *async_handle )
 
 	int status;
     printf("starting device sync\n");
-    if(status = ioctl(fd_dma, DEVICE_SYNC, udata)) {
+    status = ioctl(fd_dma, DEVICE_SYNC, udata);
+    uint64_t ended_ns = monotonic_ns();
+
+    uint64_t started_ns = 0;
+    {
+        lock_guard<mutex> guard(run_started_lock);
+        auto it = run_started_ns.find(async_handle->id.value);
+        if(it != run_started_ns.end()) {
+            started_ns = it->second;
+            run_started_ns.erase(it);
+        }
+    }
+    // profile of the host runtime async call this sync finishes, if any:
+    // the runs of op_device_run and the runs started for
+    // RDAI_device_run_async alike
+    if(started_ns) RDAI_set_handle_device_times(NULL, started_ns, ended_ns);
+
+    if(status) {
         printf("device sync failed with code [%d]!\n", status);
         return make_status_error();
     } else {
@@ -305,6 +348,33 @@ static RDAI_Status op_sync( RDAI_AsyncHandle *async_handle )
 	
 }
 
+static RDAI_Status op_device_run_batch( RDAI_Device *device,
+										RDAI_MemObject ***mem_object_lists, size_t count )
+{
+    // queue every run with the driver before waiting for the first one, so
+    // that runs are not separated by a round trip to user space
+    vector<UserData> udata( count );
+    size_t submitted = 0;
+    int status = 0;
+    for( ; submitted < count; submitted++ ) {
+        RDAI_MemObject **mem_object_list = mem_object_lists[submitted];
+        UserData *u = &udata[submitted];
+        u->timeout = 3000;
+        u->dev_id = 0;
+        u->in_obj = *(mem_object_list[0]->user_tag);
+        u->out_obj = *(mem_object_list[1]->user_tag);
+        strcpy(u->dev_vlnv, device->vlnv);
+        if(status = ioctl(fd_dma, DEVICE_RUN_ASYNC, u)) {
+            printf("device run batch failed at run %zu!\n", submitted);
+            break;
+        }
+    }
+    for( size_t i = 0; i < submitted; i++ ) {
+        if(ioctl(fd_dma, DEVICE_SYNC, &udata[i])) status = -1;
+    }
+    return (status == 0)? make_status_ok() : make_status_error();
+}
+
 // ======================== PlatformOps ========================================
 #ifdef __cplusplus
 extern "C" {
@@ -325,9 +395,15 @@ struct RDAI_PlatformOps ultra96v2_fpga_ops = {
     .device_deinit      = op_device_deinit,
     .device_run         = op_device_run,
     .device_run_async   = op_device_run_async,
-    .sync               = op_sync
+    .sync               = op_sync,
+    .device_run_batch   = op_device_run_batch
 };
 
+#ifdef RDAI_PLATFORM_PLUGIN
+// entry point of the platform when built as a plugin (see RDAI_load_platform_plugin)
+RDAI_PlatformOps *rdai_platform_ops = &ultra96v2_fpga_ops;
+#endif // RDAI_PLATFORM_PLUGIN
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -112,6 +112,14 @@ typedef enum RDAI_ErrorReason
     RDAI_REASON_UNIMPLEMENTED           = 2,
     RDAI_REASON_INVALID_OBJECT          = 3,
     RDAI_REASON_INVALID_BUFFER_COUNT    = 4,
+    RDAI_REASON_INVALID_SIZE            = 5,
+    RDAI_REASON_STALE_HANDLE            = 6,
+    RDAI_REASON_HANDLE_TABLE_FULL       = 7,
+    RDAI_REASON_TIMEOUT                 = 8,
+    RDAI_REASON_CAPTURE_ACTIVE          = 9,
+    RDAI_REASON_NO_DEVICE               = 10,
+    RDAI_REASON_PLUGIN_LOAD             = 11,
+    RDAI_REASON_BUSY                    = 12,
 
 } RDAI_ErrorReason;
 
@@ -122,7 +130,9 @@ typedef enum RDAI_ErrorReason
  * returned in this struct
  *
  * @id: the handle ID. Valid ID must be > than 0
- * @platform: platform which issued this handle
+ * @platform: platform which issued this handle, or NULL if the handle was
+ *            issued by the host runtime handle table (see
+ *            RDAI_async_handle_create)
  */
 typedef struct RDAI_AsyncHandle
 {
@@ -150,6 +160,32 @@ typedef struct RDAI_Status
 
 } RDAI_Status;
 
+/**
+ * RDAI Queue
+ *
+ * An in-order command queue bound to a device (opaque, see RDAI_queue_create)
+ */
+typedef struct RDAI_Queue RDAI_Queue;
+
+/**
+ * RDAI Event
+ *
+ * A synchronization point between queues (opaque, see RDAI_event_create)
+ */
+typedef struct RDAI_Event RDAI_Event;
+
+/**
+ * RDAI Completion Callback
+ *
+ * Called by the host runtime, from its completion thread, when an
+ * asynchronous call completes
+ *
+ * @async_handle: the handle of the completed call
+ * @status: the final status of the call
+ * @ctx: the context pointer given when the call was made
+ */
+typedef void (*RDAI_CompletionCallback)( const RDAI_AsyncHandle *async_handle, RDAI_Status status, void *ctx );
+
 /**
  * RDAI Platform
  *
@@ -266,6 +302,36 @@ typedef enum RDAI_MemViewType
 
 } RDAI_MemViewType;
 
+/**
+ * RDAI Memory Object Flags
+ *
+ * Bit flags requested at allocation time and recorded in RDAI_MemObject::flags.
+ * A flag is recorded only when the allocation actually has the property, so
+ * platform runtimes can rely on them (e.g. to skip bounce buffers for pinned,
+ * page-aligned memory)
+ *
+ * @RDAI_MEM_FLAG_ALIGN_64: host_ptr is aligned to 64 bytes
+ * @RDAI_MEM_FLAG_ALIGN_4K: host_ptr is aligned to 4 KiB
+ * @RDAI_MEM_FLAG_PINNED: the memory is locked in RAM (mlock) and cannot be paged out
+ * @RDAI_MEM_FLAG_HUGE_PAGES: the memory is backed by reserved huge pages
+ *                            (hugetlbfs). Best-effort when requested: without
+ *                            reserved huge pages, transparent huge pages are
+ *                            requested instead and the flag is not granted
+ * @RDAI_MEM_FLAG_NUMA_BIND: the memory is bound to the NUMA node encoded
+ *                           with RDAI_MEM_FLAG_NUMA_NODE
+ */
+#define RDAI_MEM_FLAG_ALIGN_64                  (1ull << 0)
+#define RDAI_MEM_FLAG_ALIGN_4K                  (1ull << 1)
+#define RDAI_MEM_FLAG_PINNED                    (1ull << 2)
+#define RDAI_MEM_FLAG_HUGE_PAGES                (1ull << 3)
+#define RDAI_MEM_FLAG_NUMA_BIND                 (1ull << 4)
+#define RDAI_MEM_FLAG_NUMA_NODE_SHIFT           32
+#define RDAI_MEM_FLAG_NUMA_NODE_MASK            (0xFFFFull << RDAI_MEM_FLAG_NUMA_NODE_SHIFT)
+#define RDAI_MEM_FLAG_NUMA_NODE( node )         (RDAI_MEM_FLAG_NUMA_BIND | \
+                                                 (((uint64_t)(node) & 0xFFFF) << RDAI_MEM_FLAG_NUMA_NODE_SHIFT))
+#define RDAI_MEM_FLAG_GET_NUMA_NODE( flags )    ((uint32_t)(((flags) & RDAI_MEM_FLAG_NUMA_NODE_MASK) >> \
+                                                            RDAI_MEM_FLAG_NUMA_NODE_SHIFT))
+
 /**
  * RDAI Memory Object
  *
@@ -284,7 +350,7 @@ typedef enum RDAI_MemViewType
  * @device_ptr: a device address view of the memory object (for RDAI_MEM_DEVICE memory objects).
  *              This field should be NULL for non RDAI_MEM_DEVICE memory object types
  * @size: size in bytes of the memory object
- * @flags: memory object flags
+ * @flags: memory object flags (see RDAI_MEM_FLAG_*)
  * @user_tag: a user-defined tag for the memory object
  */
 typedef struct RDAI_MemObject RDAI_MemObject;
@@ -301,6 +367,291 @@ struct RDAI_MemObject
     void *user_tag;
 };
 
+/**
+ * RDAI Memory Pool Statistics
+ *
+ * Counters of the pool backing host and shared memory objects
+ *
+ * @hits: allocations served from memory already held by the pool
+ * @misses: allocations that had to request memory from the OS allocator
+ * @bytes_held: bytes of free memory retained by the pool for reuse
+ * @bytes_in_use: bytes of pooled memory currently handed out
+ */
+typedef struct RDAI_MemPoolStats
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t bytes_held;
+    uint64_t bytes_in_use;
+
+} RDAI_MemPoolStats;
+
+/**
+ * RDAI Priority
+ *
+ * The priority class of an asynchronous submission. The host runtime
+ * dispatches queued work of a higher class first; waiting work is aged so
+ * that lower classes cannot starve
+ */
+typedef enum RDAI_Priority
+{
+    RDAI_PRIORITY_HIGH                 = 0,
+    RDAI_PRIORITY_NORMAL               = 1,
+    RDAI_PRIORITY_LOW                  = 2,
+
+} RDAI_Priority;
+
+#define RDAI_NUM_PRIORITIES             3
+
+/**
+ * RDAI Backpressure
+ *
+ * What an asynchronous submission to a device does when the submission
+ * ring of the device is full (see RDAI_set_backpressure)
+ *
+ * RDAI_BACKPRESSURE_BLOCK: wait until the device thread frees room
+ * RDAI_BACKPRESSURE_BUSY: fail with RDAI_REASON_BUSY
+ */
+typedef enum RDAI_Backpressure
+{
+    RDAI_BACKPRESSURE_BLOCK            = 0,
+    RDAI_BACKPRESSURE_BUSY             = 1,
+
+} RDAI_Backpressure;
+
+/**
+ * RDAI Queue Wait Statistics
+ *
+ * Time asynchronous work of a priority class spent queued in the host
+ * runtime before it started
+ *
+ * @count: the number of dispatched submissions
+ * @mean_ns: the mean wait in ns
+ * @p50_ns: the median wait in ns (within 12.5%)
+ * @p99_ns: the 99th percentile of the wait in ns (within 12.5%)
+ * @max_ns: the longest wait in ns
+ * @aged: the number of submissions dispatched ahead of queued higher
+ *        priority work because they had waited long enough
+ */
+typedef struct RDAI_QueueWaitStats
+{
+    uint64_t count;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+    uint64_t aged;
+
+} RDAI_QueueWaitStats;
+
+/**
+ * RDAI Host API Operation
+ *
+ * The classes of host API calls timed by the host runtime when it is built
+ * with RDAI_ENABLE_STATS (see RDAI_get_stats)
+ */
+typedef enum RDAI_StatsOp
+{
+    RDAI_STATS_MEM_ALLOCATE            = 0,
+    RDAI_STATS_MEM_FREE                = 1,
+    RDAI_STATS_MEM_COPY                = 2,
+    RDAI_STATS_MEM_COPY_ASYNC          = 3,
+    RDAI_STATS_DEVICE_RUN              = 4,
+    RDAI_STATS_DEVICE_RUN_ASYNC        = 5,
+    RDAI_STATS_SYNC                    = 6,
+
+} RDAI_StatsOp;
+
+#define RDAI_NUM_STATS_OPS              7
+
+/**
+ * RDAI Host API Operation Statistics
+ *
+ * Time spent in the host API calls of an operation class (for asynchronous
+ * calls, the time to submit the work)
+ *
+ * @count: the number of calls
+ * @mean_ns: the mean latency in ns
+ * @p50_ns: the median latency in ns (within 12.5%)
+ * @p90_ns: the 90th percentile of the latency in ns (within 12.5%)
+ * @p99_ns: the 99th percentile of the latency in ns (within 12.5%)
+ * @max_ns: the longest call in ns
+ */
+typedef struct RDAI_OpStats
+{
+    uint64_t count;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+
+} RDAI_OpStats;
+
+/**
+ * RDAI Run Counter Flags
+ *
+ * The host CPU counters measured around device runs (see RDAI_RunCounters)
+ */
+#define RDAI_COUNTER_CYCLES                     (1u << 0)
+#define RDAI_COUNTER_INSTRUCTIONS               (1u << 1)
+#define RDAI_COUNTER_LLC_MISSES                 (1u << 2)
+#define RDAI_COUNTER_BRANCH_MISSES              (1u << 3)
+#define RDAI_COUNTER_CPU_TIME                   (1u << 4)
+
+/**
+ * RDAI Run Counters
+ *
+ * Host CPU counters accumulated over device runs (see RDAI_get_run_counters).
+ * They count the host thread executing the platform device_run, which is
+ * where CPU-emulated platforms do their work, in user mode. Counters the
+ * host cannot provide (e.g. hardware counters in most virtual machines)
+ * are left out of available and read 0
+ *
+ * @runs: the number of runs counted
+ * @cycles: CPU cycles
+ * @instructions: instructions retired
+ * @llc_misses: last level cache misses
+ * @branch_misses: mispredicted branches
+ * @cpu_time_ns: CPU time in ns
+ * @available: the RDAI_COUNTER_* flags of the counters measured
+ */
+typedef struct RDAI_RunCounters
+{
+    uint64_t runs;
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t llc_misses;
+    uint64_t branch_misses;
+    uint64_t cpu_time_ns;
+    uint32_t available;
+
+} RDAI_RunCounters;
+
+/**
+ * RDAI Handle Profile Flags
+ */
+#define RDAI_PROFILE_DEVICE_TIMES               (1u << 0)   // started and ended were reported by the platform
+
+/**
+ * RDAI Handle Profile
+ *
+ * The timeline of an async call (see RDAI_get_handle_profile), in
+ * CLOCK_MONOTONIC nanoseconds. Times not reached yet read 0. Unless the
+ * platform reported when the device started and ended the operation,
+ * started and ended are the submitted and completed times
+ *
+ * @queued_ns: the call was made and the handle issued
+ * @submitted_ns: the host runtime handed the operation to its platform
+ * @started_ns: the device started the operation
+ * @ended_ns: the device ended the operation
+ * @completed_ns: the host runtime recorded the completion
+ * @flags: RDAI_PROFILE_* flags
+ */
+typedef struct RDAI_HandleProfile
+{
+    uint64_t queued_ns;
+    uint64_t submitted_ns;
+    uint64_t started_ns;
+    uint64_t ended_ns;
+    uint64_t completed_ns;
+    uint32_t flags;
+
+} RDAI_HandleProfile;
+
+/**
+ * RDAI Frame Stages
+ *
+ * The stages of the frame latency report (see RDAI_frame_begin). A stage
+ * of a frame is the sum of the operations of the frame in that stage
+ *
+ * RDAI_FRAME_INPUT_COPY: copies issued before the first run of the frame
+ * RDAI_FRAME_QUEUE_WAIT: time async operations waited to be submitted
+ * RDAI_FRAME_COMPUTE: device runs (device times when the platform reports them)
+ * RDAI_FRAME_OUTPUT_COPY: copies issued after the first run of the frame
+ * RDAI_FRAME_SYNC_WAKEUP: time from the completion of an async operation
+ *                         until its synchronization returned
+ * RDAI_FRAME_TOTAL: from RDAI_frame_begin to RDAI_frame_end
+ */
+typedef enum RDAI_FrameStage
+{
+    RDAI_FRAME_INPUT_COPY              = 0,
+    RDAI_FRAME_QUEUE_WAIT              = 1,
+    RDAI_FRAME_COMPUTE                 = 2,
+    RDAI_FRAME_OUTPUT_COPY             = 3,
+    RDAI_FRAME_SYNC_WAKEUP             = 4,
+    RDAI_FRAME_TOTAL                   = 5,
+
+} RDAI_FrameStage;
+
+#define RDAI_NUM_FRAME_STAGES           6
+
+/**
+ * RDAI Graph
+ *
+ * A sequence of copies and device runs recorded once and replayed many times
+ * (opaque, see RDAI_graph_begin_capture)
+ */
+typedef struct RDAI_Graph RDAI_Graph;
+
+/**
+ * RDAI Launch
+ *
+ * A device run with its arguments validated and its platform ops resolved
+ * ahead of time (opaque, see RDAI_launch_create)
+ */
+typedef struct RDAI_Launch RDAI_Launch;
+
+/**
+ * RDAI Device Estimate
+ *
+ * What the host runtime has observed of a device dispatched to by
+ * RDAI_submit_by_vlnv
+ *
+ * @device: the device
+ * @latency_ns: exponentially weighted moving average of the duration of
+ *              its runs, in ns (0 until a run has completed); a failed run
+ *              counts as several times the average
+ * @queue_depth: the number of its queued and running runs
+ * @runs: the number of its completed runs, failed ones included
+ */
+typedef struct RDAI_DeviceEstimate
+{
+    RDAI_Device *device;
+    uint64_t latency_ns;
+    uint32_t queue_depth;
+    uint64_t runs;
+
+} RDAI_DeviceEstimate;
+
+/**
+ * RDAI Dispatch Policy
+ *
+ * Chooses the device of a run submitted with RDAI_submit_by_vlnv
+ *
+ * @estimates: the estimates of the candidate devices (all with the VLNV)
+ * @count: the number of candidate devices (> 0)
+ * @ctx: the context pointer given to RDAI_set_dispatch_policy
+ * @return the index of the chosen device in estimates
+ */
+typedef size_t (*RDAI_DispatchPolicy)( const RDAI_DeviceEstimate *estimates, size_t count, void *ctx );
+
+/**
+ * RDAI Graph Binding
+ *
+ * Replaces a captured memory object for one launch of a graph
+ *
+ * @captured: a memory object used by the calls captured in the graph
+ * @bound: the memory object to use in its place, of the same type and device
+ *         and at least as large
+ */
+typedef struct RDAI_GraphBinding
+{
+    RDAI_MemObject *captured;
+    RDAI_MemObject *bound;
+
+} RDAI_GraphBinding;
+
 /**
  * RDAI Platform Operations
  *
@@ -475,8 +826,32 @@ typedef struct RDAI_PlatformOps
      */
     RDAI_Status        ( *sync )               ( RDAI_AsyncHandle *async_handle );
 
+    /**
+     * Synchronously run an accelerator device once per memory object list
+     *
+     * Optional (may be NULL): the host runtime calls device_run for each list
+     * when a platform does not provide it
+     *
+     * @param device The device to run
+     * @param mem_object_lists count NULL-terminated lists of memory object pointers
+     *                  (see device_run)
+     * @param count The number of runs
+     * @return status (the first failure, if any)
+     */
+    RDAI_Status        ( *device_run_batch )   ( RDAI_Device *device, RDAI_MemObject ***mem_object_lists, size_t count );
+
 } RDAI_PlatformOps;
 
+/**
+ * Symbol exported by a platform plugin
+ *
+ * A platform plugin is a shared library that defines
+ *
+ *     extern "C" RDAI_PlatformOps *rdai_platform_ops;
+ *
+ * pointing to its platform ops (see RDAI_load_platform_plugin)
+ */
+#define RDAI_PLUGIN_OPS_SYMBOL "rdai_platform_ops"
 
 #ifdef __cplusplus
 }